@@ -0,0 +1,97 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofApp.h"
+#include "ofx/IO/ByteBuffer.h"
+#include "ofx/IO/Base64Encoding.h"
+
+
+void ofApp::setup()
+{
+    using ofxGCP::Base64;
+
+    ofLogNotice("ofApp::setup") << "Selected implementation: " << Base64::toString(Base64::implementation());
+
+    for (std::size_t size: { 100 * 1024, 1024 * 1024, 10 * 1024 * 1024 })
+    {
+        ofBuffer buffer;
+        buffer.allocate(size);
+
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            buffer.getData()[i] = static_cast<char>(ofRandom(256));
+        }
+
+        results.push_back("Input: " + ofToString(size / 1024) + " KB");
+
+        // The previous path, with an intermediate ByteBuffer copy.
+        benchmark("ofxIO", buffer, [](const ofBuffer& buffer) {
+            return ofx::IO::Base64Encoding::encode(ofx::IO::ByteBuffer(buffer)).size();
+        });
+
+        std::string output(Base64::encodedSize(size), '\0');
+
+        for (auto implementation: { Base64::Implementation::SCALAR,
+                                    Base64::Implementation::SSE41,
+                                    Base64::Implementation::AVX2 })
+        {
+            if (!Base64::isSupported(implementation))
+            {
+                results.push_back("  " + Base64::toString(implementation) + ": not supported");
+                continue;
+            }
+
+            benchmark(Base64::toString(implementation), buffer, [&](const ofBuffer& buffer) {
+                return Base64::encode(buffer.getData(), buffer.size(), &output[0], implementation);
+            });
+        }
+    }
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result;
+    }
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+
+    float y = 20;
+
+    for (const auto& result: results)
+    {
+        ofDrawBitmapString(result, 20, y);
+        y += 14;
+    }
+}
+
+
+void ofApp::benchmark(const std::string& name,
+                      const ofBuffer& buffer,
+                      std::function<std::size_t(const ofBuffer&)> encode)
+{
+    const int iterations = 10;
+
+    std::size_t encodedSize = encode(buffer);
+
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        encodedSize = encode(buffer);
+    }
+
+    double seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0 / iterations;
+    double megabytesPerSecond = buffer.size() / seconds / (1024.0 * 1024.0);
+
+    results.push_back("  " + name + ": "
+                      + ofToString(seconds * 1000.0, 3) + " ms, "
+                      + ofToString(megabytesPerSecond, 1) + " MB/s ("
+                      + ofToString(encodedSize) + " bytes)");
+}
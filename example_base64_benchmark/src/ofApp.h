@@ -0,0 +1,31 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxCloudPlatform.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Time an encoder over a buffer.
+    /// \param name The name of the encoder.
+    /// \param buffer The buffer to encode.
+    /// \param encode The encoder to time.
+    void benchmark(const std::string& name,
+                   const ofBuffer& buffer,
+                   std::function<std::size_t(const ofBuffer&)> encode);
+
+    std::vector<std::string> results;
+
+};
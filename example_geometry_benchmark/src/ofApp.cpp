@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofApp.h"
+
+
+void ofApp::setup()
+{
+    using ofxGCP::VisionQuads;
+
+    struct Scenario
+    {
+        std::string name;
+        std::size_t count;
+        float size;
+        float rotated;
+    };
+
+    const std::vector<Scenario> scenarios =
+    {
+        { "faces", 100, 120, 0 },
+        { "words", 1000, 40, 0.25 }
+    };
+
+    for (const auto& scenario: scenarios)
+    {
+        std::vector<ofPolyline> polylines = makePolylines(scenario.count,
+                                                          scenario.size,
+                                                          scenario.rotated);
+        std::size_t count = polylines.size();
+        std::size_t iterations = 200000 / count;
+
+        VisionQuads quads;
+        quads.reserve(count);
+
+        for (const auto& polyline: polylines)
+        {
+            quads.add(polyline);
+        }
+
+        std::vector<float> output(count);
+        std::vector<float> outputY(count);
+        std::vector<uint8_t> inside(count);
+        glm::vec2 point(500, 500);
+
+        results.push_back("Geometry: " + ofToString(count) + " " + scenario.name + ", "
+                          + ofToString(int(scenario.rotated * 100)) + "% rotated");
+
+        benchmark("VisionQuads::add", iterations, count, [&]() {
+            quads.clear();
+            for (const auto& polyline: polylines) quads.add(polyline);
+            return float(quads.size());
+        });
+
+        // ofPolyline caches its area and centroid, so each call is timed on
+        // a fresh copy, as for the polys of a newly decoded response.
+        benchmark("ofPolyline::getArea", iterations, count, [&]() {
+            float sum = 0;
+            for (const auto& polyline: polylines) sum += ofPolyline(polyline).getArea();
+            return sum;
+        });
+
+        benchmark("VisionQuads::areas", iterations, count, [&]() {
+            quads.areas(output.data());
+            return output[0];
+        });
+
+        benchmark("ofPolyline::getCentroid2D", iterations, count, [&]() {
+            float sum = 0;
+            for (const auto& polyline: polylines) sum += ofPolyline(polyline).getCentroid2D().x;
+            return sum;
+        });
+
+        benchmark("VisionQuads::centroids", iterations, count, [&]() {
+            quads.centroids(output.data(), outputY.data());
+            return output[0];
+        });
+
+        benchmark("ofPolyline::inside", iterations, count, [&]() {
+            float sum = 0;
+            for (const auto& polyline: polylines) sum += polyline.inside(point.x, point.y);
+            return sum;
+        });
+
+        benchmark("VisionQuads::contains", iterations, count, [&]() {
+            quads.contains(point, inside.data());
+            return float(inside[0]);
+        });
+
+        // Non-maximum suppression compares every pair. ofPolyline has no
+        // polygon intersection, so the usual approach is bounding box IoU.
+        std::size_t pairIterations = std::max<std::size_t>(1, 2000000 / (count * count));
+
+        benchmark("ofPolyline bounding box IoU", pairIterations, count * count, [&]() {
+            float sum = 0;
+            for (const auto& a: polylines)
+            {
+                ofRectangle boundsA = a.getBoundingBox();
+                for (const auto& b: polylines)
+                {
+                    ofRectangle boundsB = b.getBoundingBox();
+                    float intersection = boundsA.getIntersection(boundsB).getArea();
+                    float united = boundsA.getArea() + boundsB.getArea() - intersection;
+                    sum += united > 0 ? intersection / united : 0;
+                }
+            }
+            return sum;
+        });
+
+        benchmark("VisionQuads::iou (exact)", pairIterations, count * count, [&]() {
+            float sum = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                quads.iou(quads.quad(i), output.data());
+                sum += output[0];
+            }
+            return sum;
+        });
+    }
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result;
+    }
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+
+    float y = 20;
+
+    for (const auto& result: results)
+    {
+        ofDrawBitmapString(result, 20, y);
+        y += 14;
+    }
+}
+
+
+void ofApp::benchmark(const std::string& name,
+                      std::size_t iterations,
+                      std::size_t items,
+                      std::function<float()> function)
+{
+    float result = function();
+
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        result += function();
+    }
+
+    double seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+    double nanosecondsPerItem = seconds * 1000000000.0 / (iterations * items);
+
+    results.push_back("  " + name + ": "
+                      + ofToString(seconds * 1000.0 / iterations, 4) + " ms, "
+                      + ofToString(nanosecondsPerItem, 1) + " ns per item ("
+                      + ofToString(result) + ")");
+}
+
+
+std::vector<ofPolyline> ofApp::makePolylines(std::size_t count,
+                                             float size,
+                                             float rotated)
+{
+    std::vector<ofPolyline> polylines;
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        glm::vec2 center(ofRandom(1000), ofRandom(1000));
+        glm::vec2 extent(size * ofRandom(0.5, 1.5), size * ofRandom(0.5, 1.5));
+        float angle = ofRandom(1) < rotated ? ofRandom(-0.5, 0.5) : 0;
+
+        ofPolyline polyline;
+
+        for (const auto& corner: { glm::vec2(-1, -1), glm::vec2(1, -1), glm::vec2(1, 1), glm::vec2(-1, 1) })
+        {
+            glm::vec2 offset = corner * extent * 0.5f;
+            glm::vec2 vertex = center + glm::vec2(offset.x * std::cos(angle) - offset.y * std::sin(angle),
+                                                  offset.x * std::sin(angle) + offset.y * std::cos(angle));
+
+            // Vision vertices are integer pixels.
+            polyline.addVertex(std::round(vertex.x), std::round(vertex.y));
+        }
+
+        polyline.close();
+        polylines.push_back(polyline);
+    }
+
+    return polylines;
+}
@@ -0,0 +1,42 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxCloudPlatform.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Time a function.
+    /// \param name The name of the function.
+    /// \param iterations The number of times to call the function.
+    /// \param items The number of items processed by each call.
+    /// \param function The function to time.
+    void benchmark(const std::string& name,
+                   std::size_t iterations,
+                   std::size_t items,
+                   std::function<float()> function);
+
+    /// \brief Create bounding polys like those of faces or words.
+    /// \param count The number of polys.
+    /// \param size The typical size of a poly.
+    /// \param rotated The fraction of polys that are not axis-aligned.
+    /// \returns the polys.
+    static std::vector<ofPolyline> makePolylines(std::size_t count,
+                                                 float size,
+                                                 float rotated);
+
+    std::vector<std::string> results;
+
+};
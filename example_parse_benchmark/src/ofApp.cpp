@@ -0,0 +1,217 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofApp.h"
+
+
+namespace {
+
+
+const std::vector<std::string> FACE_KEYS =
+{
+    "boundingPoly",
+    "fdBoundingPoly",
+    "landmarks",
+    "rollAngle",
+    "panAngle",
+    "tiltAngle",
+    "detectionConfidence",
+    "landmarkingConfidence",
+    "joyLikelihood",
+    "sorrowLikelihood",
+    "angerLikelihood",
+    "surpriseLikelihood",
+    "underExposedLikelihood",
+    "blurredLikelihood",
+    "headwearLikelihood"
+};
+
+
+/// \brief The previous key matching, a chain of string comparisons.
+std::size_t findByComparison(const std::string& key)
+{
+    if (key == "boundingPoly") return 0;
+    else if (key == "fdBoundingPoly") return 1;
+    else if (key == "landmarks") return 2;
+    else if (key == "rollAngle") return 3;
+    else if (key == "panAngle") return 4;
+    else if (key == "tiltAngle") return 5;
+    else if (key == "detectionConfidence") return 6;
+    else if (key == "landmarkingConfidence") return 7;
+    else if (key == "joyLikelihood") return 8;
+    else if (key == "sorrowLikelihood") return 9;
+    else if (key == "angerLikelihood") return 10;
+    else if (key == "surpriseLikelihood") return 11;
+    else if (key == "underExposedLikelihood") return 12;
+    else if (key == "blurredLikelihood") return 13;
+    else if (key == "headwearLikelihood") return 14;
+    return 15;
+}
+
+
+constexpr const char* FACE_KEY_NAMES[] =
+{
+    "boundingPoly",
+    "fdBoundingPoly",
+    "landmarks",
+    "rollAngle",
+    "panAngle",
+    "tiltAngle",
+    "detectionConfidence",
+    "landmarkingConfidence",
+    "joyLikelihood",
+    "sorrowLikelihood",
+    "angerLikelihood",
+    "surpriseLikelihood",
+    "underExposedLikelihood",
+    "blurredLikelihood",
+    "headwearLikelihood"
+};
+
+
+constexpr ofxGCP::VisionKeyTable<15> FACE_KEY_TABLE(FACE_KEY_NAMES);
+
+
+}
+
+
+void ofApp::setup()
+{
+    using ofxGCP::AnnotateImageResponse;
+
+    // Key matching alone, in the order keys appear in a face.
+    const std::size_t keyIterations = 200000;
+
+    results.push_back("Key matching: " + ofToString(FACE_KEYS.size()) + " face keys");
+
+    benchmark("Comparison chain", keyIterations, FACE_KEYS.size(), [&]() {
+        std::size_t sum = 0;
+        for (const auto& key: FACE_KEYS) sum += findByComparison(key);
+        return sum;
+    });
+
+    benchmark("Perfect hash", keyIterations, FACE_KEYS.size(), [&]() {
+        std::size_t sum = 0;
+        for (const auto& key: FACE_KEYS) sum += FACE_KEY_TABLE.find(key);
+        return sum;
+    });
+
+    // Whole response decoding.
+    for (std::size_t faces: { 1, 10, 100 })
+    {
+        ofJson json = makeResponse(faces);
+        std::size_t iterations = 2000 / faces;
+
+        results.push_back("Decoding: " + ofToString(faces) + " faces, "
+                          + ofToString(json.dump().size() / 1024) + " KB");
+
+        benchmark("AnnotateImageResponse::fromJSON", iterations, faces, [&]() {
+            return AnnotateImageResponse::fromJSON(json).faceAnnotations().size();
+        });
+    }
+
+    for (const auto& result: results)
+    {
+        ofLogNotice("ofApp::setup") << result;
+    }
+}
+
+
+void ofApp::draw()
+{
+    ofBackground(0);
+
+    float y = 20;
+
+    for (const auto& result: results)
+    {
+        ofDrawBitmapString(result, 20, y);
+        y += 14;
+    }
+}
+
+
+void ofApp::benchmark(const std::string& name,
+                      std::size_t iterations,
+                      std::size_t items,
+                      std::function<std::size_t()> function)
+{
+    std::size_t result = function();
+
+    uint64_t start = ofGetElapsedTimeMicros();
+
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        result += function();
+    }
+
+    double seconds = (ofGetElapsedTimeMicros() - start) / 1000000.0;
+    double nanosecondsPerItem = seconds * 1000000000.0 / (iterations * items);
+
+    results.push_back("  " + name + ": "
+                      + ofToString(seconds * 1000.0 / iterations, 4) + " ms, "
+                      + ofToString(nanosecondsPerItem, 1) + " ns per item ("
+                      + ofToString(result) + ")");
+}
+
+
+ofJson ofApp::makeResponse(std::size_t faces)
+{
+    using Landmark = ofxGCP::FaceAnnotation::Landmark;
+
+    auto polygon = [](float x, float y, float size) {
+        return ofJson({
+            { "vertices", {
+                { { "x", x }, { "y", y } },
+                { { "x", x + size }, { "y", y } },
+                { { "x", x + size }, { "y", y + size } },
+                { { "x", x }, { "y", y + size } }
+            } }
+        });
+    };
+
+    ofJson json;
+
+    for (std::size_t i = 0; i < faces; ++i)
+    {
+        float x = ofRandom(1000);
+        float y = ofRandom(1000);
+
+        ofJson face;
+        face["boundingPoly"] = polygon(x, y, 120);
+        face["fdBoundingPoly"] = polygon(x + 10, y + 10, 100);
+
+        for (std::size_t type = 1; type < Landmark::NUM_TYPES; ++type)
+        {
+            face["landmarks"].push_back({
+                { "type", Landmark::TYPE_NAMES[type] },
+                { "position", {
+                    { "x", x + ofRandom(100) },
+                    { "y", y + ofRandom(100) },
+                    { "z", ofRandom(-10, 10) }
+                } }
+            });
+        }
+
+        face["rollAngle"] = ofRandom(-30, 30);
+        face["panAngle"] = ofRandom(-30, 30);
+        face["tiltAngle"] = ofRandom(-30, 30);
+        face["detectionConfidence"] = ofRandom(1);
+        face["landmarkingConfidence"] = ofRandom(1);
+        face["joyLikelihood"] = "VERY_LIKELY";
+        face["sorrowLikelihood"] = "VERY_UNLIKELY";
+        face["angerLikelihood"] = "VERY_UNLIKELY";
+        face["surpriseLikelihood"] = "UNLIKELY";
+        face["underExposedLikelihood"] = "VERY_UNLIKELY";
+        face["blurredLikelihood"] = "VERY_UNLIKELY";
+        face["headwearLikelihood"] = "POSSIBLE";
+
+        json["faceAnnotations"].push_back(face);
+    }
+
+    return json;
+}
@@ -0,0 +1,38 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofMain.h"
+#include "ofxCloudPlatform.h"
+
+
+class ofApp: public ofBaseApp
+{
+public:
+    void setup() override;
+    void draw() override;
+
+    /// \brief Time a function.
+    /// \param name The name of the function.
+    /// \param iterations The number of times to call the function.
+    /// \param items The number of items processed by each call.
+    /// \param function The function to time.
+    void benchmark(const std::string& name,
+                   std::size_t iterations,
+                   std::size_t items,
+                   std::function<std::size_t()> function);
+
+    /// \brief Create a face-heavy response.
+    /// \param faces The number of faces.
+    /// \returns the response json.
+    static ofJson makeResponse(std::size_t faces);
+
+    std::vector<std::string> results;
+
+};
@@ -0,0 +1,91 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <cstddef>
+#include <string>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A vectorized base64 encoder for image payloads.
+///
+/// The fastest implementation supported by the CPU is selected at runtime.
+/// Output uses the standard alphabet with padding and no line breaks, as
+/// expected by the Vision API.
+class Base64
+{
+public:
+    /// \brief Base64 encoder implementations.
+    enum class Implementation
+    {
+        /// \brief Select the fastest supported implementation.
+        AUTOMATIC,
+
+        /// \brief Portable scalar implementation.
+        SCALAR,
+
+        /// \brief SSE4.1 implementation, 12 bytes per iteration.
+        SSE41,
+
+        /// \brief AVX2 implementation, 24 bytes per iteration.
+        AVX2
+    };
+
+    /// \brief Get the encoded size for a number of input bytes.
+    /// \param size The number of input bytes.
+    /// \returns the number of base64 characters.
+    static std::size_t encodedSize(std::size_t size);
+
+    /// \brief Encode bytes into a pre-sized output buffer.
+    ///
+    /// The output buffer must hold at least encodedSize(size) characters.
+    ///
+    /// \param data The input bytes.
+    /// \param size The number of input bytes.
+    /// \param output The output buffer.
+    /// \param implementation The implementation to use.
+    /// \returns the number of characters written.
+    static std::size_t encode(const void* data,
+                              std::size_t size,
+                              char* output,
+                              Implementation implementation = Implementation::AUTOMATIC);
+
+    /// \brief Encode bytes into a string.
+    /// \param data The input bytes.
+    /// \param size The number of input bytes.
+    /// \param implementation The implementation to use.
+    /// \returns the base64 encoded string.
+    static std::string encode(const void* data,
+                              std::size_t size,
+                              Implementation implementation = Implementation::AUTOMATIC);
+
+    /// \returns the implementation selected for this CPU.
+    static Implementation implementation();
+
+    /// \brief Determine if an implementation is supported by this CPU.
+    /// \param implementation The implementation to query.
+    /// \returns true if supported.
+    static bool isSupported(Implementation implementation);
+
+    /// \brief Get the name of an implementation.
+    /// \param implementation The implementation.
+    /// \returns the name.
+    static std::string toString(Implementation implementation);
+
+private:
+    Base64() = delete;
+    ~Base64() = delete;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -26,7 +26,7 @@ class Likelihood
 {
 public:
     /// \brief Likelihood types.
-    enum class Type
+    enum class Type: uint8_t
     {
         UNKNOWN, ///< Unknown likelihood.
         VERY_UNLIKELY, ///< The image very unlikely belongs to the vertical specified.
@@ -45,15 +45,59 @@ public:
     /// \brief Destroy the given Likelihood.
     ~Likelihood();
 
+    Likelihood(const Likelihood&) = default;
+    Likelihood(Likelihood&&) = default;
+    Likelihood& operator = (const Likelihood&) = default;
+    Likelihood& operator = (Likelihood&&) = default;
+
     /// \returns the Likelihood type.
     Type type() const;
 
     /// \returns the Likelihood name.
-    std::string name() const;
+    const std::string& name() const;
 
     /// \returns the Likelihood value (0-1);
     float value() const;
 
+    /// \brief Get the name of a Likelihood Type.
+    /// \param type The Likelihood Type.
+    /// \returns the name, e.g. "VERY_LIKELY".
+    static constexpr const char* toString(Type type)
+    {
+        return TYPE_NAMES[static_cast<std::size_t>(type)];
+    }
+
+    /// \brief Get the normalized value of a Likelihood Type.
+    /// \param type The Likelihood Type.
+    /// \returns the value (0-1).
+    static constexpr float toValue(Type type)
+    {
+        return TYPE_VALUES[static_cast<std::size_t>(type)];
+    }
+
+    /// \brief Parse a Likelihood Type name.
+    /// \param text The name to parse.
+    /// \param type The Type to fill if the name is known.
+    /// \returns true if the name is known.
+    static bool fromString(const std::string& text, Type& type);
+
+    /// \brief The Likelihood Type names, in Type order.
+    static constexpr const char* TYPE_NAMES[] =
+    {
+        "UNKNOWN",
+        "VERY_UNLIKELY",
+        "UNLIKELY",
+        "POSSIBLE",
+        "LIKELY",
+        "VERY_LIKELY"
+    };
+
+    /// \brief The Likelihood Type normalized values, in Type order.
+    static constexpr float TYPE_VALUES[] =
+    {
+        0.0f, 0.0f, 0.25f, 0.5f, 0.75f, 1.0f
+    };
+
     /// \brief Map Likelihood Types to strings.
     static const std::map<Type, std::string> LIKELIHOOD_STRINGS;
 
@@ -72,12 +116,6 @@ private:
     /// \brief The Likelihood Type.
     Type _type = Type::UNKNOWN;
 
-    /// \brief The Likelihood name string.
-    std::string _name;
-
-    /// \brief The Likelihood noramlized value.
-    float _value = 0.0f;
-
 };
 
 
@@ -92,13 +130,18 @@ public:
     /// \brief Destroy the EntityAnnotation.
     ~EntityAnnotation();
 
+    EntityAnnotation(const EntityAnnotation&) = default;
+    EntityAnnotation(EntityAnnotation&&) = default;
+    EntityAnnotation& operator = (const EntityAnnotation&) = default;
+    EntityAnnotation& operator = (EntityAnnotation&&) = default;
+
     /// \brief Knowledge Graph entity ID.
     ///
     /// Maps to a freebase entity ID. (for example, "Google" maps to:
     /// mid /m/045c7b).
     ///
     /// \returns the mid.
-    std::string mid() const;
+    const std::string& mid() const;
 
     /// \brief Description locale.
     ///
@@ -106,10 +149,10 @@ public:
     /// description is expressed.
     ///
     /// \returns the locale.
-    std::string locale() const;
+    const std::string& locale() const;
 
     /// \returns the entity textual description, expressed in its locale language.
-    std::string description() const;
+    const std::string& description() const;
 
     /// \returns the overall score of the result. Range [0, 1].
     float score() const;
@@ -142,7 +185,7 @@ public:
     /// detected text.
     ///
     /// \returns the image region to which this entity belongs.
-    ofPolyline boundingPoly() const;
+    const ofPolyline& boundingPoly() const;
 
     /// \brief The location information for the detected entity.
     ///
@@ -152,14 +195,17 @@ public:
     /// information is usually present for landmarks.
     ///
     /// \returns a set of latitude / longitude pairs.
-    std::vector<std::pair<double, double>> locations();
+    const std::vector<std::pair<double, double>>& locations() const;
 
     /// \brief Some entities can have additional optional Property fields.
     ///
     /// For example a different kind of score or string that qualifies the entity.
     ///
     /// \returns additional name/value properties.
-    std::unordered_multimap<std::string, std::string> properties();
+    const std::unordered_multimap<std::string, std::string>& properties() const;
+
+    /// \returns the estimated memory used by this annotation in bytes.
+    std::size_t memoryFootprint() const;
 
     /// \brief Create an instance from JSON.
     /// \param json The JSON to use.
@@ -167,6 +213,8 @@ public:
     static EntityAnnotation fromJSON(const ofJson& json);
 
 private:
+    friend class VisionSnapshot;
+
     std::string _mid;
     std::string _locale;
     std::string _description;
@@ -193,7 +241,7 @@ public:
         /// Left and right are defined from the vantage of the viewer of the
         /// image, without considering mirror projections typical of photos. So,
         /// LEFT_EYE, typically is the person's right eye.
-        enum class Type
+        enum class Type: uint8_t
         {
             UNKNOWN_LANDMARK, ///< Unknown face landmark detected. Should not be filled.
             LEFT_EYE, ///< Left eye.
@@ -236,14 +284,71 @@ public:
         Landmark();
         Landmark(Type type, const glm::vec3& position);
         Type type() const;
-        std::string name() const;
-        glm::vec3 position() const;
+        const std::string& name() const;
+        const glm::vec3& position() const;
 
         /// \brief Create an instance from JSON.
         /// \param json The JSON to use.
         /// \returns an instance of the object.
         static Landmark fromJSON(const ofJson& json);
 
+        /// \brief Get the name of a landmark Type.
+        /// \param type The landmark Type.
+        /// \returns the name, e.g. "LEFT_EYE".
+        static constexpr const char* toString(Type type)
+        {
+            return TYPE_NAMES[static_cast<std::size_t>(type)];
+        }
+
+        /// \brief Parse a landmark Type name.
+        /// \param text The name to parse.
+        /// \param type The Type to fill if the name is known.
+        /// \returns true if the name is known.
+        static bool fromString(const std::string& text, Type& type);
+
+        /// \brief The number of landmark Types.
+        static constexpr std::size_t NUM_TYPES = 35;
+
+        /// \brief The landmark Type names, in Type order.
+        static constexpr const char* TYPE_NAMES[NUM_TYPES] =
+        {
+            "UNKNOWN_LANDMARK",
+            "LEFT_EYE",
+            "RIGHT_EYE",
+            "LEFT_OF_LEFT_EYEBROW",
+            "RIGHT_OF_LEFT_EYEBROW",
+            "LEFT_OF_RIGHT_EYEBROW",
+            "RIGHT_OF_RIGHT_EYEBROW",
+            "MIDPOINT_BETWEEN_EYES",
+            "NOSE_TIP",
+            "UPPER_LIP",
+            "LOWER_LIP",
+            "MOUTH_LEFT",
+            "MOUTH_RIGHT",
+            "MOUTH_CENTER",
+            "NOSE_BOTTOM_RIGHT",
+            "NOSE_BOTTOM_LEFT",
+            "NOSE_BOTTOM_CENTER",
+            "LEFT_EYE_TOP_BOUNDARY",
+            "LEFT_EYE_RIGHT_CORNER",
+            "LEFT_EYE_BOTTOM_BOUNDARY",
+            "LEFT_EYE_LEFT_CORNER",
+            "RIGHT_EYE_TOP_BOUNDARY",
+            "RIGHT_EYE_RIGHT_CORNER",
+            "RIGHT_EYE_BOTTOM_BOUNDARY",
+            "RIGHT_EYE_LEFT_CORNER",
+            "LEFT_EYEBROW_UPPER_MIDPOINT",
+            "RIGHT_EYEBROW_UPPER_MIDPOINT",
+            "LEFT_EAR_TRAGION",
+            "RIGHT_EAR_TRAGION",
+            "LEFT_EYE_PUPIL",
+            "RIGHT_EYE_PUPIL",
+            "FOREHEAD_GLABELLA",
+            "CHIN_GNATHION",
+            "CHIN_LEFT_GONION",
+            "CHIN_RIGHT_GONION"
+        };
+
         static const std::map<Type, std::size_t> LANDMARK_TYPE_INDEX;
         static const std::map<std::size_t, Type> INDEX_LANDMARK_TYPE;
         static const std::map<Type, std::string> LANDMARK_TYPE_STRINGS;
@@ -251,7 +356,6 @@ public:
         static const std::map<Type, std::string> LANDMARK_TYPE_DESCRIPTIONS;
     private:
         Type _type = Type::UNKNOWN_LANDMARK;
-        std::string _name;
         glm::vec3 _position;
 
     };
@@ -262,6 +366,11 @@ public:
     /// \brief Destroy the FaceAnnotation.
     ~FaceAnnotation();
 
+    FaceAnnotation(const FaceAnnotation&) = default;
+    FaceAnnotation(FaceAnnotation&&) = default;
+    FaceAnnotation& operator = (const FaceAnnotation&) = default;
+    FaceAnnotation& operator = (FaceAnnotation&&) = default;
+
     /// \brief The bounding polygon around the face.
     ///
     /// The coordinates of the bounding box are in the original image's scale,
@@ -272,7 +381,7 @@ public:
     /// a partial face appears in the image to be annotated.
     ///
     /// \returns the bounding poly.
-    ofPolyline boundingPoly() const;
+    const ofPolyline& boundingPoly() const;
 
     /// \brief The face's bounding polygon based on initial face detection.
     ///
@@ -284,10 +393,10 @@ public:
     /// prefix.
     ///
     /// \returns the fb bounding poly.
-    ofPolyline fdBoundingPoly() const;
+    const ofPolyline& fdBoundingPoly() const;
 
     /// \returns the detected face landmarks.
-    std::vector<Landmark> landmarks() const;
+    const std::vector<Landmark>& landmarks() const;
 
     /// \brief Roll angle.
     ///
@@ -322,25 +431,28 @@ public:
     float landmarkingConfidence() const;
 
     /// \returns Joy likelihood.
-    Likelihood joyLikelihood() const;
+    const Likelihood& joyLikelihood() const;
 
     /// \returns Sorrow likelihood.
-    Likelihood sorrowLikelihood() const;
+    const Likelihood& sorrowLikelihood() const;
 
     /// \returns Anger likelihood.
-    Likelihood angerLikelihood() const;
+    const Likelihood& angerLikelihood() const;
 
     /// \returns Surprise likelihood.
-    Likelihood surpriseLikelihood() const;
+    const Likelihood& surpriseLikelihood() const;
 
     /// \returns Under-exposed likelihood.
-    Likelihood underExposedLikelihood() const;
+    const Likelihood& underExposedLikelihood() const;
 
     /// \returns Blurred likelihood.
-    Likelihood blurredLikelihood() const;
+    const Likelihood& blurredLikelihood() const;
 
     /// \returns Headwear likelihood.
-    Likelihood headwearLikelihood() const;
+    const Likelihood& headwearLikelihood() const;
+
+    /// \returns the estimated memory used by this annotation in bytes.
+    std::size_t memoryFootprint() const;
 
     /// \brief Create an instance from JSON.
     /// \param json The JSON to use.
@@ -348,6 +460,9 @@ public:
     static FaceAnnotation fromJSON(const ofJson& json);
 
 private:
+    friend class VisionFaceTracker;
+    friend class VisionSnapshot;
+
     /// \sa boundingPoly()
     ofPolyline _boundingPoly;
 
@@ -407,9 +522,14 @@ public:
     /// \brief Destroy the SafeSearchAnnotation.
     virtual ~SafeSearchAnnotation();
 
+    SafeSearchAnnotation(const SafeSearchAnnotation&) = default;
+    SafeSearchAnnotation(SafeSearchAnnotation&&) = default;
+    SafeSearchAnnotation& operator = (const SafeSearchAnnotation&) = default;
+    SafeSearchAnnotation& operator = (SafeSearchAnnotation&&) = default;
+
     /// \brief Represents the adult contents likelihood for the image.
     /// \returns the Likelihood.
-    Likelihood adult() const;
+    const Likelihood& adult() const;
 
     /// \brief A spoofed image.
     ///
@@ -417,19 +537,19 @@ public:
     /// canonical version to make it appear funny or offensive.
     ///
     /// \returns the Likelihood.
-    Likelihood spoof() const;
+    const Likelihood& spoof() const;
 
     /// \brief Likelihood this is a medical image.
     /// \returns the Likelihood.
-    Likelihood medical() const;
+    const Likelihood& medical() const;
 
     /// \brief Violence likelihood.
     /// \returns the Likelihood.
-    Likelihood violence() const;
+    const Likelihood& violence() const;
 
     /// \brief Racy likelihood.
     /// \returns the Likelihood.
-    Likelihood racy() const;
+    const Likelihood& racy() const;
 
     /// \brief Create an instance from JSON.
     /// \param json The JSON to use.
@@ -437,6 +557,8 @@ public:
     static SafeSearchAnnotation fromJSON(const ofJson& json);
 
 private:
+    friend class VisionSnapshot;
+
     /// \brief Represents the adult contents likelihood for the image.
     Likelihood _adult;
 
@@ -465,8 +587,13 @@ public:
     /// \brief Destroy the ColorInfo.
     ~ColorInfo();
 
+    ColorInfo(const ColorInfo&) = default;
+    ColorInfo(ColorInfo&&) = default;
+    ColorInfo& operator = (const ColorInfo&) = default;
+    ColorInfo& operator = (ColorInfo&&) = default;
+
     /// \returns the RGB components of the color.
-    ofColor color() const;
+    const ofColor& color() const;
 
     /// \returns the image-specific score for this color. Value in range [0, 1].
     float score() const;
@@ -480,6 +607,8 @@ public:
     static ColorInfo fromJSON(const ofJson& json);
 
 private:
+    friend class VisionSnapshot;
+
     /// \brief RGB components of the color.
     ofColor _color;
 
@@ -503,8 +632,13 @@ public:
     /// \brief Destroy the ImagePropertiesAnnotation.
     virtual ~ImagePropertiesAnnotation();
 
+    ImagePropertiesAnnotation(const ImagePropertiesAnnotation&) = default;
+    ImagePropertiesAnnotation(ImagePropertiesAnnotation&&) = default;
+    ImagePropertiesAnnotation& operator = (const ImagePropertiesAnnotation&) = default;
+    ImagePropertiesAnnotation& operator = (ImagePropertiesAnnotation&&) = default;
+
     /// \returns the of dominant colors and their corresponding scores.
-    std::vector<ColorInfo> dominantColors() const;
+    const std::vector<ColorInfo>& dominantColors() const;
 
     /// \brief Create an instance from JSON.
     /// \param json The JSON to use.
@@ -512,6 +646,8 @@ public:
     static ImagePropertiesAnnotation fromJSON(const ofJson& json);
 
 private:
+    friend class VisionSnapshot;
+
     /// \brief dominant colors and their corresponding scores.
     std::vector<ColorInfo> _dominantColors;
 
@@ -528,9 +664,14 @@ public:
     
     /// \brief Destroy the CropHint.
     ~CropHint();
+
+    CropHint(const CropHint&) = default;
+    CropHint(CropHint&&) = default;
+    CropHint& operator = (const CropHint&) = default;
+    CropHint& operator = (CropHint&&) = default;
     
-    /// \returns the of dominant colors and their corresponding scores.
-    ofPolyline boundingPoly() const;
+    /// \returns the bounding polygon for the crop region.
+    const ofPolyline& boundingPoly() const;
     
     /// \returns Confidence of this being a salient region. Range [0, 1].
     float confidence() const;
@@ -544,6 +685,8 @@ public:
     static CropHint fromJSON(const ofJson& json);
 
 private:
+    friend class VisionSnapshot;
+
     /// \brief The bounding polygon for the crop region.
     ///
     /// The coordinates of the bounding box are in the original image's scale,
@@ -568,9 +711,14 @@ public:
     
     /// \brief Destroy the CropHintsAnnotation.
     virtual ~CropHintsAnnotation();
+
+    CropHintsAnnotation(const CropHintsAnnotation&) = default;
+    CropHintsAnnotation(CropHintsAnnotation&&) = default;
+    CropHintsAnnotation& operator = (const CropHintsAnnotation&) = default;
+    CropHintsAnnotation& operator = (CropHintsAnnotation&&) = default;
     
     /// \returns the crop hints.
-    std::vector<CropHint> cropHints() const;
+    const std::vector<CropHint>& cropHints() const;
 
     /// \brief Create an instance from JSON.
     /// \param json The JSON to use.
@@ -578,6 +726,8 @@ public:
     static CropHintsAnnotation fromJSON(const ofJson& json);
     
 private:
+    friend class VisionSnapshot;
+
     /// \brief dominant colors and their corresponding scores.
     std::vector<CropHint> _cropHints;
 
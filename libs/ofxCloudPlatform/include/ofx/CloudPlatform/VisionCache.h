@@ -0,0 +1,180 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <future>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "ofx/CloudPlatform/VisionClient.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A content-addressed annotation cache in front of a VisionClient.
+///
+/// Responses are keyed by a hash of the image content (or Google Storage
+/// URI), the normalized feature list and the image context. Recently used
+/// responses are kept in memory up to a byte limit and may optionally be
+/// persisted to disk.
+///
+/// Identical requests that are in flight on other threads are not sent
+/// twice; later callers wait for the first response. The cache is thread
+/// safe, but each thread must pass its own VisionClient.
+class VisionCache
+{
+public:
+    enum
+    {
+        /// \brief The default in-memory size limit in bytes.
+        DEFAULT_MAX_BYTES = 64 * 1024 * 1024
+    };
+
+    /// \brief Cache settings.
+    struct Settings
+    {
+        /// \brief The in-memory size limit in bytes.
+        std::size_t maxBytes = DEFAULT_MAX_BYTES;
+
+        /// \brief A directory for persisted responses, or empty to disable.
+        ///
+        /// The on-disk cache is not size limited. Responses are persisted
+        /// from their raw json, so cache misses are requested with JSON
+        /// retention, without changing the client's setRetainJSON().
+        std::string persistencePath;
+    };
+
+    /// \brief Cache statistics.
+    struct Statistics
+    {
+        /// \brief Requests answered from memory.
+        uint64_t hits = 0;
+
+        /// \brief Requests answered from disk.
+        uint64_t diskHits = 0;
+
+        /// \brief Requests that waited for an identical in-flight request.
+        uint64_t coalesced = 0;
+
+        /// \brief Requests sent to the API.
+        uint64_t misses = 0;
+
+        /// \brief Responses evicted from memory.
+        uint64_t evictions = 0;
+
+        /// \brief The number of responses in memory.
+        std::size_t count = 0;
+
+        /// \brief The estimated size of responses in memory.
+        /// \sa AnnotateImageResponse::memoryFootprint()
+        std::size_t bytes = 0;
+    };
+
+    /// \brief Create a VisionCache with default settings.
+    VisionCache();
+
+    /// \brief Create a VisionCache with the given settings.
+    /// \param settings The settings to use.
+    VisionCache(const Settings& settings);
+
+    /// \brief Destroy the VisionCache.
+    ~VisionCache();
+
+    /// \brief Annotate a request item, using the cache where possible.
+    /// \param client The client used for cache misses.
+    /// \param item The request item.
+    /// \returns the response.
+    /// \throws Poco::Net::HTTPException if the API request fails.
+    AnnotateImageResponse annotate(VisionClient& client,
+                                   const VisionRequestItem& item);
+
+    /// \brief Annotate request items, using the cache where possible.
+    ///
+    /// All cache misses are sent to the API in a single request.
+    ///
+    /// \param client The client used for cache misses.
+    /// \param items The request items.
+    /// \returns the responses, in the same order as the items.
+    /// \throws Poco::Net::HTTPException if the API request fails.
+    std::vector<AnnotateImageResponse> annotate(VisionClient& client,
+                                                const std::vector<VisionRequestItem>& items);
+
+    /// \brief Remove all responses from memory.
+    void clear();
+
+    /// \returns the cache statistics.
+    Statistics statistics() const;
+
+    /// \brief Compute the cache key for a request item.
+    /// \param item The request item.
+    /// \returns the cache key.
+    static uint64_t key(const VisionRequestItem& item);
+
+private:
+    /// \brief A cached response.
+    struct Entry
+    {
+        /// \brief The cache key.
+        uint64_t key = 0;
+
+        /// \brief The response.
+        std::shared_ptr<const AnnotateImageResponse> response;
+
+        /// \brief The estimated size of the response.
+        std::size_t bytes = 0;
+    };
+
+    /// \brief Find a response in memory.
+    ///
+    /// The mutex must be held.
+    std::shared_ptr<const AnnotateImageResponse> find(uint64_t key);
+
+    /// \brief Load a persisted response from disk.
+    ///
+    /// The mutex should not be held. The caller must own the key in
+    /// _inFlight, so each response is only loaded once.
+    ///
+    /// \returns the response, or nullptr if there is none.
+    std::shared_ptr<const AnnotateImageResponse> load(uint64_t key) const;
+
+    /// \brief Insert a response into memory.
+    ///
+    /// The mutex must be held.
+    void insert(uint64_t key,
+                std::shared_ptr<const AnnotateImageResponse> response);
+
+    /// \brief Persist a serialized response to disk.
+    ///
+    /// The mutex should not be held.
+    void persist(uint64_t key, const std::string& serialized) const;
+
+    /// \returns the persistence path for a key.
+    std::string path(uint64_t key) const;
+
+    Settings _settings;
+
+    /// \brief Least recently used entries are at the back.
+    std::list<Entry> _entries;
+
+    /// \brief An index of entries by key.
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> _index;
+
+    /// \brief Responses that are currently being requested.
+    std::unordered_map<uint64_t, std::shared_future<std::shared_ptr<const AnnotateImageResponse>>> _inFlight;
+
+    Statistics _statistics;
+
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
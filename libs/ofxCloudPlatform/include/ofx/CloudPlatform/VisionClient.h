@@ -30,6 +30,46 @@ public:
     
     std::vector<AnnotateImageResponse> annotate(const std::vector<VisionRequestItem>& items);
 
+    /// \brief Annotate items, choosing JSON retention for this call only.
+    ///
+    /// Unlike setRetainJSON(), this leaves the client unchanged, so it is
+    /// safe while other threads use the same client.
+    ///
+    /// \param items The items to annotate.
+    /// \param retainJSON True to keep the raw JSON of each response.
+    /// \returns the responses, one per item.
+    std::vector<AnnotateImageResponse> annotate(const std::vector<VisionRequestItem>& items,
+                                                bool retainJSON);
+
+    /// \brief Decode responses on first access rather than when received.
+    ///
+    /// Lazy decoding is useful when only some annotation types are read.
+    ///
+    /// \param lazyDecoding True to decode lazily.
+    /// \sa AnnotateImageResponse::fromJSONLazy()
+    void setLazyDecoding(bool lazyDecoding);
+
+    /// \returns true if responses are decoded on first access.
+    bool getLazyDecoding() const;
+
+    /// \brief Keep the raw JSON of each response.
+    ///
+    /// The raw JSON is not kept by default. Lazy responses always keep it.
+    ///
+    /// \param retainJSON True to keep the raw JSON.
+    /// \sa AnnotateImageResponse::json()
+    void setRetainJSON(bool retainJSON);
+
+    /// \returns true if the raw JSON of each response is kept.
+    bool getRetainJSON() const;
+
+private:
+    /// \brief True if responses are decoded on first access.
+    bool _lazyDecoding = false;
+
+    /// \brief True if the raw JSON of each response is kept.
+    bool _retainJSON = false;
+
 };
 
 
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include <unordered_map>
+#include "ofx/CloudPlatform/VisionResponse.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A columnar store for analytics over many responses.
+///
+/// Responses are appended into contiguous structure-of-arrays columns, so a
+/// scan over one field, such as the pan angle of every face, reads only that
+/// field's memory. Rows of each table refer back to their response by index.
+///
+/// Landmark positions use a fixed layout with one column per landmark type
+/// and a row per face. Missing landmarks are NaN.
+///
+/// Entity mids are interned, so entity rows store a 32-bit mid index.
+///
+/// The filter() and aggregate() helpers use SSE2 where available.
+///
+/// The store is not thread safe.
+class VisionColumnStore
+{
+public:
+    enum
+    {
+        /// \brief The number of landmark slots, one for each known landmark type.
+        NUM_LANDMARK_SLOTS = FaceAnnotation::Landmark::NUM_TYPES - 1
+    };
+
+    /// \brief The kind of an entity row.
+    enum class EntityKind: uint8_t
+    {
+        LABEL,
+        LANDMARK,
+        LOGO,
+        TEXT
+    };
+
+    /// \brief Per-response columns.
+    struct ResponseColumns
+    {
+        /// \brief The first face row of each response.
+        std::vector<uint32_t> faceBegin;
+
+        /// \brief The first entity row of each response.
+        std::vector<uint32_t> entityBegin;
+
+        /// \brief Safe search Likelihood::Type columns.
+        std::vector<uint8_t> adult;
+        std::vector<uint8_t> spoof;
+        std::vector<uint8_t> medical;
+        std::vector<uint8_t> violence;
+        std::vector<uint8_t> racy;
+    };
+
+    /// \brief Per-face columns.
+    struct FaceColumns
+    {
+        /// \brief The response index of each face.
+        std::vector<uint32_t> response;
+
+        std::vector<float> rollAngle;
+        std::vector<float> panAngle;
+        std::vector<float> tiltAngle;
+        std::vector<float> detectionConfidence;
+        std::vector<float> landmarkingConfidence;
+
+        /// \brief Likelihood::Type columns.
+        std::vector<uint8_t> joy;
+        std::vector<uint8_t> sorrow;
+        std::vector<uint8_t> anger;
+        std::vector<uint8_t> surprise;
+        std::vector<uint8_t> underExposed;
+        std::vector<uint8_t> blurred;
+        std::vector<uint8_t> headwear;
+
+        /// \brief Landmark positions, one column per landmark slot.
+        std::array<std::vector<float>, NUM_LANDMARK_SLOTS> landmarkX;
+        std::array<std::vector<float>, NUM_LANDMARK_SLOTS> landmarkY;
+        std::array<std::vector<float>, NUM_LANDMARK_SLOTS> landmarkZ;
+    };
+
+    /// \brief Per-entity columns for labels, landmarks, logos and text.
+    struct EntityColumns
+    {
+        /// \brief The response index of each entity.
+        std::vector<uint32_t> response;
+
+        /// \brief The kind of each entity.
+        std::vector<EntityKind> kind;
+
+        /// \brief The interned mid index of each entity.
+        std::vector<uint32_t> mid;
+
+        std::vector<float> score;
+        std::vector<float> topicality;
+    };
+
+    /// \brief The result of aggregating a column.
+    struct Aggregate
+    {
+        /// \brief The number of values that are not NaN.
+        std::size_t count = 0;
+
+        /// \brief The sum of the values.
+        double sum = 0;
+
+        /// \brief The smallest value, or NaN if there are none.
+        float min = 0;
+
+        /// \brief The largest value, or NaN if there are none.
+        float max = 0;
+
+        /// \returns the mean value, or NaN if there are none.
+        double mean() const;
+    };
+
+    /// \brief Create an empty VisionColumnStore.
+    VisionColumnStore();
+
+    /// \brief Destroy the VisionColumnStore.
+    ~VisionColumnStore();
+
+    /// \brief Append a response.
+    /// \param response The response to append.
+    /// \returns the response index.
+    std::size_t append(const AnnotateImageResponse& response);
+
+    /// \brief Remove all rows and interned mids.
+    void clear();
+
+    /// \returns the number of responses.
+    std::size_t size() const;
+
+    /// \returns the response columns.
+    const ResponseColumns& responses() const;
+
+    /// \returns the face columns.
+    const FaceColumns& faces() const;
+
+    /// \returns the entity columns.
+    const EntityColumns& entities() const;
+
+    /// \returns the interned mids, indexed by mid index.
+    const std::vector<std::string>& mids() const;
+
+    /// \brief Find the index of an interned mid.
+    /// \param mid The mid to find.
+    /// \param index The index to fill if found.
+    /// \returns true if the mid was found.
+    bool findMid(const std::string& mid, uint32_t& index) const;
+
+    /// \brief Get a landmark position.
+    /// \param face The face row.
+    /// \param type The landmark type.
+    /// \returns the position, or NaN if the landmark is missing, the type is
+    ///          UNKNOWN_LANDMARK or the face row is out of range.
+    glm::vec3 landmark(std::size_t face, FaceAnnotation::Landmark::Type type) const;
+
+    /// \brief Get the landmark slot of a landmark type.
+    /// \param type The landmark type, other than UNKNOWN_LANDMARK.
+    /// \returns the slot index.
+    static std::size_t slot(FaceAnnotation::Landmark::Type type);
+
+    /// \brief Find the rows whose value is in a range.
+    /// \param column The column to scan.
+    /// \param min The inclusive minimum.
+    /// \param max The inclusive maximum.
+    /// \param rows The rows to append matches to.
+    /// \returns the number of matches.
+    static std::size_t filter(const std::vector<float>& column,
+                              float min,
+                              float max,
+                              std::vector<uint32_t>& rows);
+
+    /// \brief Find the rows with a given value.
+    /// \param column The column to scan.
+    /// \param value The value to match.
+    /// \param rows The rows to append matches to.
+    /// \returns the number of matches.
+    static std::size_t filter(const std::vector<uint32_t>& column,
+                              uint32_t value,
+                              std::vector<uint32_t>& rows);
+
+    /// \brief Find the rows with at least a given Likelihood.
+    /// \param column The Likelihood::Type column to scan.
+    /// \param minimum The minimum Likelihood::Type.
+    /// \param rows The rows to append matches to.
+    /// \returns the number of matches.
+    static std::size_t filter(const std::vector<uint8_t>& column,
+                              Likelihood::Type minimum,
+                              std::vector<uint32_t>& rows);
+
+    /// \brief Aggregate a column, ignoring NaN values.
+    /// \param column The column to aggregate.
+    /// \returns the aggregate.
+    static Aggregate aggregate(const std::vector<float>& column);
+
+    /// \brief Aggregate selected rows of a column, ignoring NaN values.
+    /// \param column The column to aggregate.
+    /// \param rows The rows to aggregate.
+    /// \returns the aggregate.
+    static Aggregate aggregate(const std::vector<float>& column,
+                               const std::vector<uint32_t>& rows);
+
+private:
+    /// \brief Append the entities of one kind.
+    void appendEntities(uint32_t response,
+                        EntityKind kind,
+                        const std::vector<EntityAnnotation>& entities);
+
+    /// \brief Intern a mid.
+    uint32_t intern(const std::string& mid);
+
+    ResponseColumns _responses;
+
+    FaceColumns _faces;
+
+    EntityColumns _entities;
+
+    /// \brief Interned mids.
+    std::vector<std::string> _mids;
+
+    /// \brief An index of interned mids.
+    std::unordered_map<std::string, uint32_t> _midIndex;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
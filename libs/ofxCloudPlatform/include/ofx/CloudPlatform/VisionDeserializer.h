@@ -26,6 +26,12 @@ public:
     static bool fromJSON(const ofJson& json, ofPolyline& polyline);
     static bool fromJSON(const ofJson& json, glm::vec3& position);
     static bool fromJSON(const ofJson& json, ofColor& color);
+
+    /// \brief Estimate the memory used by a JSON tree.
+    /// \param json The JSON to measure.
+    /// \returns the estimated size in bytes.
+    static std::size_t memoryFootprint(const ofJson& json);
+
 private:
     VisionDeserializer() = delete;
     ~VisionDeserializer() = delete;
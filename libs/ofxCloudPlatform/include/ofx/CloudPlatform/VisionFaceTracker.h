@@ -0,0 +1,216 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/CloudPlatform/VisionQuads.h"
+#include "ofx/CloudPlatform/VisionResponse.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Tracks faces across successive responses of a live frame source.
+///
+/// Each response's faces are matched to the existing tracks with an optimal
+/// (Hungarian) assignment. The cost of a match combines the IoU of the face
+/// with the track's predicted bounding poly and the distance between their
+/// landmarks; either may admit a match, so fast faces whose boxes no longer
+/// overlap are still matched by their landmarks. Matched faces keep their
+/// track's id; unmatched faces start new tracks and tracks that go unmatched
+/// for too long are removed.
+///
+/// Between responses, faces() predicts each track's bounding polys and
+/// landmarks at a frame timestamp. Timestamps between a track's last two
+/// observations are interpolated and later ones are extrapolated with a
+/// smoothed per-vertex velocity, so the call rate can be well below the
+/// frame rate.
+///
+/// The tracker is not thread safe.
+///
+/// Usage:
+///
+///     void ofApp::update()
+///     {
+///         grabber.update();
+///
+///         if (grabber.isFrameNew())
+///             stream.submit(grabber.getPixels(), ofGetElapsedTimeMicros());
+///
+///         ofxGCP::VisionStream::Result result;
+///
+///         if (stream.tryGetResult(result))
+///             tracker.update(result.response, result.timestamp);
+///
+///         faces = tracker.faces(ofGetElapsedTimeMicros());
+///     }
+class VisionFaceTracker
+{
+public:
+    /// \brief Tracker settings.
+    struct Settings
+    {
+        /// \brief The minimum IoU of a face and a track's prediction to match.
+        float minIoU = 0.1f;
+
+        /// \brief The maximum landmark distance of a face and a track's
+        /// prediction to match, for faces below minIoU.
+        ///
+        /// The landmark distance is the mean distance between landmarks of
+        /// the same type, relative to the size of the face.
+        float maxLandmarkDistance = 0.75f;
+
+        /// \brief The weight of the landmark distance in the matching cost.
+        float landmarkWeight = 0.5f;
+
+        /// \brief The number of responses a track may go unmatched before it
+        /// is removed.
+        std::size_t maxMisses = 2;
+
+        /// \brief The weight [0, 1] of the newest velocity estimate.
+        ///
+        /// Lower values smooth detection jitter at the cost of slower
+        /// reaction to changes of motion.
+        float velocitySmoothing = 0.5f;
+
+        /// \brief The longest extrapolation in microseconds.
+        uint64_t maxPrediction = 500000;
+    };
+
+    /// \brief A tracked face.
+    struct Track
+    {
+        /// \brief The stable track id, starting at 1.
+        uint64_t id = 0;
+
+        /// \brief The face, observed or predicted.
+        FaceAnnotation face;
+
+        /// \brief The timestamp of the last observation.
+        uint64_t timestamp = 0;
+
+        /// \brief The number of responses the face was observed in.
+        uint64_t observations = 0;
+
+        /// \brief The number of responses since the last observation.
+        uint64_t misses = 0;
+    };
+
+    /// \brief Create a VisionFaceTracker with default settings.
+    VisionFaceTracker();
+
+    /// \brief Create a VisionFaceTracker with the given settings.
+    /// \param settings The settings to use.
+    VisionFaceTracker(const Settings& settings);
+
+    /// \brief Destroy the VisionFaceTracker.
+    ~VisionFaceTracker();
+
+    VisionFaceTracker(const VisionFaceTracker&) = default;
+    VisionFaceTracker(VisionFaceTracker&&) = default;
+    VisionFaceTracker& operator = (const VisionFaceTracker&) = default;
+    VisionFaceTracker& operator = (VisionFaceTracker&&) = default;
+
+    /// \brief Match the faces of a response to the tracks.
+    ///
+    /// Responses must be given in timestamp order; an older response than
+    /// the last one is ignored.
+    ///
+    /// \param response The response.
+    /// \param timestamp The source frame timestamp in microseconds.
+    /// \returns the track id of each of the response's faces, in order.
+    std::vector<uint64_t> update(const AnnotateImageResponse& response,
+                                 uint64_t timestamp);
+
+    /// \returns the tracks as last observed.
+    std::vector<Track> tracks() const;
+
+    /// \brief Predict the tracked faces at a frame timestamp.
+    /// \param timestamp The frame timestamp in microseconds.
+    /// \returns the tracks with their predicted faces.
+    std::vector<Track> faces(uint64_t timestamp) const;
+
+    /// \brief Predict a tracked face at a frame timestamp.
+    /// \param id The track id.
+    /// \param timestamp The frame timestamp in microseconds.
+    /// \param track The track to fill.
+    /// \returns false if there is no such track.
+    bool face(uint64_t id, uint64_t timestamp, Track& track) const;
+
+    /// \brief Remove all tracks.
+    void clear();
+
+    /// \returns the number of tracks.
+    std::size_t size() const;
+
+    /// \brief Solve a rectangular assignment problem.
+    ///
+    /// Uses the Hungarian method in O(n^2 m) for n = min(rows, columns) and
+    /// m = max(rows, columns).
+    ///
+    /// \param costs The row-major cost matrix.
+    /// \param rows The number of rows.
+    /// \param columns The number of columns.
+    /// \returns the column assigned to each row, or columns if none.
+    static std::vector<std::size_t> assign(const std::vector<float>& costs,
+                                           std::size_t rows,
+                                           std::size_t columns);
+
+private:
+    /// \brief A track and its motion state.
+    struct State
+    {
+        Track track;
+
+        /// \brief The tracked points: the four bounding poly vertices, the
+        /// four fd bounding poly vertices and the landmark positions.
+        std::vector<glm::vec3> points;
+
+        /// \brief The points of the previous observation.
+        std::vector<glm::vec3> previousPoints;
+
+        /// \brief The timestamp of the previous observation.
+        uint64_t previousTimestamp = 0;
+
+        /// \brief The velocity of each point in units per second.
+        std::vector<glm::vec3> velocity;
+    };
+
+    /// \brief Get the tracked points of a face.
+    static void points(const FaceAnnotation& face, std::vector<glm::vec3>& points);
+
+    /// \brief Predict the points of a track.
+    static void predict(const State& state,
+                        uint64_t timestamp,
+                        uint64_t maxPrediction,
+                        std::vector<glm::vec3>& points);
+
+    /// \brief Set the geometry of a face from tracked points.
+    static void apply(const std::vector<glm::vec3>& points, FaceAnnotation& face);
+
+    /// \returns true if two faces have the same landmark types in order.
+    static bool sameLandmarks(const FaceAnnotation& a, const FaceAnnotation& b);
+
+    /// \brief Update a track with an observation.
+    void observe(State& state, const FaceAnnotation& face, uint64_t timestamp);
+
+    Settings _settings;
+
+    std::vector<State> _states;
+
+    /// \brief The timestamp of the last update.
+    uint64_t _timestamp = 0;
+
+    /// \brief The id of the next track.
+    uint64_t _nextId = 1;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,203 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include "ofx/CloudPlatform/VisionClient.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A near-duplicate frame cache in front of a VisionClient.
+///
+/// Each frame is reduced to a 64-bit difference hash (dHash). When a new frame
+/// is within a Hamming distance of a recent frame, the recent frame's response
+/// is reused instead of calling the API.
+///
+/// Recent hashes are indexed with multi-index hashing: the hash is split into
+/// maxDistance + 1 chunks and, by the pigeonhole principle, any hash within
+/// maxDistance shares at least one chunk exactly. Lookups only compare against
+/// entries that share a chunk.
+///
+/// Responses with a per-image error are returned but never cached, and frames
+/// too small to hash are always sent to the API.
+///
+/// The cache is thread safe, but each thread must pass its own VisionClient.
+class VisionFrameCache
+{
+public:
+    enum
+    {
+        /// \brief The default number of recent frames to keep.
+        DEFAULT_CAPACITY = 256,
+
+        /// \brief The default maximum Hamming distance for reuse.
+        DEFAULT_MAX_DISTANCE = 6,
+
+        /// \brief The largest supported maximum Hamming distance.
+        MAX_DISTANCE_LIMIT = 15
+    };
+
+    /// \brief Frame cache settings.
+    struct Settings
+    {
+        /// \brief The number of recent frames to keep.
+        std::size_t capacity = DEFAULT_CAPACITY;
+
+        /// \brief The maximum Hamming distance [0, 15] between reused frames.
+        int maxDistance = DEFAULT_MAX_DISTANCE;
+
+        /// \brief Verify every Nth hit against the API, or 0 to disable.
+        ///
+        /// Verification measures the false reuse rate at the cost of some API
+        /// calls.
+        uint64_t verificationInterval = 0;
+
+        /// \brief The features to request for each frame.
+        std::vector<VisionRequestItem::Feature> features = VisionRequestItem::defaultFeatures();
+    };
+
+    /// \brief Frame cache statistics.
+    struct Statistics
+    {
+        /// \brief Frames answered from the cache.
+        uint64_t hits = 0;
+
+        /// \brief Frames sent to the API.
+        uint64_t misses = 0;
+
+        /// \brief Frames too small to hash, sent to the API without caching.
+        uint64_t bypasses = 0;
+
+        /// \brief Hits that were also sent to the API for verification.
+        ///
+        /// Verifications answered with an error are not counted.
+        uint64_t verifications = 0;
+
+        /// \brief Verified hits whose cached response did not match.
+        uint64_t falseReuses = 0;
+
+        /// \returns the fraction of frames answered from the cache.
+        double hitRate() const;
+
+        /// \returns the fraction of verified hits that did not match.
+        double falseReuseRate() const;
+    };
+
+    /// \brief Create a VisionFrameCache with default settings.
+    VisionFrameCache();
+
+    /// \brief Create a VisionFrameCache with the given settings.
+    /// \param settings The settings to use.
+    VisionFrameCache(const Settings& settings);
+
+    /// \brief Destroy the VisionFrameCache.
+    ~VisionFrameCache();
+
+    /// \brief Annotate a frame, reusing the response of a similar recent frame.
+    /// \param client The client used for cache misses.
+    /// \param pixels The frame pixels.
+    /// \returns the response.
+    /// \throws Poco::Net::HTTPException if the API request fails.
+    AnnotateImageResponse annotate(VisionClient& client, const ofPixels& pixels);
+
+    /// \brief Find the response of the nearest recent frame.
+    /// \param hash The frame hash.
+    /// \param response The response to fill if found.
+    /// \returns true if a frame within maxDistance was found.
+    bool find(uint64_t hash, AnnotateImageResponse& response);
+
+    /// \brief Add a frame response, evicting the oldest frame if full.
+    /// \param hash The frame hash.
+    /// \param response The frame response.
+    void insert(uint64_t hash, const AnnotateImageResponse& response);
+
+    /// \brief Remove all frames.
+    void clear();
+
+    /// \returns the frame cache statistics.
+    Statistics statistics() const;
+
+    /// \brief Compute the 64-bit difference hash of an image.
+    ///
+    /// The image is reduced to a 9x8 grid of mean luminance values and each
+    /// bit records whether a cell is brighter than its right neighbour.
+    ///
+    /// \param pixels The image pixels.
+    /// \param hash The difference hash to fill.
+    /// \returns false if the image is smaller than 9x8 or has no channels.
+    static bool dHash(const ofPixels& pixels, uint64_t& hash);
+
+    /// \brief Compute the Hamming distance between two hashes.
+    /// \param a The first hash.
+    /// \param b The second hash.
+    /// \returns the number of differing bits.
+    static int distance(uint64_t a, uint64_t b);
+
+    /// \brief Determine if two responses describe the same scene.
+    ///
+    /// Responses match if they contain the same number of faces, logos and
+    /// landmarks and their label sets mostly overlap.
+    ///
+    /// \param a The first response.
+    /// \param b The second response.
+    /// \returns true if the responses match.
+    static bool isEquivalent(const AnnotateImageResponse& a,
+                             const AnnotateImageResponse& b);
+
+private:
+    /// \brief A cached frame.
+    struct Entry
+    {
+        /// \brief A unique, increasing entry id.
+        uint64_t id = 0;
+
+        /// \brief The frame hash.
+        uint64_t hash = 0;
+
+        /// \brief The frame response.
+        std::shared_ptr<const AnnotateImageResponse> response;
+    };
+
+    /// \returns chunk i of a hash.
+    uint64_t chunk(uint64_t hash, std::size_t i) const;
+
+    /// \brief Find the nearest entry. The mutex must be held.
+    const Entry* findNearest(uint64_t hash) const;
+
+    /// \brief Insert an entry. The mutex must be held.
+    void insertEntry(uint64_t hash, std::shared_ptr<const AnnotateImageResponse> response);
+
+    Settings _settings;
+
+    /// \brief The shared request parameters.
+    std::shared_ptr<const VisionRequestTemplate> _template;
+
+    /// \brief Entries, oldest first.
+    std::deque<Entry> _entries;
+
+    /// \brief For each chunk, a map of chunk values to entry ids.
+    std::vector<std::unordered_multimap<uint64_t, uint64_t>> _chunkIndex;
+
+    /// \brief The id of the next entry.
+    uint64_t _nextId = 0;
+
+    Statistics _statistics;
+
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Fast non-cryptographic hashing of image content and requests.
+class VisionHash
+{
+public:
+    /// \brief Compute the 64-bit xxHash of a block of memory.
+    ///
+    /// This processes 32 bytes per iteration and is typically limited by
+    /// memory bandwidth, so hashing an encoded image is far cheaper than
+    /// sending it.
+    ///
+    /// \param data The data to hash.
+    /// \param size The number of bytes to hash.
+    /// \param seed The hash seed.
+    /// \returns the hash value.
+    static std::uint64_t hash(const void* data,
+                              std::size_t size,
+                              std::uint64_t seed = 0);
+
+    /// \brief Compute the 64-bit xxHash of a string.
+    /// \param text The string to hash.
+    /// \param seed The hash seed.
+    /// \returns the hash value.
+    static std::uint64_t hash(const std::string& text, std::uint64_t seed = 0);
+
+    /// \brief Combine two hash values.
+    /// \param seed The existing hash value.
+    /// \param value The hash value to mix in.
+    /// \returns the combined hash value.
+    static std::uint64_t combine(std::uint64_t seed, std::uint64_t value);
+
+    /// \brief Compute the 32-bit FNV-1a hash of a string at compile time.
+    ///
+    /// This is meant for switching on short strings. Each case label is
+    /// checked at compile time, so a hash collision between two labels is a
+    /// duplicate case error.
+    ///
+    /// \param text The characters to hash.
+    /// \param size The number of characters to hash.
+    /// \param hash The hash of any preceding characters.
+    /// \returns the hash value.
+    static constexpr std::uint32_t fnv1a(const char* text,
+                                         std::size_t size,
+                                         std::uint32_t hash = 2166136261u)
+    {
+        return size == 0 ? hash : fnv1a(text + 1,
+                                        size - 1,
+                                        (hash ^ static_cast<unsigned char>(text[0])) * 16777619u);
+    }
+
+    /// \brief Compute the 32-bit FNV-1a hash of a string literal.
+    /// \param text The string literal to hash.
+    /// \returns the hash value.
+    template <std::size_t N>
+    static constexpr std::uint32_t fnv1a(const char (&text)[N])
+    {
+        return fnv1a(text, N - 1);
+    }
+
+    /// \brief Compute the 32-bit FNV-1a hash of a string.
+    /// \param text The string to hash.
+    /// \returns the hash value.
+    static std::uint32_t fnv1a(const std::string& text)
+    {
+        std::uint32_t hash = 2166136261u;
+
+        for (unsigned char c: text)
+        {
+            hash = (hash ^ c) * 16777619u;
+        }
+
+        return hash;
+    }
+
+private:
+    VisionHash() = delete;
+    ~VisionHash() = delete;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include "Poco/SharedMemory.h"
+#include "ofFileUtils.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Immutable encoded image bytes for a request item.
+///
+/// Content is shared by reference between request items, requests and
+/// retries, so one encoded image is never copied. The base64 form required by
+/// the Vision API is produced while the request body is written.
+class VisionImageContent
+{
+public:
+    /// \brief Destroy the VisionImageContent.
+    virtual ~VisionImageContent();
+
+    /// \returns a pointer to the encoded image bytes.
+    virtual const char* data() const = 0;
+
+    /// \returns the number of encoded image bytes.
+    virtual std::size_t size() const = 0;
+
+    /// \returns the size of the base64 representation.
+    std::size_t base64Size() const;
+
+    /// \brief Write the base64 representation in fixed size chunks.
+    /// \param output The stream to write to.
+    void writeBase64(std::ostream& output) const;
+
+    /// \returns the base64 representation as a string.
+    std::string toBase64() const;
+
+};
+
+
+/// \brief Image content held in memory.
+class BufferImageContent: public VisionImageContent
+{
+public:
+    /// \brief Create content by copying an encoded image.
+    /// \param buffer The encoded image bytes.
+    BufferImageContent(const ofBuffer& buffer);
+
+    /// \brief Create content by taking ownership of an encoded image.
+    /// \param buffer The encoded image bytes.
+    BufferImageContent(ofBuffer&& buffer);
+
+    /// \brief Destroy the BufferImageContent.
+    virtual ~BufferImageContent();
+
+    const char* data() const override;
+
+    std::size_t size() const override;
+
+private:
+    /// \brief The encoded image bytes.
+    ofBuffer _buffer;
+
+};
+
+
+/// \brief Image content memory mapped from a file.
+///
+/// The file is never read into the heap. Pages are loaded by the operating
+/// system as the base64 encoder walks the file, and may be dropped again
+/// under memory pressure, so large files cost little resident memory.
+///
+/// The file must not be modified while the content is in use.
+class MappedFileImageContent: public VisionImageContent
+{
+public:
+    /// \brief Create content by mapping a file.
+    /// \param path The path to the encoded image file.
+    /// \throws Poco::Exception if the file cannot be mapped.
+    MappedFileImageContent(const std::string& path);
+
+    /// \brief Destroy the MappedFileImageContent.
+    virtual ~MappedFileImageContent();
+
+    const char* data() const override;
+
+    std::size_t size() const override;
+
+    /// \returns the path of the mapped file.
+    const std::string& path() const;
+
+private:
+    /// \brief The path of the mapped file.
+    std::string _path;
+
+    /// \brief The size of the mapped file.
+    std::size_t _size = 0;
+
+    /// \brief The file mapping, or nullptr if the file is empty.
+    std::unique_ptr<Poco::SharedMemory> _memory;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
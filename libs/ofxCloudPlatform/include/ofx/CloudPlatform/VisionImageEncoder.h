@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <vector>
+#include "ofImage.h"
+
+
+struct FIMEMORY;
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A JPEG encoder that searches quality to fit a byte budget.
+///
+/// The encoder keeps its working pixels and memory streams between calls, so
+/// a single instance can be reused for every frame of a stream. It is not
+/// thread safe; use one encoder per thread.
+class VisionImageEncoder
+{
+public:
+    /// \brief JPEG chroma subsampling modes.
+    enum class ChromaSubsampling
+    {
+        /// \brief No chroma subsampling (highest fidelity).
+        CHROMA_444,
+
+        /// \brief Horizontal chroma subsampling.
+        CHROMA_422,
+
+        /// \brief Horizontal and vertical chroma subsampling (libjpeg default).
+        CHROMA_420,
+
+        /// \brief Aggressive horizontal chroma subsampling.
+        CHROMA_411
+    };
+
+    enum
+    {
+        /// \brief The default byte budget.
+        DEFAULT_TARGET_BYTES = 256 * 1024,
+
+        /// \brief The default minimum JPEG quality.
+        DEFAULT_MIN_QUALITY = 10,
+
+        /// \brief The default maximum JPEG quality.
+        DEFAULT_MAX_QUALITY = 95,
+
+        /// \brief The default maximum number of encoding attempts.
+        DEFAULT_MAX_ATTEMPTS = 8
+    };
+
+    /// \brief Settings for a byte budget encoding.
+    struct Settings
+    {
+        /// \brief The maximum encoded size in bytes.
+        std::size_t targetBytes = DEFAULT_TARGET_BYTES;
+
+        /// \brief The lowest JPEG quality [1, 100] that may be used.
+        int minQuality = DEFAULT_MIN_QUALITY;
+
+        /// \brief The highest JPEG quality [1, 100] that may be used.
+        int maxQuality = DEFAULT_MAX_QUALITY;
+
+        /// \brief The maximum number of encoder runs per image.
+        std::size_t maxAttempts = DEFAULT_MAX_ATTEMPTS;
+
+        /// \brief Subsampling modes to try, most preferred first.
+        ///
+        /// The next mode is only tried when the previous one cannot meet the
+        /// budget at minQuality.
+        std::vector<ChromaSubsampling> chromaSubsampling = { ChromaSubsampling::CHROMA_420 };
+    };
+
+    /// \brief The outcome of a byte budget encoding.
+    struct Result
+    {
+        /// \brief The encoded size in bytes.
+        std::size_t size = 0;
+
+        /// \brief The JPEG quality of the chosen encoding.
+        int quality = 0;
+
+        /// \brief The chroma subsampling of the chosen encoding.
+        ChromaSubsampling chromaSubsampling = ChromaSubsampling::CHROMA_420;
+
+        /// \brief The number of encoder runs used.
+        std::size_t attempts = 0;
+
+        /// \brief True if the encoding is no larger than the target.
+        ///
+        /// If false, the smallest encoding found is returned.
+        bool withinBudget = false;
+    };
+
+    /// \brief Create a VisionImageEncoder.
+    VisionImageEncoder();
+
+    /// \brief Destroy the VisionImageEncoder.
+    ~VisionImageEncoder();
+
+    /// \brief Encode pixels as a JPEG no larger than the target size.
+    ///
+    /// Quality is found with a binary search. The best encoding is kept in
+    /// one of two alternating memory streams, so no attempt is copied until
+    /// the final result is written to the buffer.
+    ///
+    /// \param pixels The pixels to encode.
+    /// \param settings The byte budget settings.
+    /// \param buffer The buffer to fill with the encoded image.
+    /// \returns the encoding result.
+    Result encode(const ofPixels& pixels,
+                  const Settings& settings,
+                  ofBuffer& buffer);
+
+private:
+    VisionImageEncoder(const VisionImageEncoder&) = delete;
+    VisionImageEncoder& operator = (const VisionImageEncoder&) = delete;
+
+    /// \brief A working copy of the pixels in FreeImage channel order.
+    ofPixels _pixels;
+
+    /// \brief The stream holding the best encoding so far.
+    FIMEMORY* _best = nullptr;
+
+    /// \brief The stream used for the current attempt.
+    FIMEMORY* _current = nullptr;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
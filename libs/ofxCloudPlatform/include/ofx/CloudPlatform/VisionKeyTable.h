@@ -0,0 +1,246 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A perfect hash table of json keys, generated at compile time.
+///
+/// The constructor searches for a seed that gives each key its own slot, so
+/// a lookup is one hash, one slot load and one confirming comparison. When
+/// the table is constexpr the search runs at compile time; check isValid()
+/// in a static_assert.
+///
+/// Usage:
+///
+///     enum { MID, SCORE, NUM_KEYS };
+///     constexpr const char* KEY_NAMES[NUM_KEYS] = { "mid", "score" };
+///     constexpr VisionKeyTable<NUM_KEYS> KEYS(KEY_NAMES);
+///     static_assert(KEYS.isValid(), "No perfect hash.");
+///
+///     switch (KEYS.find(key))
+///     {
+///         case MID: ...
+///         case SCORE: ...
+///         default: // Unknown key.
+///     }
+///
+/// \tparam N The number of keys.
+template <std::size_t N>
+class VisionKeyTable
+{
+public:
+    enum
+    {
+        /// \brief The number of slot bits, giving at least four slots per key.
+        SLOT_BITS = N <= 4 ? 4 : N <= 8 ? 5 : N <= 16 ? 6 : N <= 32 ? 7 : 8,
+
+        /// \brief The number of slots.
+        NUM_SLOTS = 1 << SLOT_BITS,
+
+        /// \brief The number of seeds to try.
+        MAX_SEEDS = 4096
+    };
+
+    static_assert(N > 0 && N < 64, "VisionKeyTable supports 1 to 63 keys.");
+
+    /// \brief Create a VisionKeyTable.
+    /// \param keys The keys. The index of each key is its lookup result.
+    constexpr VisionKeyTable(const char* const (&keys)[N]):
+        VisionKeyTable(keys,
+                       findSeed(keys, 0, MAX_SEEDS),
+                       typename MakeIndices<N>::Type(),
+                       typename MakeIndices<NUM_SLOTS>::Type())
+    {
+    }
+
+    /// \brief Find a key.
+    /// \param key The key to find.
+    /// \returns the index of the key, or N if it is not in the table.
+    std::size_t find(const std::string& key) const
+    {
+        std::size_t index = _slots[slot(hash(key.data(), key.size(), _seed))];
+
+        if (index < N
+        &&  _sizes[index] == key.size()
+        &&  std::memcmp(_keys[index], key.data(), key.size()) == 0)
+        {
+            return index;
+        }
+
+        return N;
+    }
+
+    /// \returns the key at an index.
+    constexpr const char* key(std::size_t index) const
+    {
+        return _keys[index];
+    }
+
+    /// \returns true if a perfect hash was found.
+    constexpr bool isValid() const
+    {
+        return _valid;
+    }
+
+private:
+    // The table is built with C++11 constexpr functions, i.e. recursion
+    // rather than loops, so it also builds with older compilers.
+
+    /// \brief A pack of indices.
+    template <std::size_t... I>
+    struct Indices
+    {
+    };
+
+    /// \brief Make the indices 0 to M - 1.
+    template <std::size_t M, std::size_t... I>
+    struct MakeIndices: MakeIndices<M - 1, M - 1, I...>
+    {
+    };
+
+    template <std::size_t... I>
+    struct MakeIndices<0, I...>
+    {
+        typedef Indices<I...> Type;
+    };
+
+    /// \brief Fill the table for a seed, or MAX_SEEDS if none was found.
+    template <std::size_t... K, std::size_t... S>
+    constexpr VisionKeyTable(const char* const (&keys)[N],
+                             std::uint32_t seed,
+                             Indices<K...>,
+                             Indices<S...>):
+        _keys{ keys[K]... },
+        _sizes{ length(keys[K])... },
+        _slots{ slotKey(keys, seed, S, 0)... },
+        _seed(seed < MAX_SEEDS ? seed : 0),
+        _valid(seed < MAX_SEEDS)
+    {
+    }
+
+    /// \returns the length of a key.
+    static constexpr std::size_t length(const char* text)
+    {
+        return *text == '\0' ? 0 : 1 + length(text + 1);
+    }
+
+    /// \returns the seeded FNV-1a hash of a key.
+    static constexpr std::uint32_t hash(const char* text,
+                                        std::size_t size,
+                                        std::uint32_t seed)
+    {
+        return hashFrom(text, size, 2166136261u ^ (seed * 0x9E3779B9u));
+    }
+
+    /// \returns the FNV-1a hash of a key continued from a hash.
+    static constexpr std::uint32_t hashFrom(const char* text,
+                                            std::size_t size,
+                                            std::uint32_t result)
+    {
+        return size == 0 ? result : hashFrom(text + 1,
+                                             size - 1,
+                                             (result ^ static_cast<unsigned char>(*text)) * 16777619u);
+    }
+
+    /// \returns the slot of a key for a seed.
+    static constexpr std::size_t keySlot(const char* key, std::uint32_t seed)
+    {
+        return slot(hash(key, length(key), seed));
+    }
+
+    /// \returns true if key i collides with none of the keys from j.
+    static constexpr bool isUnique(const char* const (&keys)[N],
+                                   std::uint32_t seed,
+                                   std::size_t i,
+                                   std::size_t j)
+    {
+        return j >= N || (keySlot(keys[i], seed) != keySlot(keys[j], seed)
+                          && isUnique(keys, seed, i, j + 1));
+    }
+
+    /// \returns true if no two keys from i share a slot for a seed.
+    static constexpr bool isPerfect(const char* const (&keys)[N],
+                                    std::uint32_t seed,
+                                    std::size_t i)
+    {
+        return i >= N || (isUnique(keys, seed, i, i + 1)
+                          && isPerfect(keys, seed, i + 1));
+    }
+
+    /// \returns the first perfect seed in [begin, end), or MAX_SEEDS.
+    ///
+    /// The range is halved so the recursion depth is only log2(MAX_SEEDS).
+    static constexpr std::uint32_t findSeed(const char* const (&keys)[N],
+                                            std::uint32_t begin,
+                                            std::uint32_t end)
+    {
+        return end - begin == 1
+            ? (isPerfect(keys, begin, 0) ? begin : std::uint32_t(MAX_SEEDS))
+            : findSeedAfter(keys,
+                            findSeed(keys, begin, begin + (end - begin) / 2),
+                            begin + (end - begin) / 2,
+                            end);
+    }
+
+    /// \returns first if it is a perfect seed, otherwise the first perfect
+    /// seed in [begin, end), or MAX_SEEDS.
+    static constexpr std::uint32_t findSeedAfter(const char* const (&keys)[N],
+                                                 std::uint32_t first,
+                                                 std::uint32_t begin,
+                                                 std::uint32_t end)
+    {
+        return first != MAX_SEEDS ? first : findSeed(keys, begin, end);
+    }
+
+    /// \returns the index of the key from i in a slot, or N if empty.
+    static constexpr std::uint8_t slotKey(const char* const (&keys)[N],
+                                          std::uint32_t seed,
+                                          std::size_t slotIndex,
+                                          std::size_t i)
+    {
+        return i >= N || seed >= MAX_SEEDS
+            ? std::uint8_t(N)
+            : keySlot(keys[i], seed) == slotIndex
+                ? std::uint8_t(i)
+                : slotKey(keys, seed, slotIndex, i + 1);
+    }
+
+    /// \returns the slot of a hash, taken from its well mixed high bits.
+    static constexpr std::size_t slot(std::uint32_t hash)
+    {
+        return (hash * 0x85EBCA6Bu) >> (32 - SLOT_BITS);
+    }
+
+    /// \brief The keys.
+    const char* _keys[N];
+
+    /// \brief The key lengths.
+    std::size_t _sizes[N];
+
+    /// \brief The key index of each slot, or N if empty.
+    std::uint8_t _slots[NUM_SLOTS];
+
+    /// \brief The seed.
+    std::uint32_t _seed;
+
+    /// \brief True if the seed gives each key its own slot.
+    bool _valid;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
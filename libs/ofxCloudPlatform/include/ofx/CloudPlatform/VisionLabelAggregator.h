@@ -0,0 +1,239 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <mutex>
+#include <unordered_map>
+#include "ofx/CloudPlatform/VisionResponse.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Streaming top labels of an image stream over a sliding window.
+///
+/// Label counts are kept in a count-min sketch per time bucket rather than
+/// per label, so memory is fixed by the settings regardless of how many
+/// labels or distinct mids are added. The window slides one bucket at a time.
+/// The heaviest labels are kept as candidates in a min-heap of bounded
+/// capacity, so an update costs O(depth + log capacity).
+///
+/// Counts are estimates: the sketch never undercounts, and overcounts by at
+/// most e / width of the window total with probability 1 - e^-depth. A label
+/// that was outside the candidates when it became heavy is only reported
+/// once it is added again.
+///
+/// Use one aggregator per camera. The aggregator is thread safe.
+///
+/// Usage:
+///
+///     VisionLabelAggregator::Settings settings;
+///     settings.window = 10 * 60 * 1000000ull;
+///     VisionLabelAggregator labels(settings);
+///
+///     if (stream.tryGetResult(result))
+///         labels.add(result.response, VisionLog::now());
+///
+///     for (const auto& label: labels.top(10))
+///         ofDrawBitmapString(label.description + " " + ofToString(label.count), x, y += 14);
+class VisionLabelAggregator
+{
+public:
+    enum
+    {
+        /// \brief The default number of counters in each sketch row.
+        DEFAULT_WIDTH = 2048,
+
+        /// \brief The default number of sketch rows.
+        DEFAULT_DEPTH = 4,
+
+        /// \brief The default number of time buckets per window.
+        DEFAULT_BUCKETS = 10,
+
+        /// \brief The default number of candidate labels.
+        DEFAULT_CAPACITY = 64
+    };
+
+    /// \brief Aggregator settings.
+    struct Settings
+    {
+        /// \brief The window length in microseconds.
+        uint64_t window = 10 * 60 * uint64_t(1000000);
+
+        /// \brief The number of buckets the window is divided into.
+        ///
+        /// The window slides by window / buckets.
+        std::size_t buckets = DEFAULT_BUCKETS;
+
+        /// \brief The number of counters in each sketch row.
+        std::size_t width = DEFAULT_WIDTH;
+
+        /// \brief The number of sketch rows.
+        std::size_t depth = DEFAULT_DEPTH;
+
+        /// \brief The number of candidate labels, an upper bound for top().
+        std::size_t capacity = DEFAULT_CAPACITY;
+
+        /// \brief Count each label by its score rather than by 1.
+        bool weighted = true;
+
+        /// \brief Labels with a lower score are ignored.
+        float minScore = 0;
+    };
+
+    /// \brief A counted label.
+    struct Label
+    {
+        std::string mid;
+        std::string description;
+
+        /// \brief The estimated count in the window.
+        float count = 0;
+    };
+
+    /// \brief Aggregator statistics.
+    struct Statistics
+    {
+        /// \brief The number of responses added.
+        uint64_t responses = 0;
+
+        /// \brief The number of labels added.
+        uint64_t labels = 0;
+
+        /// \brief The number of labels older than the window that were ignored.
+        uint64_t labelsExpired = 0;
+
+        /// \brief The number of times a candidate was replaced by a heavier label.
+        uint64_t replacements = 0;
+    };
+
+    /// \brief Create a VisionLabelAggregator with default settings.
+    VisionLabelAggregator();
+
+    /// \brief Create a VisionLabelAggregator with the given settings.
+    /// \param settings The settings to use.
+    VisionLabelAggregator(const Settings& settings);
+
+    /// \brief Destroy the VisionLabelAggregator.
+    ~VisionLabelAggregator();
+
+    VisionLabelAggregator(const VisionLabelAggregator&) = delete;
+    VisionLabelAggregator& operator = (const VisionLabelAggregator&) = delete;
+
+    /// \brief Add the label annotations of a response.
+    /// \param response The response.
+    /// \param timestamp The time in microseconds, e.g. VisionLog::now().
+    void add(const AnnotateImageResponse& response, uint64_t timestamp);
+
+    /// \brief Add a label annotation.
+    /// \param label The label annotation.
+    /// \param timestamp The time in microseconds.
+    void add(const EntityAnnotation& label, uint64_t timestamp);
+
+    /// \brief Add a weighted count of a label.
+    /// \param mid The label mid.
+    /// \param description The label description, kept for candidates.
+    /// \param weight The weight to add.
+    /// \param timestamp The time in microseconds.
+    void add(const std::string& mid,
+             const std::string& description,
+             float weight,
+             uint64_t timestamp);
+
+    /// \brief Slide the window forward without adding labels.
+    ///
+    /// Windows also slide when labels are added, so this is only needed to
+    /// expire counts while a stream is idle.
+    ///
+    /// \param timestamp The time in microseconds.
+    void advance(uint64_t timestamp);
+
+    /// \brief Get the heaviest labels in the window.
+    /// \param count The maximum number of labels, at most the capacity.
+    /// \returns the labels, heaviest first.
+    std::vector<Label> top(std::size_t count) const;
+
+    /// \brief Estimate the count of a label in the window.
+    /// \param mid The label mid.
+    /// \returns the estimated count.
+    float estimate(const std::string& mid) const;
+
+    /// \returns the total count of all labels in the window.
+    float total() const;
+
+    /// \brief Remove all counts.
+    void clear();
+
+    /// \returns the aggregator statistics.
+    Statistics statistics() const;
+
+    /// \returns the memory used by the sketches and candidates in bytes.
+    std::size_t memoryFootprint() const;
+
+private:
+    /// \brief A candidate heavy hitter.
+    struct Candidate
+    {
+        uint64_t key = 0;
+        std::string mid;
+        std::string description;
+        float count = 0;
+    };
+
+    /// \brief Slide the window to a bucket epoch. The mutex must be held.
+    void advanceTo(uint64_t epoch);
+
+    /// \returns the window estimate of a key. The mutex must be held.
+    float estimateKey(uint64_t key) const;
+
+    /// \returns the counter column of a key in a sketch row.
+    std::size_t column(uint64_t key, std::size_t row) const;
+
+    /// \brief Restore the heap order after a candidate's count increased.
+    void siftDown(std::size_t position);
+
+    /// \brief Restore the heap order after a candidate's count decreased.
+    void siftUp(std::size_t position);
+
+    /// \brief Swap two candidates and their positions.
+    void swap(std::size_t a, std::size_t b);
+
+    Settings _settings;
+
+    /// \brief The bucket length in microseconds.
+    uint64_t _interval = 0;
+
+    /// \brief The sketch counters of each bucket, bucket-major then row-major.
+    std::vector<float> _buckets;
+
+    /// \brief The sum of the bucket sketches.
+    std::vector<float> _window;
+
+    /// \brief The epoch, i.e. timestamp / interval, of the newest bucket.
+    /// Bucket epoch % buckets holds the counts of that epoch.
+    uint64_t _epoch = 0;
+
+    /// \brief The total count of each bucket.
+    std::vector<float> _totals;
+
+    /// \brief The candidates as a min-heap by count.
+    std::vector<Candidate> _candidates;
+
+    /// \brief The heap position of each candidate key.
+    std::unordered_map<uint64_t, std::size_t> _positions;
+
+    Statistics _statistics;
+
+    mutable std::mutex _mutex;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,391 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "ofx/CloudPlatform/VisionRequestItem.h"
+#include "ofx/CloudPlatform/VisionSnapshot.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Shared definitions of the VisionLog file format.
+///
+/// A log is a directory of segment files named by the sequence number of
+/// their first record, e.g. "00000000000000000000.log". A segment is a
+/// SegmentHeader followed by framed records; each record is a RecordHeader
+/// and a VisionSnapshot record. Records are checksummed, so a torn write at
+/// the end of a segment ends the segment rather than corrupting it.
+///
+/// Each segment has a sparse index file, e.g. "00000000000000000000.idx",
+/// with one IndexEntry per block of records. An entry holds the time range
+/// and a small Bloom filter of the image ids in its block, so lookups only
+/// read the blocks that may match. Records after the last indexed block are
+/// found by scanning the end of the segment.
+class VisionLogFormat
+{
+public:
+    enum
+    {
+        /// \brief The current format version.
+        VERSION = 1,
+
+        /// \brief The number of 64-bit words in a block's image id filter.
+        FILTER_WORDS = 4
+    };
+
+    /// \brief The start of segment and index files.
+    struct SegmentHeader
+    {
+        char magic[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        uint32_t version = VERSION;
+
+        /// \brief 0x01020304 in the byte order of the writer.
+        uint32_t byteOrder = 0x01020304;
+
+        /// \brief The sequence number of the segment's first record.
+        uint64_t firstSequence = 0;
+    };
+
+    /// \brief The start of every record in a segment.
+    struct RecordHeader
+    {
+        /// \brief The size of the VisionSnapshot record that follows.
+        uint32_t size = 0;
+
+        /// \brief A checksum of the header fields and record.
+        uint32_t checksum = 0;
+
+        uint64_t imageId = 0;
+
+        /// \brief Microseconds since the Unix epoch.
+        uint64_t timestamp = 0;
+    };
+
+    /// \brief A sparse index entry for a block of records.
+    struct IndexEntry
+    {
+        /// \brief The segment offset of the block's first record.
+        uint64_t offset = 0;
+
+        /// \brief The sequence number of the block's first record.
+        uint64_t firstSequence = 0;
+
+        uint64_t minTimestamp = 0;
+        uint64_t maxTimestamp = 0;
+
+        /// \brief A Bloom filter of the block's image ids.
+        uint64_t filter[FILTER_WORDS] = { 0, 0, 0, 0 };
+
+        /// \brief The size of the block in bytes.
+        uint32_t size = 0;
+
+        /// \brief The number of records in the block.
+        uint32_t count = 0;
+
+        /// \brief Add a record to the entry.
+        void add(const RecordHeader& header, std::size_t recordSize);
+
+        /// \returns false if the block definitely has no record of the image.
+        bool mayContain(uint64_t imageId) const;
+
+        /// \returns true if the block's time range overlaps [begin, end).
+        bool overlaps(uint64_t begin, uint64_t end) const;
+    };
+
+    /// \returns the checksum of a record.
+    static uint32_t checksum(const RecordHeader& header, const char* record);
+
+    /// \returns the file name of a segment without its extension.
+    static std::string segmentName(uint64_t firstSequence);
+
+    static const char SEGMENT_MAGIC[8];
+    static const char INDEX_MAGIC[8];
+
+};
+
+
+/// \brief A durable, append-only log of annotation responses.
+///
+/// Responses are appended with an image id and timestamp and are readable
+/// with a VisionLogReader. Appends only serialize the response and queue it;
+/// a commit thread writes queued records and syncs them to disk with one
+/// fsync per group, so concurrent writers share the cost of a sync.
+///
+/// The log is thread safe.
+///
+/// Usage:
+///
+///     VisionLog::Settings settings;
+///     settings.path = "annotations";
+///     VisionLog log(settings);
+///
+///     auto responses = client.annotate(items);
+///     log.sync(log.append(items, responses));
+class VisionLog
+{
+public:
+    enum
+    {
+        /// \brief The default segment size limit in bytes.
+        DEFAULT_MAX_SEGMENT_BYTES = 64 * 1024 * 1024,
+
+        /// \brief The default number of records per index entry.
+        DEFAULT_INDEX_INTERVAL = 32,
+
+        /// \brief The default maximum commit delay in microseconds.
+        DEFAULT_COMMIT_INTERVAL = 10000
+    };
+
+    /// \brief Log settings.
+    struct Settings
+    {
+        /// \brief The log directory. It is created if needed.
+        std::string path;
+
+        /// \brief A new segment is started when a segment would exceed this size.
+        std::size_t maxSegmentBytes = DEFAULT_MAX_SEGMENT_BYTES;
+
+        /// \brief The number of records covered by each index entry.
+        std::size_t indexInterval = DEFAULT_INDEX_INTERVAL;
+
+        /// \brief The longest time an appended record waits to be committed,
+        /// in microseconds, unless sync() is called.
+        uint64_t commitInterval = DEFAULT_COMMIT_INTERVAL;
+    };
+
+    /// \brief Log statistics.
+    struct Statistics
+    {
+        /// \brief The number of records appended.
+        uint64_t records = 0;
+
+        /// \brief The number of record bytes committed.
+        uint64_t bytes = 0;
+
+        /// \brief The number of group commits, i.e. fsyncs.
+        uint64_t commits = 0;
+
+        /// \brief The number of segments created.
+        uint64_t segments = 0;
+    };
+
+    /// \brief Open a log, starting a new segment after any existing ones.
+    /// \param settings The settings to use.
+    /// \throws Poco::Exception if the first segment cannot be created.
+    VisionLog(const Settings& settings);
+
+    /// \brief Commit all records and close the log.
+    ~VisionLog();
+
+    VisionLog(const VisionLog&) = delete;
+    VisionLog& operator = (const VisionLog&) = delete;
+
+    /// \brief Append a response.
+    /// \param imageId The image id, e.g. VisionCache::key() or imageId().
+    /// \param response The response.
+    /// \param timestamp The time in microseconds since the Unix epoch.
+    /// \returns the sequence number of the record.
+    uint64_t append(uint64_t imageId,
+                    const AnnotateImageResponse& response,
+                    uint64_t timestamp);
+
+    /// \brief Append a response with the current time.
+    /// \param imageId The image id, e.g. VisionCache::key() or imageId().
+    /// \param response The response.
+    /// \returns the sequence number of the record.
+    uint64_t append(uint64_t imageId, const AnnotateImageResponse& response);
+
+    /// \brief Append the results of VisionClient::annotate().
+    ///
+    /// Each response is keyed by VisionCache::key() of its request item.
+    ///
+    /// \param items The request items.
+    /// \param responses The responses, in the same order as the items.
+    /// \returns the sequence number of the last record.
+    uint64_t append(const std::vector<VisionRequestItem>& items,
+                    const std::vector<AnnotateImageResponse>& responses);
+
+    /// \brief Wait until a record and all records before it are on disk.
+    /// \param sequence The record's sequence number.
+    /// \throws Poco::Exception if a commit failed.
+    void sync(uint64_t sequence);
+
+    /// \brief Wait until all appended records are on disk.
+    /// \throws Poco::Exception if a commit failed.
+    void sync();
+
+    /// \returns the log statistics.
+    Statistics statistics() const;
+
+    /// \returns the image id of a string, such as a file name or URI.
+    static uint64_t imageId(const std::string& id);
+
+    /// \returns the current time in microseconds since the Unix epoch.
+    static uint64_t now();
+
+private:
+    /// \brief The commit thread.
+    void run();
+
+    /// \brief Write a group of records and sync them.
+    ///
+    /// Only called by the commit thread, without the mutex held.
+    void commit(const std::string& records);
+
+    /// \brief Start a new segment and sync the log directory.
+    ///
+    /// Only called by the commit thread.
+    void openSegment(uint64_t firstSequence);
+
+    /// \brief Index and close the current segment. Only called by the commit thread.
+    void closeSegment();
+
+    /// \brief Append the current index entry. Only called by the commit thread.
+    void writeIndexEntry();
+
+    Settings _settings;
+
+    /// \brief Framed records waiting to be committed.
+    std::string _pending;
+
+    /// \brief The sequence number of the next appended record.
+    uint64_t _nextSequence = 0;
+
+    /// \brief The first sequence number that is not yet on disk.
+    uint64_t _durableSequence = 0;
+
+    /// \brief The number of threads waiting in sync().
+    std::size_t _waiters = 0;
+
+    /// \brief The first commit error, if any.
+    std::string _error;
+
+    bool _stop = false;
+
+    Statistics _statistics;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+    // The segment state below is only used by the commit thread.
+    std::FILE* _segment = nullptr;
+    std::FILE* _index = nullptr;
+    uint64_t _segmentBytes = 0;
+    uint64_t _writtenSequence = 0;
+    VisionLogFormat::IndexEntry _entry;
+
+    std::thread _thread;
+
+};
+
+
+/// \brief Reads a VisionLog directory.
+///
+/// Segments are memory mapped and their index files are read when the
+/// reader is opened. Only the mapped pages of blocks that may match are read
+/// by a lookup. The reader sees the records that were on disk when it was
+/// opened or last refreshed. The reader is not thread safe.
+class VisionLogReader
+{
+public:
+    /// \brief A zero-copy view of a log record.
+    ///
+    /// The record is only valid while the reader is open and unrefreshed.
+    struct Entry
+    {
+        uint64_t sequence = 0;
+        uint64_t imageId = 0;
+        uint64_t timestamp = 0;
+        VisionSnapshot::Record record = VisionSnapshot::Record(nullptr);
+    };
+
+    /// \brief A callback for each matching entry. Return false to stop.
+    typedef std::function<bool(const Entry&)> Callback;
+
+    /// \brief Open a log directory.
+    /// \param path The log directory.
+    VisionLogReader(const std::string& path);
+
+    /// \brief Destroy the VisionLogReader.
+    ~VisionLogReader();
+
+    VisionLogReader(const VisionLogReader&) = delete;
+    VisionLogReader& operator = (const VisionLogReader&) = delete;
+
+    /// \brief Reload the list of segments and their indices.
+    void refresh();
+
+    /// \returns the number of segments.
+    std::size_t segments() const;
+
+    /// \returns the number of readable records.
+    uint64_t size() const;
+
+    /// \returns the sequence number after the last readable record.
+    uint64_t nextSequence() const;
+
+    /// \brief Find the records of an image.
+    /// \param imageId The image id.
+    /// \param callback Called for each record in sequence order.
+    void find(uint64_t imageId, const Callback& callback) const;
+
+    /// \brief Find the records of an image.
+    /// \param imageId The image id.
+    /// \returns the records in sequence order.
+    std::vector<Entry> find(uint64_t imageId) const;
+
+    /// \brief Scan the records in a time range.
+    /// \param begin The first timestamp in microseconds since the Unix epoch.
+    /// \param end The timestamp after the last, or 0 for no limit.
+    /// \param callback Called for each record in sequence order.
+    void scan(uint64_t begin, uint64_t end, const Callback& callback) const;
+
+private:
+    struct Segment
+    {
+        std::string path;
+        uint64_t firstSequence = 0;
+
+        /// \brief The index, including entries built by scanning the tail.
+        std::vector<VisionLogFormat::IndexEntry> index;
+
+        std::unique_ptr<Poco::SharedMemory> memory;
+        std::size_t size = 0;
+    };
+
+    /// \brief Map a segment and index its unindexed tail.
+    /// \returns false if the file is not a segment.
+    bool load(Segment& segment);
+
+    /// \brief Visit the records of a block.
+    /// \returns false if the callback stopped the visit.
+    bool visit(const Segment& segment,
+               const VisionLogFormat::IndexEntry& entry,
+               const Callback& visitor) const;
+
+    /// \brief Read the record at an offset.
+    /// \returns false if there is no valid record at the offset.
+    static bool read(const Segment& segment, uint64_t offset, Entry& entry, std::size_t& size);
+
+    std::string _path;
+
+    std::vector<Segment> _segments;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
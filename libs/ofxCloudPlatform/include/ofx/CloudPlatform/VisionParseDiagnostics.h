@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include "ofJson.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Counters for unrecognized fields met while decoding responses.
+///
+/// Decoders report unknown keys and unknown enum values here instead of
+/// logging the enclosing json. Each distinct type and name is counted and,
+/// by default, logged once at warning level.
+///
+/// Raw snippets of unknown values can optionally be sampled at a limited
+/// rate, so new API fields can be inspected without serializing json on
+/// every response.
+///
+/// Usage:
+///
+///     ofxGCP::VisionParseDiagnostics::Settings settings;
+///     settings.samplesPerSecond = 1;
+///     ofxGCP::VisionParseDiagnostics::setSettings(settings);
+///
+///     ...
+///
+///     for (const auto& counter: ofxGCP::VisionParseDiagnostics::counters())
+///         ofLogNotice() << counter.type << "." << counter.name << ": " << counter.count;
+///
+/// All functions are thread safe. Counting a field that was seen before
+/// only takes a shared lock and does not allocate, so a new API field that
+/// appears in every face or symbol stays cheap.
+class VisionParseDiagnostics
+{
+public:
+    enum
+    {
+        /// \brief The default number of samples to keep.
+        DEFAULT_MAX_SAMPLES = 32,
+
+        /// \brief The default maximum snippet size in bytes.
+        DEFAULT_MAX_SNIPPET_SIZE = 256
+    };
+
+    /// \brief The kind of unrecognized field.
+    enum class Kind: uint8_t
+    {
+        /// \brief An unrecognized object key.
+        UNKNOWN_KEY,
+
+        /// \brief An unrecognized enum value.
+        UNKNOWN_VALUE
+    };
+
+    /// \brief Diagnostics settings.
+    struct Settings
+    {
+        /// \brief Log the first occurrence of each type and name.
+        bool logFirstOccurrence = true;
+
+        /// \brief The maximum sampling rate, or 0 to disable sampling.
+        double samplesPerSecond = 0;
+
+        /// \brief The number of most recent samples to keep.
+        std::size_t maxSamples = DEFAULT_MAX_SAMPLES;
+
+        /// \brief Snippets longer than this are truncated.
+        std::size_t maxSnippetSize = DEFAULT_MAX_SNIPPET_SIZE;
+    };
+
+    /// \brief The count of one unrecognized field.
+    struct Counter
+    {
+        Kind kind = Kind::UNKNOWN_KEY;
+
+        /// \brief The decoded type, e.g. "FaceAnnotation".
+        std::string type;
+
+        /// \brief The unknown key or enum value.
+        std::string name;
+
+        uint64_t count = 0;
+    };
+
+    /// \brief A sampled unrecognized field.
+    struct Sample
+    {
+        Kind kind = Kind::UNKNOWN_KEY;
+        std::string type;
+        std::string name;
+
+        /// \brief The raw value, truncated to maxSnippetSize.
+        std::string snippet;
+
+        /// \brief The time of the sample in microseconds.
+        uint64_t timestamp = 0;
+    };
+
+    /// \brief Set the diagnostics settings.
+    /// \param settings The settings to use.
+    static void setSettings(const Settings& settings);
+
+    /// \returns the diagnostics settings.
+    static Settings getSettings();
+
+    /// \brief Report an unknown key.
+    /// \param type The decoded type.
+    /// \param key The unknown key.
+    /// \param value The value of the unknown key, serialized only if sampled.
+    static void unknownKey(const char* type,
+                           const std::string& key,
+                           const ofJson& value);
+
+    /// \brief Report an unknown enum value.
+    /// \param type The enum type.
+    /// \param value The unknown value.
+    static void unknownValue(const char* type, const std::string& value);
+
+    /// \returns the total number of unknown keys reported.
+    static uint64_t unknownKeys();
+
+    /// \returns the total number of unknown enum values reported.
+    static uint64_t unknownValues();
+
+    /// \returns a counter for each distinct unrecognized field.
+    static std::vector<Counter> counters();
+
+    /// \returns the most recent samples, oldest first.
+    static std::vector<Sample> samples();
+
+    /// \brief Clear all counters and samples.
+    static void reset();
+
+    /// \returns the name of a kind.
+    static std::string toString(Kind kind);
+
+private:
+    VisionParseDiagnostics() = delete;
+    ~VisionParseDiagnostics() = delete;
+
+    /// \brief Count a report and decide whether to sample it.
+    /// \param timestamp The sample time to fill if sampled.
+    /// \returns true if the report should be sampled.
+    static bool record(Kind kind,
+                       const char* type,
+                       const std::string& name,
+                       uint64_t& timestamp);
+
+    /// \brief Add a sample.
+    static void addSample(Kind kind,
+                          const char* type,
+                          const std::string& name,
+                          std::string snippet,
+                          uint64_t timestamp);
+
+};
+
+
+} } // namespace ofx::CloudPlatform
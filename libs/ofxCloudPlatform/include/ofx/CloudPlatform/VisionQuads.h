@@ -0,0 +1,144 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofPolyline.h"
+#include "ofx/CloudPlatform/VisionTextAnnotation.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A packed array of quadrilaterals with batch geometry kernels.
+///
+/// Vision bounding polys are quads. Rather than an ofPolyline each, the
+/// vertices are stored as eight float columns, x and y of each corner, so
+/// the kernels process four quads per SSE2 instruction. Kernels write to
+/// caller-owned output arrays of size() elements and never allocate.
+///
+/// Quads are expected to be convex, which Vision boxes are. Areas and
+/// intersections of axis-aligned quads are computed from their bounds in
+/// SIMD; only overlapping rotated quads fall back to exact clipping.
+///
+/// Usage:
+///
+///     VisionQuads quads;
+///
+///     for (const auto& face: response.faceAnnotations())
+///         quads.add(face.boundingPoly());
+///
+///     std::vector<float> iou(quads.size());
+///     quads.iou(previousFace, iou.data());
+class VisionQuads
+{
+public:
+    /// \brief A quad's vertices, in order, the same as a text bounding box.
+    typedef TextAnnotation::BoundingBox Quad;
+
+    /// \brief Create an empty VisionQuads.
+    VisionQuads();
+
+    /// \brief Destroy the VisionQuads.
+    ~VisionQuads();
+
+    VisionQuads(const VisionQuads&) = default;
+    VisionQuads(VisionQuads&&) = default;
+    VisionQuads& operator = (const VisionQuads&) = default;
+    VisionQuads& operator = (VisionQuads&&) = default;
+
+    /// \brief Add a quad, such as a TextAnnotation::Word::boundingBox.
+    /// \param quad The quad.
+    /// \returns the index of the quad.
+    std::size_t add(const Quad& quad);
+
+    /// \brief Add a bounding poly.
+    ///
+    /// Only the first four vertices are used. A poly with fewer vertices
+    /// repeats its last vertex, and an empty poly is a quad at the origin.
+    ///
+    /// \param polyline The bounding poly.
+    /// \returns the index of the quad.
+    std::size_t add(const ofPolyline& polyline);
+
+    /// \brief Reserve space for quads.
+    void reserve(std::size_t size);
+
+    /// \brief Remove all quads.
+    void clear();
+
+    /// \returns the number of quads.
+    std::size_t size() const;
+
+    /// \returns a quad.
+    Quad quad(std::size_t index) const;
+
+    /// \returns the x coordinates of a corner of all quads.
+    const float* x(std::size_t corner) const;
+
+    /// \returns the y coordinates of a corner of all quads.
+    const float* y(std::size_t corner) const;
+
+    /// \brief Compute the area of every quad.
+    /// \param areas The output array.
+    void areas(float* areas) const;
+
+    /// \brief Compute the centroid of every quad.
+    ///
+    /// Degenerate quads use the mean of their vertices.
+    ///
+    /// \param x The output array of x coordinates.
+    /// \param y The output array of y coordinates.
+    void centroids(float* x, float* y) const;
+
+    /// \brief Compute the axis-aligned bounds of every quad.
+    /// \param min The output array of minimum corners.
+    /// \param max The output array of maximum corners.
+    void bounds(glm::vec2* min, glm::vec2* max) const;
+
+    /// \brief Test which quads contain a point.
+    /// \param point The point.
+    /// \param contains The output array, 1 if inside, otherwise 0.
+    void contains(const glm::vec2& point, uint8_t* contains) const;
+
+    /// \brief Compute the area of intersection of every quad with a quad.
+    /// \param quad The quad.
+    /// \param areas The output array.
+    void intersectionAreas(const Quad& quad, float* areas) const;
+
+    /// \brief Compute the intersection over union of every quad with a quad.
+    /// \param quad The quad.
+    /// \param iou The output array, 0 for disjoint or empty quads.
+    void iou(const Quad& quad, float* iou) const;
+
+    /// \brief Compute the fraction of every quad covered by a quad.
+    /// \param quad The quad.
+    /// \param containment The output array, 1 if fully covered.
+    void containment(const Quad& quad, float* containment) const;
+
+    /// \returns the area of a quad.
+    static float area(const Quad& quad);
+
+    /// \returns the centroid of a quad.
+    static glm::vec2 centroid(const Quad& quad);
+
+    /// \returns the area of the intersection of two convex quads.
+    static float intersectionArea(const Quad& a, const Quad& b);
+
+    /// \returns true if a quad is axis-aligned.
+    static bool isAxisAligned(const Quad& quad);
+
+private:
+    std::array<std::vector<float>, 4> _x;
+    std::array<std::vector<float>, 4> _y;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -17,6 +17,13 @@ namespace CloudPlatform {
 
 
 /// \brief A Google Cloud Platform Vision request.
+///
+/// Request items are held by value and share their image content, so the
+/// same item may be added to any number of requests. Image content is base64
+/// encoded directly into the request body when it is written.
+///
+/// The inherited JSON holds the request items without their image content,
+/// so it can be logged or inspected without encoding any images.
 class VisionRequest: public HTTP::JSONRequest
 {
 public:
@@ -31,6 +38,10 @@ public:
     /// \param requestItems The request items to add.
     VisionRequest(const std::vector<VisionRequestItem>& requestItems);
 
+    /// \brief Creates a Vision request the given RequestItem.
+    /// \param requestItems The request items to take ownership of.
+    VisionRequest(std::vector<VisionRequestItem>&& requestItems);
+
     /// \brief Destroy the VisionRequest.
     virtual ~VisionRequest();
 
@@ -38,10 +49,17 @@ public:
     /// \param requestItem The request item to add.
     void addRequestItem(const VisionRequestItem& requestItem);
 
+    /// \brief Add a request item.
+    /// \param requestItem The request item to take ownership of.
+    void addRequestItem(VisionRequestItem&& requestItem);
+
     /// \brief Add a request items.
     /// \param requestItems The request items to add.
     void addRequestItems(const std::vector<VisionRequestItem>& requestItems);
 
+    /// \returns the request items.
+    const std::vector<VisionRequestItem>& requestItems() const;
+
     /// \brief The default request URI.
     static const std::string DEFAULT_VISION_REQUEST_URI;
 
@@ -49,6 +67,27 @@ protected:
     /// \brief We hide this method for data integreity.
     void setJSON(const ofJson& json) override;
 
+    void prepareRequest() override;
+
+    void writeRequestBody(std::ostream& requestStream) override;
+
+private:
+    /// \brief A piece of the serialized request body.
+    struct BodyPart
+    {
+        /// \brief Serialized JSON text.
+        std::string text;
+
+        /// \brief Image content to base64 encode after the text, if any.
+        std::shared_ptr<const VisionImageContent> content;
+    };
+
+    /// \brief The request items.
+    std::vector<VisionRequestItem> _requestItems;
+
+    /// \brief The body parts created by prepareRequest().
+    std::vector<BodyPart> _bodyParts;
+
 };
 
 
@@ -10,15 +10,28 @@
 
 #include "ofJson.h"
 #include "ofImage.h"
+#include "ofRectangle.h"
+#include "ofx/CloudPlatform/VisionImageContent.h"
+#include "ofx/CloudPlatform/VisionImageEncoder.h"
 
 
 namespace ofx {
 namespace CloudPlatform {
 
 
+class VisionRequestTemplate;
+
+
 /// \brief A class representing a single request item.
 ///
 /// Vision requests can consist of multiple individual requests items.
+///
+/// Image content is held by a shared immutable VisionImageContent, so copying
+/// a request item, or adding it to several requests, never copies the image.
+///
+/// A request item may send only a region of interest of a larger image. The
+/// region's position is kept with the item and VisionClient maps returned
+/// coordinates back into the full image.
 class VisionRequestItem
 {
 public:
@@ -80,18 +93,61 @@ public:
         /// \brief Create a Feature with parameters.
         /// \param type The feature type to create.
         /// \param maxResults The maximum results to request.
-        Feature(Type type = Type::IMAGE_PROPERTIES,
-                std::size_t maxResults = DEFAULT_MAX_RESULTS);
+        constexpr Feature(Type type = Type::IMAGE_PROPERTIES,
+                          std::size_t maxResults = DEFAULT_MAX_RESULTS):
+            _type(type),
+            _maxResults(maxResults)
+        {
+        }
+
+        /// \returns the feature type.
+        constexpr Type type() const
+        {
+            return _type;
+        }
+
+        /// \returns the maximum results to request.
+        constexpr std::size_t maxResults() const
+        {
+            return _maxResults;
+        }
 
         /// \returns the JSON representation.
-        const ofJson& json() const;
+        ofJson json() const;
+
+        /// \brief Get the API name of a feature type.
+        /// \param type The feature type.
+        /// \returns the name, e.g. "LABEL_DETECTION".
+        static constexpr const char* toString(Type type)
+        {
+            return TYPE_NAMES[static_cast<std::size_t>(type)];
+        }
+
+        /// \brief The API names of the feature types, in Type order.
+        static constexpr const char* TYPE_NAMES[] =
+        {
+            "TYPE_UNSPECIFIED",
+            "FACE_DETECTION",
+            "LANDMARK_DETECTION",
+            "LOGO_DETECTION",
+            "LABEL_DETECTION",
+            "TEXT_DETECTION",
+            "DOCUMENT_TEXT_DETECTION",
+            "SAFE_SEARCH_DETECTION",
+            "IMAGE_PROPERTIES",
+            "CROP_HINTS",
+            "WEB_DETECTION"
+        };
 
         /// \brief A list of all the feature types and their strings for convenience.
         static const std::map<Type, std::string> TYPE_STRINGS;
 
     private:
-        /// \brief The internal JSON.
-        ofJson _json;
+        /// \brief The feature type.
+        Type _type;
+
+        /// \brief The maximum results to request.
+        std::size_t _maxResults;
 
     };
 
@@ -102,7 +158,7 @@ public:
     /// \param pixels The pixels to set (encodes pixels with defaults).
     /// \param features The feature map to request.
     VisionRequestItem(const ofPixels& pixels,
-                      const std::vector<Feature>& features = DEFAULT_FEATURES);
+                      const std::vector<Feature>& features = defaultFeatures());
 
     /// \brief Construct a request with parameters.
     /// \param pixels The pixels to set.
@@ -112,19 +168,53 @@ public:
     VisionRequestItem(const ofPixels& pixels,
                       ofImageFormat format,
                       ofImageQualityType quality,
-                      const std::vector<Feature>& features = DEFAULT_FEATURES);
+                      const std::vector<Feature>& features = defaultFeatures());
+
+    /// \brief Construct a request for a region of interest.
+    /// \param pixels The full image pixels.
+    /// \param region The region of interest in image coordinates.
+    /// \param padding The margin in pixels to add around the region.
+    /// \param features The feature map to request.
+    VisionRequestItem(const ofPixels& pixels,
+                      const ofRectangle& region,
+                      float padding = 0,
+                      const std::vector<Feature>& features = defaultFeatures());
 
     /// \brief Construct a request with parameters.
     /// \param uri Can be file path or a Google Storage URI (e.g. gs://...).
     /// \param features The feature map to request.
     VisionRequestItem(const std::string& uri,
-                      const std::vector<Feature>& features = DEFAULT_FEATURES);
+                      const std::vector<Feature>& features = defaultFeatures());
 
     /// \brief Construct a request with parameters.
     /// \param buffer The buffered encoded image data.
     /// \param features The feature map to request.
     VisionRequestItem(const ofBuffer& buffer,
-                      const std::vector<Feature>& features = DEFAULT_FEATURES);
+                      const std::vector<Feature>& features = defaultFeatures());
+
+    /// \brief Construct a request with parameters.
+    /// \param buffer The buffered encoded image data to take ownership of.
+    /// \param features The feature map to request.
+    VisionRequestItem(ofBuffer&& buffer,
+                      const std::vector<Feature>& features = defaultFeatures());
+
+    /// \brief Construct a request with parameters.
+    /// \param content The shared image content.
+    /// \param features The feature map to request.
+    VisionRequestItem(std::shared_ptr<const VisionImageContent> content,
+                      const std::vector<Feature>& features = defaultFeatures());
+
+    /// \brief Construct a request with shared parameters.
+    /// \param pixels The pixels to set (encodes pixels with defaults).
+    /// \param requestTemplate The shared parameters.
+    VisionRequestItem(const ofPixels& pixels,
+                      std::shared_ptr<const VisionRequestTemplate> requestTemplate);
+
+    /// \brief Construct a request with shared parameters.
+    /// \param content The shared image content.
+    /// \param requestTemplate The shared parameters.
+    VisionRequestItem(std::shared_ptr<const VisionImageContent> content,
+                      std::shared_ptr<const VisionRequestTemplate> requestTemplate);
 
     /// \brief Destroy the VisionRequestItem.
     ~VisionRequestItem();
@@ -141,7 +231,45 @@ public:
                   ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
                   ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
 
+    /// \brief Set the image from a region of interest.
+    ///
+    /// The padded region is clipped to the image, cropped and encoded. Only
+    /// the cropped pixels are sent.
+    ///
+    /// \param pixels The full image pixels.
+    /// \param region The region of interest in image coordinates.
+    /// \param padding The margin in pixels to add around the region.
+    /// \param format The image format to encode.
+    /// \param quality The compression quality.
+    void setImage(const ofPixels& pixels,
+                  const ofRectangle& region,
+                  float padding = 0,
+                  ofImageFormat format = OF_IMAGE_FORMAT_JPEG,
+                  ofImageQualityType quality = OF_IMAGE_QUALITY_MEDIUM);
+
+    /// \brief Set the image from pixels, encoded as a JPEG within a byte budget.
+    ///
+    /// This uses a shared per-thread encoder. The result of the encoding is
+    /// available from encodingResult().
+    ///
+    /// \param pixels The image pixels to send.
+    /// \param settings The byte budget settings.
+    void setImage(const ofPixels& pixels,
+                  const VisionImageEncoder::Settings& settings);
+
+    /// \brief Set the image from pixels, encoded as a JPEG within a byte budget.
+    /// \param pixels The image pixels to send.
+    /// \param settings The byte budget settings.
+    /// \param encoder The encoder to use.
+    void setImage(const ofPixels& pixels,
+                  const VisionImageEncoder::Settings& settings,
+                  VisionImageEncoder& encoder);
+
     /// \brief Set the image from an image file.
+    ///
+    /// Local files are memory mapped rather than read, and are streamed
+    /// through the base64 encoder when the request is written.
+    ///
     /// \param uri Can be file path or a Google Storage URI (e.g. gs://...).
     void setImage(const std::string& uri);
 
@@ -149,6 +277,30 @@ public:
     /// \param buffer The buffered encoded image data.
     void setImage(const ofBuffer& buffer);
 
+    /// \brief Set the image from buffer, taking ownership of its data.
+    /// \param buffer The buffered encoded image data.
+    void setImage(ofBuffer&& buffer);
+
+    /// \brief Set the image from shared content.
+    ///
+    /// The content is shared, not copied, so it may be used by any number of
+    /// request items.
+    ///
+    /// \param content The shared image content.
+    void setImage(std::shared_ptr<const VisionImageContent> content);
+
+    /// \brief Use shared, pre-serialized parameters.
+    ///
+    /// This replaces the features and image context of this request item.
+    /// Changing them afterwards copies the template's parameters into this
+    /// request item and releases the template.
+    ///
+    /// \param requestTemplate The shared parameters, or nullptr to remove.
+    void setTemplate(std::shared_ptr<const VisionRequestTemplate> requestTemplate);
+
+    /// \returns the shared parameters or nullptr if there are none.
+    std::shared_ptr<const VisionRequestTemplate> requestTemplate() const;
+
     /// \brief Add a feature to this request.
     /// \param feature The feature to request.
     void addFeature(const Feature& feature);
@@ -188,16 +340,82 @@ public:
     /// \sa https://cloud.google.com/translate/v2/using_rest#language-params
     void addLanguageHint(const std::string& language);
 
+    /// \brief Get the complete JSON representation.
+    ///
+    /// This includes a base64 copy of any image content, encoded on every
+    /// call. VisionRequest writes content directly to the request body
+    /// instead. To inspect an item without encoding, use parameters() and
+    /// content().
+    ///
     /// \returns the JSON representation.
-    const ofJson& json() const;
+    ofJson json() const;
+
+    /// \returns the JSON representation, excluding image content and any
+    ///          template parameters.
+    const ofJson& parameters() const;
+
+    /// \returns the shared image content or nullptr if there is none.
+    std::shared_ptr<const VisionImageContent> content() const;
+
+    /// \brief Get the result of the last byte budget encoding.
+    ///
+    /// The result is reset when the image is set by other means.
+    ///
+    /// \returns the encoding result.
+    const VisionImageEncoder::Result& encodingResult() const;
+
+    /// \brief Get the region of the source image that is sent.
+    ///
+    /// The region is empty unless the image was set from a region of
+    /// interest. Returned coordinates are offset by the region's position.
+    ///
+    /// \returns the region in source image coordinates.
+    const ofRectangle& region() const;
+
+    /// \brief Create one request item for each region of interest.
+    ///
+    /// The items can be sent together with VisionClient::annotate().
+    ///
+    /// \param pixels The full image pixels.
+    /// \param regions The regions of interest in image coordinates.
+    /// \param padding The margin in pixels to add around each region.
+    /// \param features The feature map to request.
+    /// \returns the request items.
+    static std::vector<VisionRequestItem> fromRegions(const ofPixels& pixels,
+                                                      const std::vector<ofRectangle>& regions,
+                                                      float padding = 0,
+                                                      const std::vector<Feature>& features = defaultFeatures());
+
+    /// \brief Get the default features.
+    ///
+    /// \returns the default features.
+    static const std::vector<Feature>& defaultFeatures();
 
     /// \brief The defaut features.
+    ///
+    /// Prefer defaultFeatures(), as this may not be initialized yet when used
+    /// during static initialization.
     static const std::vector<Feature> DEFAULT_FEATURES;
 
 private:
-    /// \brief The json data.
+    /// \brief Copy the template parameters into _json and release the template.
+    void detachTemplate();
+
+    /// \brief The json data, excluding image content.
     ofJson _json;
 
+    /// \brief The shared parameters.
+    std::shared_ptr<const VisionRequestTemplate> _template;
+
+    /// \brief The shared image content.
+    std::shared_ptr<const VisionImageContent> _content;
+
+    /// \brief The result of the last byte budget encoding.
+    VisionImageEncoder::Result _encodingResult;
+
+    /// \brief The region of the source image that is sent.
+    ofRectangle _region;
+
 };
 
 
@@ -0,0 +1,99 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/CloudPlatform/VisionRequestItem.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Request item parameters that are shared by many request items.
+///
+/// The features and image context are serialized once when they are set.
+/// Request items that share a template only contribute their image, so
+/// per-frame requests do not rebuild or serialize their parameters.
+///
+/// Usage:
+///
+///     auto requestTemplate = std::make_shared<ofxGCP::VisionRequestTemplate>(features);
+///
+///     // Per frame.
+///     client.annotate(ofxGCP::VisionRequestItem(pixels, requestTemplate));
+///
+/// A template should not be modified once it is shared.
+class VisionRequestTemplate
+{
+public:
+    /// \brief Create a VisionRequestTemplate.
+    /// \param features The features to request.
+    VisionRequestTemplate(const std::vector<VisionRequestItem::Feature>& features = VisionRequestItem::defaultFeatures());
+
+    /// \brief Destroy the VisionRequestTemplate.
+    ~VisionRequestTemplate();
+
+    /// \brief Add a feature.
+    /// \param feature The feature to request.
+    void addFeature(const VisionRequestItem::Feature& feature);
+
+    /// \brief Set the features.
+    /// \param features The features to request.
+    void setFeatures(const std::vector<VisionRequestItem::Feature>& features);
+
+    /// \brief Set the coordinate bounds context.
+    /// \param minLatitude The minimum latitude in normalized degrees.
+    /// \param minLongitude The minimum longitude in normalized degrees.
+    /// \param maxLatitude The maximum latitude in normalized degrees.
+    /// \param maxLongitude The maximum longitude in normalized degrees.
+    /// \sa VisionRequestItem::setLatitudeLongitudeBounds()
+    void setLatitudeLongitudeBounds(double minLatitude,
+                                    double minLongitude,
+                                    double maxLatitude,
+                                    double maxLongitude);
+
+    /// \brief Set the ISO639-1 language hints for TEXT_DETECTION.
+    /// \param languages The ISO639-1 language codes.
+    void setLanguageHints(const std::vector<std::string>& languages);
+
+    /// \brief Add an ISO639-1 language hint for TEXT_DETECTION.
+    /// \param language The ISO639-1 language code.
+    void addLanguageHint(const std::string& language);
+
+    /// \returns the JSON representation.
+    const ofJson& json() const;
+
+    /// \brief Get the serialized parameters.
+    ///
+    /// These are the members of the JSON object, without the enclosing
+    /// braces, e.g. "features":[...],"imageContext":{...}.
+    ///
+    /// \returns the serialized parameters.
+    const std::string& fragment() const;
+
+    /// \returns a hash of the serialized parameters.
+    uint64_t hash() const;
+
+private:
+    /// \brief Serialize the parameters.
+    void render();
+
+    /// \brief The JSON representation.
+    ofJson _json;
+
+    /// \brief The serialized parameters.
+    std::string _fragment;
+
+    /// \brief The hash of the serialized parameters.
+    uint64_t _hash = 0;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
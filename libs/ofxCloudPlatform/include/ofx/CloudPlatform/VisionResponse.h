@@ -8,20 +8,38 @@
 #pragma once
 
 
+#include <atomic>
+#include <mutex>
 #include "ofx/CloudPlatform/VisionAnnotations.h"
 #include "ofx/CloudPlatform/VisionRequest.h"
+#include "ofx/CloudPlatform/VisionTextAnnotation.h"
+#include "ofx/CloudPlatform/VisionWebDetection.h"
 
 
 namespace ofx {
 namespace CloudPlatform {
 
 
+/// \brief The response to a single request item.
+///
+/// Responses are decoded eagerly by fromJSON(). A lazy response created with
+/// fromJSONLazy() keeps a shared handle to the raw JSON and decodes each
+/// annotation type on first access. Decoding is thread safe and copies of a
+/// lazy response share their decoded annotations.
+///
+/// The raw JSON is only kept when asked for, or by lazy responses, and is
+/// shared immutably between copies.
 class AnnotateImageResponse
 {
 public:
     AnnotateImageResponse();
     ~AnnotateImageResponse();
 
+    AnnotateImageResponse(const AnnotateImageResponse&) = default;
+    AnnotateImageResponse(AnnotateImageResponse&&) = default;
+    AnnotateImageResponse& operator = (const AnnotateImageResponse&) = default;
+    AnnotateImageResponse& operator = (AnnotateImageResponse&&) = default;
+
     const std::vector<FaceAnnotation>& faceAnnotations() const;
     const std::vector<EntityAnnotation>& landmarkAnnotations() const;
     const std::vector<EntityAnnotation>& logoAnnotations() const;
@@ -31,11 +49,153 @@ public:
     const ImagePropertiesAnnotation& imagePropertiesAnnotation() const;
     const CropHintsAnnotation& cropHintsAnnotation() const;
 
+    /// \brief Get the structured text from DOCUMENT_TEXT_DETECTION.
+    ///
+    /// This is the largest section of a document response; in lazy
+    /// responses it is only decoded when first accessed.
+    ///
+    /// \returns the full text annotation.
+    const TextAnnotation& fullTextAnnotation() const;
+
+    /// \returns the web detection from WEB_DETECTION.
+    const WebDetection& webDetection() const;
+
+    /// \returns true if the response is a per-image error.
+    bool hasError() const;
+
+    /// \returns the google.rpc.Code of a per-image error, or 0.
+    int errorCode() const;
+
+    /// \returns the message of a per-image error, or an empty string.
+    const std::string& errorMessage() const;
+
+    /// \brief Get the raw json.
+    ///
+    /// The raw json is only kept if it was retained when the response was
+    /// created, otherwise this is null.
+    ///
     /// \returns the raw json.
-    ofJson json() const;
+    const ofJson& json() const;
+
+    /// \returns true if the raw json was retained.
+    bool hasJSON() const;
+
+    /// \brief Estimate the memory used by this response.
+    ///
+    /// This includes decoded annotations and any retained raw json, even if
+    /// the raw json is shared with other responses.
+    ///
+    /// \returns the estimated size in bytes.
+    std::size_t memoryFootprint() const;
+
+    /// \brief Create an instance from JSON.
+    /// \param json The JSON to use.
+    /// \param retainJSON True to keep a copy of the raw json.
+    /// \returns an instance of the object.
+    static AnnotateImageResponse fromJSON(const ofJson& json,
+                                          bool retainJSON = false);
+
+    /// \brief Create a lazily decoded instance from JSON.
+    ///
+    /// Only the top level keys are read. Annotations are decoded when first
+    /// accessed. The raw json is always retained.
+    ///
+    /// \param json The shared JSON to use.
+    /// \returns an instance of the object.
+    static AnnotateImageResponse fromJSONLazy(std::shared_ptr<const ofJson> json);
+
+    /// \returns true if annotations are decoded on first access.
+    bool isLazy() const;
+
+    /// \brief Create an instance from JSON for an image region.
+    ///
+    /// All returned coordinates are offset into full image coordinates,
+    /// including those in the raw json.
+    ///
+    /// \param json The JSON to use.
+    /// \param offset The position of the region in the full image.
+    /// \param retainJSON True to keep a copy of the raw json.
+    /// \returns an instance of the object.
+    static AnnotateImageResponse fromJSON(const ofJson& json,
+                                          const glm::vec2& offset,
+                                          bool retainJSON = false);
+
+    /// \brief Offset all pixel coordinates in a response.
+    ///
+    /// Every vertex of every bounding polygon and every landmark position is
+    /// translated. Normalized vertices are left unchanged.
+    ///
+    /// \param json The response JSON to modify.
+    /// \param offset The offset to add.
+    static void translate(ofJson& json, const glm::vec2& offset);
 
-    static AnnotateImageResponse fromJSON(const ofJson& json);
 private:
+    friend class VisionSnapshot;
+
+    /// \brief An annotation type that is decoded on first access.
+    template <typename T>
+    struct LazySection
+    {
+        /// \brief The raw section, or nullptr if it is not present.
+        const ofJson* json = nullptr;
+
+        /// \brief Guards decoding.
+        std::once_flag flag;
+
+        /// \brief True once the value has been decoded.
+        std::atomic<bool> decoded { false };
+
+        /// \brief The decoded value.
+        T value;
+    };
+
+    /// \brief The state shared by copies of a lazy response.
+    ///
+    /// Sections point into the retained raw json.
+    struct LazyState
+    {
+        LazySection<std::vector<FaceAnnotation>> faceAnnotations;
+        LazySection<std::vector<EntityAnnotation>> landmarkAnnotations;
+        LazySection<std::vector<EntityAnnotation>> logoAnnotations;
+        LazySection<std::vector<EntityAnnotation>> labelAnnotations;
+        LazySection<std::vector<EntityAnnotation>> textAnnotations;
+        LazySection<SafeSearchAnnotation> safeSearchAnnotation;
+        LazySection<ImagePropertiesAnnotation> imagePropertiesAnnotation;
+        LazySection<CropHintsAnnotation> cropHintsAnnotation;
+        LazySection<TextAnnotation> fullTextAnnotation;
+        LazySection<WebDetection> webDetection;
+    };
+
+    /// \brief Decode a list section on first access.
+    template <typename T>
+    static const std::vector<T>& decode(LazySection<std::vector<T>>& section);
+
+    /// \brief Decode an object section on first access.
+    template <typename T>
+    static const T& decode(LazySection<T>& section);
+
+    /// \brief Estimate the memory used by a list section if it was decoded.
+    template <typename T>
+    static std::size_t memoryFootprint(const LazySection<std::vector<T>>& section);
+
+    /// \brief Estimate the memory used by a section if it was decoded.
+    static std::size_t memoryFootprint(const LazySection<ImagePropertiesAnnotation>& section);
+
+    /// \brief Estimate the memory used by a section if it was decoded.
+    static std::size_t memoryFootprint(const LazySection<CropHintsAnnotation>& section);
+
+    /// \brief Estimate the memory used by a section if it was decoded.
+    static std::size_t memoryFootprint(const LazySection<TextAnnotation>& section);
+
+    /// \brief Estimate the memory used by a section if it was decoded.
+    static std::size_t memoryFootprint(const LazySection<WebDetection>& section);
+
+    /// \brief Decode a per-image error.
+    void setError(const ofJson& json);
+
+    /// \brief The lazy state, or nullptr if the response was decoded eagerly.
+    std::shared_ptr<LazyState> _lazy;
+
     std::vector<FaceAnnotation> _faceAnnotations;
     std::vector<EntityAnnotation> _landmarkAnnotations;
     std::vector<EntityAnnotation> _logoAnnotations;
@@ -44,9 +204,20 @@ private:
     SafeSearchAnnotation _safeSearchAnnotation;
     ImagePropertiesAnnotation _imagePropertiesAnnotation;
     CropHintsAnnotation _cropHintsAnnotation;
+    TextAnnotation _fullTextAnnotation;
+    WebDetection _webDetection;
+
+    /// \brief True if the response is a per-image error.
+    bool _hasError = false;
+
+    /// \brief The google.rpc.Code of a per-image error.
+    int _errorCode = 0;
+
+    /// \brief The message of a per-image error.
+    std::string _errorMessage;
 
-    /// \brief The raw json.
-    ofJson _json;
+    /// \brief The shared raw json, or nullptr if it was not retained.
+    std::shared_ptr<const ofJson> _json;
 };
 
 
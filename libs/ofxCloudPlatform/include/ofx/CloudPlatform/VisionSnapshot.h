@@ -0,0 +1,518 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <fstream>
+#include "Poco/SharedMemory.h"
+#include "ofx/CloudPlatform/VisionResponse.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A compact, versioned binary snapshot of annotation responses.
+///
+/// A snapshot file is a header, a sequence of response records, a record
+/// index and a sorted key table. Each record is self-contained and is laid
+/// out as packed arrays: polylines are arrays of float vertices, enums are
+/// single bytes and strings are ids into a per-record string table.
+///
+/// Records are stored in native byte order with every array aligned to 8
+/// bytes, so a VisionSnapshot maps the file read-only and its Record views
+/// point directly into the mapping. Opening a snapshot only checks the header
+/// and index; a record is only touched when it is accessed, and only decoded
+/// into an AnnotateImageResponse when asked.
+///
+/// Accessing a record checks its section table, so views and strings never
+/// read past it. The values in a view, such as enum bytes and ranges, are
+/// returned as stored; Record::response() checks them all before decoding.
+///
+/// Usage:
+///
+///     VisionSnapshotWriter writer("responses.snapshot");
+///     writer.write(response, VisionCache::key(item));
+///     writer.close();
+///
+///     VisionSnapshot snapshot("responses.snapshot");
+///
+///     for (std::size_t i = 0; i < snapshot.size(); ++i)
+///     {
+///         auto record = snapshot.record(i);
+///
+///         for (const auto& face: record.faces())
+///         {
+///             std::cout << Likelihood::toString(face.joy) << std::endl;
+///         }
+///     }
+class VisionSnapshot
+{
+public:
+    enum
+    {
+        /// \brief The current format version.
+        VERSION = 1
+    };
+
+    /// \brief The index of a string in a record's string table.
+    ///
+    /// 0 is the empty string.
+    typedef uint32_t StringId;
+
+    /// \brief A half-open range [begin, end) of indices into a record array.
+    struct Range
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    /// \brief A packed FaceAnnotation.
+    struct Face
+    {
+        /// \brief The range of vertices().
+        Range boundingPoly;
+
+        /// \brief The range of vertices().
+        Range fdBoundingPoly;
+
+        /// \brief The range of landmarks().
+        Range landmarks;
+
+        float rollAngle = 0;
+        float panAngle = 0;
+        float tiltAngle = 0;
+        float detectionConfidence = 0;
+        float landmarkingConfidence = 0;
+        Likelihood::Type joy = Likelihood::Type::UNKNOWN;
+        Likelihood::Type sorrow = Likelihood::Type::UNKNOWN;
+        Likelihood::Type anger = Likelihood::Type::UNKNOWN;
+        Likelihood::Type surprise = Likelihood::Type::UNKNOWN;
+        Likelihood::Type underExposed = Likelihood::Type::UNKNOWN;
+        Likelihood::Type blurred = Likelihood::Type::UNKNOWN;
+        Likelihood::Type headwear = Likelihood::Type::UNKNOWN;
+        uint8_t reserved = 0;
+    };
+
+    /// \brief A packed FaceAnnotation::Landmark.
+    struct Landmark
+    {
+        glm::vec3 position;
+        FaceAnnotation::Landmark::Type type = FaceAnnotation::Landmark::Type::UNKNOWN_LANDMARK;
+        uint8_t reserved[3] = { 0, 0, 0 };
+    };
+
+    /// \brief A packed EntityAnnotation.
+    struct Entity
+    {
+        StringId mid = 0;
+        StringId locale = 0;
+        StringId description = 0;
+        float score = 0;
+        float topicality = 0;
+
+        /// \brief The range of vertices().
+        Range boundingPoly;
+
+        /// \brief The range of locations().
+        Range locations;
+
+        /// \brief The range of properties().
+        Range properties;
+    };
+
+    /// \brief A packed entity location.
+    struct Location
+    {
+        double latitude = 0;
+        double longitude = 0;
+    };
+
+    /// \brief A packed entity property.
+    struct Property
+    {
+        StringId name = 0;
+        StringId value = 0;
+    };
+
+    /// \brief A packed ColorInfo.
+    struct Color
+    {
+        uint8_t r = 0;
+        uint8_t g = 0;
+        uint8_t b = 0;
+        uint8_t a = 0;
+        float score = 0;
+        float pixelFraction = 0;
+    };
+
+    /// \brief A packed CropHint.
+    struct CropHint
+    {
+        /// \brief The range of vertices().
+        Range boundingPoly;
+
+        float confidence = 0;
+        float importanceFraction = 0;
+    };
+
+    /// \brief A packed SafeSearchAnnotation.
+    struct SafeSearch
+    {
+        Likelihood::Type adult = Likelihood::Type::UNKNOWN;
+        Likelihood::Type spoof = Likelihood::Type::UNKNOWN;
+        Likelihood::Type medical = Likelihood::Type::UNKNOWN;
+        Likelihood::Type violence = Likelihood::Type::UNKNOWN;
+        Likelihood::Type racy = Likelihood::Type::UNKNOWN;
+    };
+
+    /// \brief The arrays of a record.
+    enum Section
+    {
+        FACES,
+        LANDMARKS,
+        VERTICES,
+        LANDMARK_ANNOTATIONS,
+        LOGO_ANNOTATIONS,
+        LABEL_ANNOTATIONS,
+        TEXT_ANNOTATIONS,
+        LOCATIONS,
+        PROPERTIES,
+        COLORS,
+        CROP_HINTS,
+        TEXT_PAGES,
+        TEXT_BLOCKS,
+        TEXT_PARAGRAPHS,
+        TEXT_WORDS,
+        TEXT_SYMBOLS,
+        TEXT_LANGUAGES,
+        TEXT_BUFFER,
+        WEB_ENTITIES,
+        WEB_FULL_MATCHING_IMAGES,
+        WEB_PARTIAL_MATCHING_IMAGES,
+        WEB_PAGES_WITH_MATCHING_IMAGES,
+        WEB_VISUALLY_SIMILAR_IMAGES,
+        WEB_BEST_GUESS_LABELS,
+        WEB_PAGE_IMAGES,
+        STRINGS,
+        STRING_DATA,
+        NUM_SECTIONS
+    };
+
+    /// \brief The location of an array within a record.
+    struct SectionEntry
+    {
+        /// \brief The offset from the start of the record in bytes.
+        uint32_t offset = 0;
+
+        /// \brief The number of elements.
+        uint32_t count = 0;
+    };
+
+    /// \brief The location of a string within the STRING_DATA section.
+    ///
+    /// Strings are null terminated; the size excludes the terminator.
+    struct StringEntry
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    /// \brief The fixed-size start of every record.
+    struct RecordHeader
+    {
+        /// \brief The record size in bytes, including this header.
+        uint32_t size = 0;
+
+        int32_t errorCode = 0;
+        StringId errorMessage = 0;
+        uint8_t hasError = 0;
+        SafeSearch safeSearch;
+        uint8_t reserved[2] = { 0, 0 };
+
+        /// \brief The range of the string table holding TextAnnotation language codes.
+        Range textLanguageCodes;
+
+        /// \brief The range of the string table holding the WebDetection string pool.
+        Range webStrings;
+
+        SectionEntry sections[NUM_SECTIONS];
+    };
+
+    /// \brief The start of a snapshot file.
+    struct FileHeader
+    {
+        char magic[8] = { 'O', 'F', 'X', 'V', 'S', 'N', 'A', 'P' };
+        uint32_t version = VERSION;
+
+        /// \brief 0x01020304 in the byte order of the writer.
+        uint32_t byteOrder = 0x01020304;
+
+        /// \brief The number of records.
+        uint64_t count = 0;
+
+        /// \brief The offset of count IndexEntry, in record order.
+        uint64_t indexOffset = 0;
+
+        /// \brief The offset of count KeyEntry, sorted by key.
+        uint64_t keysOffset = 0;
+    };
+
+    /// \brief An entry of the record index.
+    struct IndexEntry
+    {
+        uint64_t offset = 0;
+        uint64_t key = 0;
+    };
+
+    /// \brief An entry of the key table.
+    struct KeyEntry
+    {
+        uint64_t key = 0;
+        uint64_t index = 0;
+    };
+
+    /// \brief A read-only view of a contiguous array.
+    template <typename T>
+    class ArrayView
+    {
+    public:
+        ArrayView()
+        {
+        }
+
+        ArrayView(const T* data, std::size_t size): _data(data), _size(size)
+        {
+        }
+
+        const T* begin() const { return _data; }
+        const T* end() const { return _data + _size; }
+        const T* data() const { return _data; }
+        std::size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        const T& operator [] (std::size_t i) const { return _data[i]; }
+
+    private:
+        const T* _data = nullptr;
+        std::size_t _size = 0;
+
+    };
+
+    /// \brief A zero-copy view of a record.
+    ///
+    /// A Record is only valid while its VisionSnapshot is open.
+    class Record
+    {
+    public:
+        Record(const char* data);
+
+        const RecordHeader& header() const;
+
+        ArrayView<Face> faces() const;
+        ArrayView<Landmark> landmarks(const Face& face) const;
+        ArrayView<Entity> landmarkAnnotations() const;
+        ArrayView<Entity> logoAnnotations() const;
+        ArrayView<Entity> labelAnnotations() const;
+        ArrayView<Entity> textAnnotations() const;
+        ArrayView<Location> locations(const Entity& entity) const;
+        ArrayView<Property> properties(const Entity& entity) const;
+        const SafeSearch& safeSearch() const;
+        ArrayView<Color> dominantColors() const;
+        ArrayView<CropHint> cropHints() const;
+
+        ArrayView<TextAnnotation::Page> textPages() const;
+        ArrayView<TextAnnotation::Block> textBlocks() const;
+        ArrayView<TextAnnotation::Paragraph> textParagraphs() const;
+        ArrayView<TextAnnotation::Word> textWords() const;
+        ArrayView<TextAnnotation::Symbol> textSymbols() const;
+        ArrayView<TextAnnotation::DetectedLanguage> textLanguages() const;
+
+        /// \returns the shared TextAnnotation text buffer.
+        ArrayView<char> text() const;
+
+        /// \returns the BCP-47 code of a TextAnnotation::DetectedLanguage.
+        const char* textLanguageCode(uint32_t code) const;
+
+        ArrayView<WebDetection::WebEntity> webEntities() const;
+        ArrayView<WebDetection::WebImage> webFullMatchingImages() const;
+        ArrayView<WebDetection::WebImage> webPartialMatchingImages() const;
+        ArrayView<WebDetection::WebPage> webPagesWithMatchingImages() const;
+        ArrayView<WebDetection::WebImage> webVisuallySimilarImages() const;
+        ArrayView<WebDetection::WebLabel> webBestGuessLabels() const;
+        ArrayView<WebDetection::WebImage> webPageImages() const;
+
+        /// \returns a string of the WebDetection string pool.
+        const char* webString(WebDetection::StringId id) const;
+
+        /// \param polyline A range of vertices.
+        /// \returns the vertices.
+        ArrayView<glm::vec3> vertices(const Range& polyline) const;
+
+        bool hasError() const;
+        int errorCode() const;
+        const char* errorMessage() const;
+
+        /// \brief Get a string.
+        /// \param id The string id.
+        /// \returns the null terminated UTF-8 string.
+        const char* string(StringId id) const;
+
+        /// \returns the size of a string in bytes.
+        std::size_t stringSize(StringId id) const;
+
+        /// \brief Decode the record into an AnnotateImageResponse.
+        /// \returns the response.
+        /// \throws Poco::Exception if an enum or range of the record is out
+        /// of range.
+        AnnotateImageResponse response() const;
+
+    private:
+        /// \brief Check the enums and ranges copied by response().
+        /// \throws Poco::Exception if any is out of range.
+        void validate() const;
+
+        template <typename T>
+        ArrayView<T> section(Section section) const;
+
+        template <typename T>
+        ArrayView<T> section(Section section, const Range& range) const;
+
+        std::vector<EntityAnnotation> entities(Section section) const;
+        ofPolyline polyline(const Range& range) const;
+        std::string copy(StringId id) const;
+
+        const char* _data = nullptr;
+
+    };
+
+    /// \brief Create a closed VisionSnapshot.
+    VisionSnapshot();
+
+    /// \brief Open a snapshot file.
+    /// \param path The path to the snapshot file.
+    /// \throws Poco::Exception if the file cannot be mapped or is invalid.
+    VisionSnapshot(const std::string& path);
+
+    /// \brief Destroy the VisionSnapshot.
+    ~VisionSnapshot();
+
+    VisionSnapshot(VisionSnapshot&&) = default;
+    VisionSnapshot& operator = (VisionSnapshot&&) = default;
+
+    /// \brief Open a snapshot file, closing any open snapshot.
+    /// \param path The path to the snapshot file.
+    /// \throws Poco::Exception if the file cannot be mapped or is invalid.
+    void open(const std::string& path);
+
+    /// \brief Unmap the snapshot file.
+    void close();
+
+    /// \returns true if a snapshot is open.
+    bool isOpen() const;
+
+    /// \returns the number of records.
+    std::size_t size() const;
+
+    /// \brief Get a record view.
+    ///
+    /// The record's section table is validated on each call.
+    ///
+    /// \param index The record index.
+    /// \returns the record view.
+    /// \throws Poco::Exception if the index or record is invalid.
+    Record record(std::size_t index) const;
+
+    /// \brief Decode a record.
+    /// \param index The record index.
+    /// \returns the response.
+    /// \throws Poco::Exception if the index or record is invalid.
+    AnnotateImageResponse response(std::size_t index) const;
+
+    /// \param index The record index.
+    /// \returns the key the record was written with.
+    uint64_t key(std::size_t index) const;
+
+    /// \brief Find a record by key with a binary search of the key table.
+    /// \param key The key.
+    /// \returns the record index, or size() if the key is absent.
+    std::size_t find(uint64_t key) const;
+
+    /// \returns the path of the mapped file.
+    const std::string& path() const;
+
+    /// \brief Check that a record's section table fits the record.
+    ///
+    /// Ranges and string ids within the record are checked on access.
+    ///
+    /// \param data The start of the record, aligned to 8 bytes.
+    /// \param size The number of readable bytes from data.
+    /// \returns true if the record can be viewed safely.
+    static bool isValid(const char* data, std::size_t size);
+
+    /// \brief Encode a response as a record.
+    /// \param response The response to encode.
+    /// \param buffer The buffer to append the record to.
+    static void serialize(const AnnotateImageResponse& response,
+                          std::string& buffer);
+
+private:
+    std::string _path;
+
+    /// \brief The file mapping, or nullptr if closed.
+    std::unique_ptr<Poco::SharedMemory> _memory;
+
+    const char* _data = nullptr;
+    std::size_t _size = 0;
+    std::size_t _count = 0;
+    const IndexEntry* _index = nullptr;
+    const KeyEntry* _keys = nullptr;
+
+};
+
+
+/// \brief Writes a VisionSnapshot file.
+///
+/// Records are appended as they are written. The index and key table are
+/// written by close(), so a snapshot is only readable once closed.
+class VisionSnapshotWriter
+{
+public:
+    /// \brief Create a snapshot file, replacing any existing file.
+    /// \param path The path to the snapshot file.
+    /// \throws Poco::Exception if the file cannot be created.
+    VisionSnapshotWriter(const std::string& path);
+
+    /// \brief Close and destroy the VisionSnapshotWriter.
+    ~VisionSnapshotWriter();
+
+    VisionSnapshotWriter(const VisionSnapshotWriter&) = delete;
+    VisionSnapshotWriter& operator = (const VisionSnapshotWriter&) = delete;
+
+    /// \brief Append a response.
+    /// \param response The response to append.
+    /// \param key An optional key used by VisionSnapshot::find().
+    void write(const AnnotateImageResponse& response, uint64_t key = 0);
+
+    /// \brief Write the index and key table and close the file.
+    /// \throws Poco::Exception if writing fails.
+    void close();
+
+    /// \returns the number of records written.
+    std::size_t size() const;
+
+private:
+    std::string _path;
+    std::ofstream _stream;
+    std::string _buffer;
+    uint64_t _offset = 0;
+    std::vector<VisionSnapshot::IndexEntry> _index;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,240 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <limits>
+#include "ofRectangle.h"
+#include "ofx/CloudPlatform/VisionResponse.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A static spatial index of annotation geometry for hit-testing.
+///
+/// Polygons (face, entity and crop hint bounding polys and text boxes) and
+/// points (face landmarks) of one or more responses are packed into an R-tree
+/// with NODE_SIZE children per node, ordered along a Hilbert curve. Point,
+/// rectangle and k-nearest queries visit O(log n) nodes plus the matches.
+///
+/// The index is static: add() responses and build() before querying. Item
+/// ids are positions in items() and are stable until the next build().
+///
+/// Usage:
+///
+///     VisionSpatialIndex index(response);
+///
+///     std::vector<std::size_t> hits;
+///     index.contains(glm::vec2(ofGetMouseX(), ofGetMouseY()), hits);
+///
+///     for (auto id: hits)
+///     {
+///         const auto& item = index.items()[id];
+///
+///         if (item.type == VisionSpatialIndex::Type::TEXT_ANNOTATION)
+///         {
+///             std::cout << response.textAnnotations()[item.annotation].description() << std::endl;
+///         }
+///     }
+class VisionSpatialIndex
+{
+public:
+    enum
+    {
+        /// \brief The number of children of each tree node.
+        NODE_SIZE = 16
+    };
+
+    /// \brief The kinds of indexed geometry.
+    enum class Type: uint8_t
+    {
+        FACE, ///< FaceAnnotation::boundingPoly().
+        FACE_LANDMARK, ///< A FaceAnnotation::Landmark position.
+        LANDMARK_ANNOTATION, ///< EntityAnnotation::boundingPoly() of a landmark.
+        LOGO_ANNOTATION, ///< EntityAnnotation::boundingPoly() of a logo.
+        LABEL_ANNOTATION, ///< EntityAnnotation::boundingPoly() of a label.
+        TEXT_ANNOTATION, ///< EntityAnnotation::boundingPoly() of text.
+        CROP_HINT, ///< CropHint::boundingPoly().
+        TEXT_BLOCK, ///< TextAnnotation::Block::boundingBox.
+        TEXT_PARAGRAPH, ///< TextAnnotation::Paragraph::boundingBox.
+        TEXT_WORD, ///< TextAnnotation::Word::boundingBox.
+        TEXT_SYMBOL ///< TextAnnotation::Symbol::boundingBox.
+    };
+
+    /// \brief A type mask that matches every type.
+    static constexpr uint32_t ALL_TYPES = 0xFFFFFFFF;
+
+    /// \returns the type mask of a type.
+    static constexpr uint32_t mask(Type type)
+    {
+        return uint32_t(1) << static_cast<uint32_t>(type);
+    }
+
+    /// \brief An indexed polygon or point.
+    struct Item
+    {
+        Type type = Type::FACE;
+
+        /// \brief The index of the response, in the order added.
+        uint32_t response = 0;
+
+        /// \brief The index of the annotation in its response's vector, e.g.
+        /// textAnnotations() or TextAnnotation::words().
+        uint32_t annotation = 0;
+
+        /// \brief The index of the landmark for FACE_LANDMARK, otherwise 0.
+        uint32_t part = 0;
+
+        /// \brief The bounds.
+        glm::vec2 min;
+        glm::vec2 max;
+
+        /// \brief The polygon vertices in vertices(), empty for a point.
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    /// \brief A k-nearest query result.
+    struct Neighbor
+    {
+        /// \brief The item id.
+        std::size_t item = 0;
+
+        /// \brief The distance to the item, 0 if inside a polygon.
+        float distance = 0;
+    };
+
+    /// \brief Create an empty VisionSpatialIndex.
+    VisionSpatialIndex();
+
+    /// \brief Create and build an index of a response.
+    /// \param response The response to index.
+    /// \param types The mask of types to index.
+    VisionSpatialIndex(const AnnotateImageResponse& response,
+                       uint32_t types = ALL_TYPES);
+
+    /// \brief Create and build an index of responses.
+    /// \param responses The responses to index.
+    /// \param types The mask of types to index.
+    VisionSpatialIndex(const std::vector<AnnotateImageResponse>& responses,
+                       uint32_t types = ALL_TYPES);
+
+    /// \brief Destroy the VisionSpatialIndex.
+    ~VisionSpatialIndex();
+
+    VisionSpatialIndex(const VisionSpatialIndex&) = default;
+    VisionSpatialIndex(VisionSpatialIndex&&) = default;
+    VisionSpatialIndex& operator = (const VisionSpatialIndex&) = default;
+    VisionSpatialIndex& operator = (VisionSpatialIndex&&) = default;
+
+    /// \brief Add the geometry of a response. Call build() before querying.
+    /// \param response The response to add.
+    /// \param types The mask of types to add.
+    /// \returns the response index used by its items.
+    std::size_t add(const AnnotateImageResponse& response,
+                    uint32_t types = ALL_TYPES);
+
+    /// \brief Pack the added items into the tree.
+    void build();
+
+    /// \brief Remove all items.
+    void clear();
+
+    /// \returns the number of indexed items.
+    std::size_t size() const;
+
+    /// \returns the items.
+    const std::vector<Item>& items() const;
+
+    /// \returns the polygon vertices of all items.
+    const std::vector<glm::vec2>& vertices() const;
+
+    /// \brief Find the items that contain a point.
+    ///
+    /// Points, i.e. landmarks, are matched within a radius.
+    ///
+    /// \param point The point.
+    /// \param results The vector to append the item ids to.
+    /// \param types The mask of types to match.
+    /// \param radius The distance within which points are matched.
+    void contains(const glm::vec2& point,
+                  std::vector<std::size_t>& results,
+                  uint32_t types = ALL_TYPES,
+                  float radius = 5) const;
+
+    /// \brief Find the items whose bounds intersect a rectangle.
+    /// \param rectangle The rectangle.
+    /// \param results The vector to append the item ids to.
+    /// \param types The mask of types to match.
+    void intersects(const ofRectangle& rectangle,
+                    std::vector<std::size_t>& results,
+                    uint32_t types = ALL_TYPES) const;
+
+    /// \brief Find the nearest items to a point.
+    /// \param point The point.
+    /// \param count The maximum number of items to find.
+    /// \param results The vector to append the items to, nearest first.
+    /// \param types The mask of types to match.
+    /// \param maxDistance The maximum distance, or infinity for no limit.
+    void nearest(const glm::vec2& point,
+                 std::size_t count,
+                 std::vector<Neighbor>& results,
+                 uint32_t types = ALL_TYPES,
+                 float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+    /// \brief Get the distance from a point to an item.
+    /// \param id The item id.
+    /// \param point The point.
+    /// \returns the distance, 0 if the point is inside a polygon.
+    float distance(std::size_t id, const glm::vec2& point) const;
+
+private:
+    /// \brief Add a polygon item.
+    template <typename Vertices>
+    void addPolygon(Type type,
+                    uint32_t annotation,
+                    const Vertices& vertices);
+
+    /// \brief Add the bounding polys of entity annotations.
+    void addEntities(Type type,
+                     const std::vector<EntityAnnotation>& annotations);
+
+    /// \brief Add a point item.
+    void addPoint(Type type,
+                  uint32_t annotation,
+                  uint32_t part,
+                  const glm::vec2& point);
+
+    /// \returns true if a polygon item contains a point.
+    bool inside(const Item& item, const glm::vec2& point) const;
+
+    /// \brief The number of responses added.
+    uint32_t _responses = 0;
+
+    /// \brief The items, in Hilbert order after build().
+    std::vector<Item> _items;
+
+    std::vector<glm::vec2> _vertices;
+
+    /// \brief The bounds of every tree entry. The first size() entries are
+    /// the items, followed by each level of nodes up to the root.
+    std::vector<glm::vec2> _nodeMin;
+    std::vector<glm::vec2> _nodeMax;
+
+    /// \brief The first child entry of each node, indexed by entry - size().
+    std::vector<uint32_t> _nodeBegin;
+
+    /// \brief The end child entry of each node, indexed by entry - size().
+    std::vector<uint32_t> _nodeEnd;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,221 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "ofx/CloudPlatform/VisionClient.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief A rate-bounded annotation session for a live frame source.
+///
+/// Frames may be submitted at camera rate from the main thread. At most
+/// maxConcurrentRequests frames are annotated at once; while all workers are
+/// busy, a newly submitted frame replaces any frame still waiting, so workers
+/// always pick up the freshest frame.
+///
+/// Frames that barely differ from the last submitted frame are skipped, which
+/// bounds API spend on static scenes. The scene change score is the mean
+/// absolute difference between 32x32 luminance thumbnails.
+///
+/// Results are published latest-wins with their source frame timestamp; a
+/// result older than one already published is discarded.
+///
+/// Usage:
+///
+///     void ofApp::update()
+///     {
+///         grabber.update();
+///
+///         if (grabber.isFrameNew())
+///             stream.submit(grabber.getPixels(), ofGetElapsedTimeMicros());
+///
+///         ofxGCP::VisionStream::Result result;
+///
+///         if (stream.tryGetResult(result))
+///             response = result.response;
+///     }
+class VisionStream
+{
+public:
+    enum
+    {
+        /// \brief The default maximum number of concurrent requests.
+        DEFAULT_MAX_CONCURRENT_REQUESTS = 2,
+
+        /// \brief The thumbnail width and height used for scene change.
+        THUMBNAIL_SIZE = 32
+    };
+
+    /// \brief Stream settings.
+    struct Settings
+    {
+        /// \brief The credentials used by each worker's client.
+        ServiceAccountCredentials credentials;
+
+        /// \brief The maximum number of requests in flight.
+        std::size_t maxConcurrentRequests = DEFAULT_MAX_CONCURRENT_REQUESTS;
+
+        /// \brief The minimum scene change score [0, 1] to submit a frame.
+        ///
+        /// A threshold of 0 submits every frame.
+        float sceneChangeThreshold = 0.02f;
+
+        /// \brief Submit a frame at least this often in microseconds, even
+        /// without a scene change, or 0 to disable.
+        uint64_t refreshInterval = 0;
+
+        /// \brief The features to request for each frame.
+        std::vector<VisionRequestItem::Feature> features = VisionRequestItem::defaultFeatures();
+    };
+
+    /// \brief An annotated frame.
+    struct Result
+    {
+        /// \brief The source frame timestamp as given to submit().
+        uint64_t timestamp = 0;
+
+        /// \brief The source frame sequence number.
+        uint64_t frameNumber = 0;
+
+        /// \brief The response.
+        AnnotateImageResponse response;
+    };
+
+    /// \brief Stream statistics.
+    struct Statistics
+    {
+        /// \brief Frames passed to submit().
+        uint64_t framesReceived = 0;
+
+        /// \brief Frames skipped because the scene did not change.
+        uint64_t framesUnchanged = 0;
+
+        /// \brief Frames replaced by a newer frame before a worker took them.
+        uint64_t framesReplaced = 0;
+
+        /// \brief Requests sent to the API.
+        uint64_t requests = 0;
+
+        /// \brief Requests that failed.
+        uint64_t requestsFailed = 0;
+
+        /// \brief Results published.
+        uint64_t resultsPublished = 0;
+
+        /// \brief Results discarded because a newer result was published.
+        uint64_t resultsStale = 0;
+    };
+
+    /// \brief Create a VisionStream and start its workers.
+    /// \param settings The settings to use.
+    VisionStream(const Settings& settings);
+
+    /// \brief Stop the workers and destroy the VisionStream.
+    ///
+    /// Waits for requests in flight to complete.
+    ~VisionStream();
+
+    /// \brief Submit a frame.
+    /// \param pixels The frame pixels, copied if the frame is accepted.
+    /// \param timestamp The frame timestamp, e.g. in microseconds.
+    /// \returns true if the frame was queued for annotation.
+    bool submit(const ofPixels& pixels, uint64_t timestamp);
+
+    /// \brief Get the newest result, if one was published since the last call.
+    /// \param result The result to fill.
+    /// \returns true if a new result was available.
+    bool tryGetResult(Result& result);
+
+    /// \returns the stream statistics.
+    Statistics statistics() const;
+
+    /// \brief Reduce an image to a luminance thumbnail.
+    /// \param pixels The image pixels.
+    /// \param thumbnail The THUMBNAIL_SIZE x THUMBNAIL_SIZE thumbnail to fill.
+    static void thumbnail(const ofPixels& pixels, std::vector<uint8_t>& thumbnail);
+
+    /// \brief Compute the scene change score between two thumbnails.
+    ///
+    /// Uses SSE2 sum of absolute differences where available.
+    ///
+    /// \param a The first thumbnail.
+    /// \param b The second thumbnail.
+    /// \returns the mean absolute difference in the range [0, 1].
+    static float sceneChange(const std::vector<uint8_t>& a,
+                             const std::vector<uint8_t>& b);
+
+private:
+    VisionStream(const VisionStream&) = delete;
+    VisionStream& operator = (const VisionStream&) = delete;
+
+    /// \brief A frame waiting for annotation.
+    struct Frame
+    {
+        ofPixels pixels;
+        uint64_t timestamp = 0;
+        uint64_t frameNumber = 0;
+    };
+
+    /// \brief The worker loop.
+    void run();
+
+    Settings _settings;
+
+    /// \brief The shared request parameters.
+    std::shared_ptr<const VisionRequestTemplate> _template;
+
+    /// \brief The thumbnail of the last submitted frame.
+    std::vector<uint8_t> _lastThumbnail;
+
+    /// \brief The scratch thumbnail for the current frame.
+    std::vector<uint8_t> _thumbnail;
+
+    /// \brief The timestamp of the last submitted frame.
+    uint64_t _lastSubmitTimestamp = 0;
+
+    /// \brief The number of frames received.
+    uint64_t _frameNumber = 0;
+
+    /// \brief The frame waiting for a worker.
+    Frame _pending;
+
+    /// \brief True if _pending holds a frame.
+    bool _hasPending = false;
+
+    /// \brief The newest published result.
+    Result _result;
+
+    /// \brief True if _result has not been taken.
+    bool _hasResult = false;
+
+    /// \brief True if any result has been published.
+    bool _hasPublished = false;
+
+    /// \brief True when the workers should exit.
+    bool _stop = false;
+
+    Statistics _statistics;
+
+    std::vector<std::thread> _workers;
+
+    mutable std::mutex _mutex;
+
+    std::condition_variable _condition;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,243 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <array>
+#include "ofJson.h"
+#include "ofLog.h"
+#include "glm/vec2.hpp"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief The structured text detected by DOCUMENT_TEXT_DETECTION.
+///
+/// The hierarchy is TextAnnotation -> Page -> Block -> Paragraph -> Word ->
+/// Symbol. Rather than a tree of objects, each level is stored in a single
+/// flat vector owned by the TextAnnotation. Elements refer to their children,
+/// detected languages and text by index ranges, so a whole document is a
+/// handful of allocations.
+///
+/// Symbols reference a shared UTF-8 text buffer by offset. The buffer holds
+/// each symbol's text followed by the text of its detected break, so the text
+/// of any word, paragraph, block or page is a contiguous range of the buffer.
+///
+/// Usage:
+///
+///     const auto& text = response.fullTextAnnotation();
+///
+///     for (const auto& word: text.words())
+///     {
+///         std::cout << text.text(word.text) << std::endl;
+///     }
+///
+/// \sa https://cloud.google.com/vision/docs/reference/rest/v1/AnnotateImageResponse#TextAnnotation
+class TextAnnotation
+{
+public:
+    /// \brief Detected break types.
+    enum class BreakType: uint8_t
+    {
+        UNKNOWN, ///< Unknown break label type.
+        SPACE, ///< Regular space.
+        SURE_SPACE, ///< Sure space (very wide).
+        EOL_SURE_SPACE, ///< Line-wrapping break.
+        HYPHEN, ///< End-line hyphen that is not present in text.
+        LINE_BREAK ///< Line break that ends a paragraph.
+    };
+
+    /// \brief Block types.
+    enum class BlockType: uint8_t
+    {
+        UNKNOWN, ///< Unknown block type.
+        TEXT, ///< Regular text block.
+        TABLE, ///< Table block.
+        PICTURE, ///< Image block.
+        RULER, ///< Horizontal or vertical line box.
+        BARCODE ///< Barcode block.
+    };
+
+    /// \brief A half-open range [begin, end) of indices or text offsets.
+    struct Range
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    /// \brief The four vertices of a bounding box, in pixels.
+    ///
+    /// Vertices are clockwise from the top left corner of the text in its
+    /// natural orientation, so a rotated word has a rotated box.
+    typedef std::array<glm::vec2, 4> BoundingBox;
+
+    /// \brief A detected language.
+    struct DetectedLanguage
+    {
+        /// \brief The index of the BCP-47 language code in languageCodes().
+        uint32_t code = 0;
+
+        /// \brief The confidence in the range [0, 1].
+        float confidence = 0;
+    };
+
+    /// \brief A page of text.
+    struct Page
+    {
+        Range languages;
+        Range blocks;
+        Range text;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        float confidence = 0;
+    };
+
+    /// \brief A logical element on the page.
+    struct Block
+    {
+        BoundingBox boundingBox;
+        Range languages;
+        Range paragraphs;
+        Range text;
+        float confidence = 0;
+        BlockType blockType = BlockType::UNKNOWN;
+    };
+
+    /// \brief A structural unit of text representing a number of words.
+    struct Paragraph
+    {
+        BoundingBox boundingBox;
+        Range languages;
+        Range words;
+        Range text;
+        float confidence = 0;
+    };
+
+    /// \brief A word representation.
+    struct Word
+    {
+        BoundingBox boundingBox;
+        Range languages;
+        Range symbols;
+        Range text;
+        float confidence = 0;
+    };
+
+    /// \brief A single symbol representation.
+    struct Symbol
+    {
+        BoundingBox boundingBox;
+        Range languages;
+
+        /// \brief The symbol text, without its break.
+        Range text;
+
+        float confidence = 0;
+
+        /// \brief The break detected after, or before if isPrefix, the symbol.
+        BreakType breakType = BreakType::UNKNOWN;
+
+        /// \brief True if the break is before the symbol.
+        bool isPrefix = false;
+    };
+
+    /// \brief Create an empty TextAnnotation.
+    TextAnnotation();
+
+    /// \brief Destroy the TextAnnotation.
+    ~TextAnnotation();
+
+    TextAnnotation(const TextAnnotation&) = default;
+    TextAnnotation(TextAnnotation&&) = default;
+    TextAnnotation& operator = (const TextAnnotation&) = default;
+    TextAnnotation& operator = (TextAnnotation&&) = default;
+
+    /// \returns true if no text was detected.
+    bool empty() const;
+
+    /// \brief Get the shared text buffer.
+    ///
+    /// This is all detected text, rebuilt from the symbols and their breaks.
+    ///
+    /// \returns the UTF-8 text.
+    const std::string& text() const;
+
+    /// \brief Get the text of an element.
+    /// \param range The text range of the element.
+    /// \returns the UTF-8 text.
+    std::string text(const Range& range) const;
+
+    const std::vector<Page>& pages() const;
+    const std::vector<Block>& blocks() const;
+    const std::vector<Paragraph>& paragraphs() const;
+    const std::vector<Word>& words() const;
+    const std::vector<Symbol>& symbols() const;
+
+    /// \returns the detected languages of all elements.
+    const std::vector<DetectedLanguage>& languages() const;
+
+    /// \returns the distinct BCP-47 language codes.
+    const std::vector<std::string>& languageCodes() const;
+
+    /// \brief Estimate the memory used by this annotation.
+    /// \returns the estimated size in bytes.
+    std::size_t memoryFootprint() const;
+
+    /// \brief Get the API name of a break type.
+    /// \param type The break type.
+    /// \returns the name.
+    static const char* toString(BreakType type);
+
+    /// \brief Get the API name of a block type.
+    /// \param type The block type.
+    /// \returns the name.
+    static const char* toString(BlockType type);
+
+    /// \brief Create an instance from JSON.
+    /// \param json The JSON to use.
+    /// \returns an instance of the object.
+    static TextAnnotation fromJSON(const ofJson& json);
+
+private:
+    friend class VisionSnapshot;
+
+    void parsePage(const ofJson& json);
+    void parseBlock(const ofJson& json);
+    void parseParagraph(const ofJson& json);
+    void parseWord(const ofJson& json);
+    void parseSymbol(const ofJson& json);
+
+    /// \brief Decode a TextProperty.
+    /// \param json The property JSON.
+    /// \param symbol The symbol to fill with the detected break, or nullptr.
+    /// \returns the range of detected languages.
+    Range parseProperty(const ofJson& json, Symbol* symbol);
+
+    /// \returns the index of a language code, adding it if needed.
+    uint32_t internLanguage(const std::string& code);
+
+    /// \brief Decode a BoundingPoly.
+    static void parseBoundingBox(const ofJson& json, BoundingBox& boundingBox);
+
+    /// \brief The shared UTF-8 text buffer.
+    std::string _text;
+
+    std::vector<Page> _pages;
+    std::vector<Block> _blocks;
+    std::vector<Paragraph> _paragraphs;
+    std::vector<Word> _words;
+    std::vector<Symbol> _symbols;
+    std::vector<DetectedLanguage> _languages;
+    std::vector<std::string> _languageCodes;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
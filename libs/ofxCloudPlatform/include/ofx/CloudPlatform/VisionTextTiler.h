@@ -0,0 +1,130 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include "ofx/CloudPlatform/VisionClient.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Tiled text detection for large images.
+///
+/// A large image is split into overlapping tiles that are sent at full
+/// resolution, so small text is not lost to downsampling. Tiles are sent in
+/// batches of up to maxTilesPerRequest, with batches running in parallel on
+/// their own clients.
+///
+/// Word annotations are mapped back into image coordinates. Words seen by
+/// more than one tile are deduplicated by bounding box overlap, keeping the
+/// largest, which is usually the one not cut by a tile edge. Only words from
+/// different tiles that reach into a tile overlap are compared, so dense or
+/// stacked text within a tile is never merged.
+class VisionTextTiler
+{
+public:
+    enum
+    {
+        /// \brief The default tile width and height in pixels.
+        DEFAULT_TILE_SIZE = 1600,
+
+        /// \brief The default tile overlap in pixels.
+        DEFAULT_OVERLAP = 128,
+
+        /// \brief The default number of tiles per request.
+        DEFAULT_MAX_TILES_PER_REQUEST = 4,
+
+        /// \brief The default number of requests in flight.
+        DEFAULT_MAX_CONCURRENT_REQUESTS = 4,
+
+        /// \brief The API limit on images per request.
+        MAX_IMAGES_PER_REQUEST = 16
+    };
+
+    /// \brief Tiler settings.
+    struct Settings
+    {
+        /// \brief The credentials used by each request's client.
+        ServiceAccountCredentials credentials;
+
+        /// \brief The tile width and height in pixels.
+        std::size_t tileSize = DEFAULT_TILE_SIZE;
+
+        /// \brief The overlap between adjacent tiles in pixels.
+        ///
+        /// This should be larger than the largest expected word.
+        std::size_t overlap = DEFAULT_OVERLAP;
+
+        /// \brief The number of tiles sent in each request.
+        std::size_t maxTilesPerRequest = DEFAULT_MAX_TILES_PER_REQUEST;
+
+        /// \brief The maximum number of requests in flight.
+        std::size_t maxConcurrentRequests = DEFAULT_MAX_CONCURRENT_REQUESTS;
+
+        /// \brief The text feature to request.
+        VisionRequestItem::Feature::Type feature = VisionRequestItem::Feature::Type::DOCUMENT_TEXT_DETECTION;
+
+        /// \brief The overlap [0, 1] of the smaller box above which words are
+        /// considered duplicates.
+        float duplicateThreshold = 0.5f;
+    };
+
+    /// \brief Create a VisionTextTiler.
+    /// \param settings The settings to use.
+    VisionTextTiler(const Settings& settings);
+
+    /// \brief Destroy the VisionTextTiler.
+    ~VisionTextTiler();
+
+    /// \brief Detect words in a large image.
+    /// \param pixels The image pixels.
+    /// \returns the word annotations in image coordinates.
+    /// \throws Poco::Net::HTTPException if any request or tile fails.
+    std::vector<EntityAnnotation> annotate(const ofPixels& pixels) const;
+
+    /// \returns the settings.
+    const Settings& settings() const;
+
+    /// \brief Compute the overlapping tiles covering an image.
+    /// \param width The image width.
+    /// \param height The image height.
+    /// \param tileSize The tile width and height.
+    /// \param overlap The overlap between adjacent tiles.
+    /// \returns the tiles in image coordinates, in row major order.
+    static std::vector<ofRectangle> tiles(std::size_t width,
+                                          std::size_t height,
+                                          std::size_t tileSize,
+                                          std::size_t overlap);
+
+    /// \brief Remove words seen by more than one tile.
+    ///
+    /// Only words whose boxes reach into another tile are compared, with a
+    /// sweep over their x coordinates, and only against words from other
+    /// tiles. Larger words are kept over smaller words that mostly overlap
+    /// them. The order of the remaining words is preserved.
+    ///
+    /// \param words The words to deduplicate.
+    /// \param wordTiles The index of the tile each word came from.
+    /// \param tiles The tiles in image coordinates.
+    /// \param threshold The overlap [0, 1] of the smaller box above which
+    ///        words are duplicates.
+    /// \returns the deduplicated words.
+    static std::vector<EntityAnnotation> deduplicate(const std::vector<EntityAnnotation>& words,
+                                                     const std::vector<std::size_t>& wordTiles,
+                                                     const std::vector<ofRectangle>& tiles,
+                                                     float threshold);
+
+private:
+    Settings _settings;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
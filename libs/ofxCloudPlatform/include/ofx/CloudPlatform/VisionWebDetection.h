@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#pragma once
+
+
+#include <unordered_map>
+#include "ofJson.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+/// \brief Relevant information for the image from the Internet.
+///
+/// Every string is interned in a per-response string pool and referred to
+/// by a StringId. URLs are split into an interned scheme and host, such as
+/// "https://example.com", and an interned remainder, so the hosts that repeat
+/// across matching images and pages are stored once.
+///
+/// Usage:
+///
+///     const auto& web = response.webDetection();
+///
+///     for (const auto& image: web.fullMatchingImages())
+///     {
+///         std::cout << web.url(image.url) << std::endl;
+///     }
+///
+/// \sa https://cloud.google.com/vision/docs/reference/rest/v1/AnnotateImageResponse#WebDetection
+class WebDetection
+{
+public:
+    /// \brief The index of a string in strings(). 0 is the empty string.
+    typedef uint32_t StringId;
+
+    /// \brief A half-open range [begin, end) of indices.
+    struct Range
+    {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+
+    /// \brief A URL split into its interned scheme and host, and remainder.
+    struct URL
+    {
+        StringId host = 0;
+        StringId path = 0;
+    };
+
+    /// \brief An entity deduced from similar images on the Internet.
+    struct WebEntity
+    {
+        StringId entityId = 0;
+        StringId description = 0;
+        float score = 0;
+    };
+
+    /// \brief Metadata for an online image.
+    struct WebImage
+    {
+        URL url;
+        float score = 0;
+    };
+
+    /// \brief Metadata for a web page.
+    struct WebPage
+    {
+        URL url;
+        StringId pageTitle = 0;
+        float score = 0;
+
+        /// \brief The range of full matching images in pageImages().
+        Range fullMatchingImages;
+
+        /// \brief The range of partial matching images in pageImages().
+        Range partialMatchingImages;
+    };
+
+    /// \brief A guess at the topic of the image.
+    struct WebLabel
+    {
+        StringId label = 0;
+        StringId languageCode = 0;
+    };
+
+    /// \brief Create an empty WebDetection.
+    WebDetection();
+
+    /// \brief Destroy the WebDetection.
+    ~WebDetection();
+
+    WebDetection(const WebDetection&) = default;
+    WebDetection(WebDetection&&) = default;
+    WebDetection& operator = (const WebDetection&) = default;
+    WebDetection& operator = (WebDetection&&) = default;
+
+    const std::vector<WebEntity>& webEntities() const;
+    const std::vector<WebImage>& fullMatchingImages() const;
+    const std::vector<WebImage>& partialMatchingImages() const;
+    const std::vector<WebPage>& pagesWithMatchingImages() const;
+    const std::vector<WebImage>& visuallySimilarImages() const;
+    const std::vector<WebLabel>& bestGuessLabels() const;
+
+    /// \returns the matching images of all pages.
+    const std::vector<WebImage>& pageImages() const;
+
+    /// \returns the string pool.
+    const std::vector<std::string>& strings() const;
+
+    /// \brief Get an interned string.
+    /// \param id The string id.
+    /// \returns the string.
+    const std::string& string(StringId id) const;
+
+    /// \brief Get a URL.
+    /// \param url The split URL.
+    /// \returns the full URL.
+    std::string url(const URL& url) const;
+
+    /// \returns true if nothing was detected.
+    bool empty() const;
+
+    /// \brief Estimate the memory used by this annotation.
+    /// \returns the estimated size in bytes.
+    std::size_t memoryFootprint() const;
+
+    /// \brief Create an instance from JSON.
+    /// \param json The JSON to use.
+    /// \returns an instance of the object.
+    static WebDetection fromJSON(const ofJson& json);
+
+private:
+    friend class VisionSnapshot;
+
+    /// \brief An index of interned strings, used while decoding.
+    typedef std::unordered_map<std::string, StringId> StringIndex;
+
+    /// \brief Intern a string.
+    StringId intern(const std::string& text, StringIndex& index);
+
+    /// \brief Split and intern a URL.
+    URL internURL(const std::string& url, StringIndex& index);
+
+    WebEntity parseEntity(const ofJson& json, StringIndex& index);
+    WebImage parseImage(const ofJson& json, StringIndex& index);
+    WebPage parsePage(const ofJson& json, StringIndex& index);
+    WebLabel parseLabel(const ofJson& json, StringIndex& index);
+
+    std::vector<WebEntity> _webEntities;
+    std::vector<WebImage> _fullMatchingImages;
+    std::vector<WebImage> _partialMatchingImages;
+    std::vector<WebPage> _pagesWithMatchingImages;
+    std::vector<WebImage> _visuallySimilarImages;
+    std::vector<WebLabel> _bestGuessLabels;
+    std::vector<WebImage> _pageImages;
+
+    /// \brief The string pool.
+    std::vector<std::string> _strings;
+
+};
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,328 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/Base64.h"
+#include <cstdint>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OFX_CLOUDPLATFORM_BASE64_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define OFX_CLOUDPLATFORM_TARGET(features)
+#else
+#define OFX_CLOUDPLATFORM_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+const char BASE64_ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+
+/// \brief Encode the remaining bytes, including padding.
+std::size_t encodeScalar(const std::uint8_t* input, std::size_t size, char* output)
+{
+    char* out = output;
+
+    while (size >= 3)
+    {
+        std::uint32_t triple = (std::uint32_t(input[0]) << 16)
+                             | (std::uint32_t(input[1]) << 8)
+                             |  std::uint32_t(input[2]);
+        *out++ = BASE64_ALPHABET[(triple >> 18) & 0x3F];
+        *out++ = BASE64_ALPHABET[(triple >> 12) & 0x3F];
+        *out++ = BASE64_ALPHABET[(triple >> 6) & 0x3F];
+        *out++ = BASE64_ALPHABET[triple & 0x3F];
+        input += 3;
+        size -= 3;
+    }
+
+    if (size == 1)
+    {
+        std::uint32_t triple = std::uint32_t(input[0]) << 16;
+        *out++ = BASE64_ALPHABET[(triple >> 18) & 0x3F];
+        *out++ = BASE64_ALPHABET[(triple >> 12) & 0x3F];
+        *out++ = '=';
+        *out++ = '=';
+    }
+    else if (size == 2)
+    {
+        std::uint32_t triple = (std::uint32_t(input[0]) << 16)
+                             | (std::uint32_t(input[1]) << 8);
+        *out++ = BASE64_ALPHABET[(triple >> 18) & 0x3F];
+        *out++ = BASE64_ALPHABET[(triple >> 12) & 0x3F];
+        *out++ = BASE64_ALPHABET[(triple >> 6) & 0x3F];
+        *out++ = '=';
+    }
+
+    return out - output;
+}
+
+
+#if defined(OFX_CLOUDPLATFORM_BASE64_X86)
+
+
+// The SIMD kernels follow Wojciech Muła's base64 encoding scheme: a byte
+// shuffle places each 3-byte group in a 32-bit lane, two multiplies split the
+// lane into four 6-bit indices and a 16-entry shuffle table maps index ranges
+// to ASCII offsets.
+
+
+OFX_CLOUDPLATFORM_TARGET("sse4.1")
+inline __m128i encodeIndicesSSE(__m128i input)
+{
+    input = _mm_shuffle_epi8(input, _mm_set_epi8(10, 11, 9, 10,
+                                                 7, 8, 6, 7,
+                                                 4, 5, 3, 4,
+                                                 1, 2, 0, 1));
+
+    const __m128i t0 = _mm_and_si128(input, _mm_set1_epi32(0x0fc0fc00));
+    const __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    const __m128i t2 = _mm_and_si128(input, _mm_set1_epi32(0x003f03f0));
+    const __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    const __m128i indices = _mm_or_si128(t1, t3);
+
+    __m128i result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    const __m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+
+    const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                          '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                          '/' - 63, 'A', 0, 0);
+
+    return _mm_add_epi8(_mm_shuffle_epi8(offsets, result), indices);
+}
+
+
+OFX_CLOUDPLATFORM_TARGET("sse4.1")
+std::size_t encodeSSE41(const std::uint8_t* input, std::size_t size, char* output)
+{
+    char* out = output;
+
+    // Each iteration reads 16 bytes and consumes 12.
+    while (size >= 16)
+    {
+        __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), encodeIndicesSSE(in));
+        input += 12;
+        size -= 12;
+        out += 16;
+    }
+
+    return (out - output) + encodeScalar(input, size, out);
+}
+
+
+OFX_CLOUDPLATFORM_TARGET("avx2")
+std::size_t encodeAVX2(const std::uint8_t* input, std::size_t size, char* output)
+{
+    char* out = output;
+
+    const __m256i shuffle = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4,
+                                             7, 6, 8, 7, 10, 9, 11, 10,
+                                             1, 0, 2, 1, 4, 3, 5, 4,
+                                             7, 6, 8, 7, 10, 9, 11, 10);
+
+    const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                             '/' - 63, 'A', 0, 0,
+                                             'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                             '0' - 52, '0' - 52, '0' - 52, '+' - 62,
+                                             '/' - 63, 'A', 0, 0);
+
+    // Each iteration reads 28 bytes (two overlapping 16 byte lanes) and
+    // consumes 24.
+    while (size >= 28)
+    {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + 12));
+        __m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in = _mm256_shuffle_epi8(in, shuffle);
+
+        const __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        const __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        const __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        const __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        const __m256i indices = _mm256_or_si256(t1, t3);
+
+        __m256i result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+        const __m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+        result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        result = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, result), indices);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), result);
+
+        input += 24;
+        size -= 24;
+        out += 32;
+    }
+
+    return (out - output) + encodeSSE41(input, size, out);
+}
+
+
+bool cpuSupports(Base64::Implementation implementation)
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+
+    __cpuid(info, 1);
+    bool sse41 = (info[2] & (1 << 19)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+
+    if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse41 = __builtin_cpu_supports("sse4.1");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    switch (implementation)
+    {
+        case Base64::Implementation::AUTOMATIC:
+        case Base64::Implementation::SCALAR:
+            return true;
+        case Base64::Implementation::SSE41:
+            return sse41;
+        case Base64::Implementation::AVX2:
+            return avx2 && sse41;
+    }
+
+    return false;
+}
+
+
+#else
+
+
+bool cpuSupports(Base64::Implementation implementation)
+{
+    return implementation == Base64::Implementation::AUTOMATIC
+        || implementation == Base64::Implementation::SCALAR;
+}
+
+
+#endif
+
+
+Base64::Implementation detectImplementation()
+{
+    if (cpuSupports(Base64::Implementation::AVX2))
+    {
+        return Base64::Implementation::AVX2;
+    }
+    else if (cpuSupports(Base64::Implementation::SSE41))
+    {
+        return Base64::Implementation::SSE41;
+    }
+
+    return Base64::Implementation::SCALAR;
+}
+
+
+} // namespace
+
+
+std::size_t Base64::encodedSize(std::size_t size)
+{
+    return ((size + 2) / 3) * 4;
+}
+
+
+std::size_t Base64::encode(const void* data,
+                           std::size_t size,
+                           char* output,
+                           Implementation implementation)
+{
+    const std::uint8_t* input = static_cast<const std::uint8_t*>(data);
+
+    if (implementation == Implementation::AUTOMATIC || !isSupported(implementation))
+    {
+        implementation = Base64::implementation();
+    }
+
+    switch (implementation)
+    {
+#if defined(OFX_CLOUDPLATFORM_BASE64_X86)
+        case Implementation::AVX2:
+            return encodeAVX2(input, size, output);
+        case Implementation::SSE41:
+            return encodeSSE41(input, size, output);
+#endif
+        default:
+            return encodeScalar(input, size, output);
+    }
+}
+
+
+std::string Base64::encode(const void* data,
+                           std::size_t size,
+                           Implementation implementation)
+{
+    std::string output(encodedSize(size), '\0');
+
+    if (!output.empty())
+    {
+        encode(data, size, &output[0], implementation);
+    }
+
+    return output;
+}
+
+
+Base64::Implementation Base64::implementation()
+{
+    static const Implementation selected = detectImplementation();
+    return selected;
+}
+
+
+bool Base64::isSupported(Implementation implementation)
+{
+    return cpuSupports(implementation);
+}
+
+
+std::string Base64::toString(Implementation implementation)
+{
+    switch (implementation)
+    {
+        case Implementation::AUTOMATIC:
+            return "AUTOMATIC";
+        case Implementation::SCALAR:
+            return "SCALAR";
+        case Implementation::SSE41:
+            return "SSE41";
+        case Implementation::AVX2:
+            return "AVX2";
+    }
+
+    return "UNKNOWN";
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -7,6 +7,9 @@
 
 #include "ofx/CloudPlatform/VisionAnnotations.h"
 #include "ofx/CloudPlatform/VisionDeserializer.h"
+#include "ofx/CloudPlatform/VisionHash.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
 
 
 namespace ofx {
@@ -46,15 +49,26 @@ const std::map<Likelihood::Type, float> Likelihood::LIKELIHOOD_VALUES =
 };
 
 
+constexpr const char* Likelihood::TYPE_NAMES[];
+constexpr float Likelihood::TYPE_VALUES[];
+
+
+static_assert(sizeof(Likelihood::TYPE_NAMES) / sizeof(const char*)
+              == static_cast<std::size_t>(Likelihood::Type::VERY_LIKELY) + 1,
+              "TYPE_NAMES must have one name per Likelihood::Type.");
+
+
+static_assert(sizeof(Likelihood::TYPE_VALUES) / sizeof(float)
+              == static_cast<std::size_t>(Likelihood::Type::VERY_LIKELY) + 1,
+              "TYPE_VALUES must have one value per Likelihood::Type.");
+
+
 Likelihood::Likelihood(): Likelihood(Type::UNKNOWN)
 {
 }
 
 
-Likelihood::Likelihood(Type type):
-    _type(type),
-    _value(LIKELIHOOD_VALUES.find(_type)->second),
-    _name(LIKELIHOOD_STRINGS.find(_type)->second)
+Likelihood::Likelihood(Type type): _type(type)
 {
 }
 
@@ -70,31 +84,55 @@ Likelihood::Type Likelihood::type() const
 }
 
 
-std::string Likelihood::name() const
+const std::string& Likelihood::name() const
 {
-    return _name;
+    static const std::vector<std::string> names(std::begin(TYPE_NAMES), std::end(TYPE_NAMES));
+    return names[static_cast<std::size_t>(_type)];
 }
 
 
 float Likelihood::value() const
 {
-    return _value;
+    return toValue(_type);
 }
 
 
 Likelihood Likelihood::fromString(const std::string& text)
 {
-    const auto& iter = STRINGS_LIKELIHOOD.find(text);
+    Type type = Type::UNKNOWN;
+
+    if (!fromString(text, type))
+    {
+        VisionParseDiagnostics::unknownValue("Likelihood", text);
+    }
+
+    return Likelihood(type);
+}
+
+
+bool Likelihood::fromString(const std::string& text, Type& type)
+{
+    Type candidate;
 
-    if (iter != STRINGS_LIKELIHOOD.cend())
+    switch (VisionHash::fnv1a(text))
     {
-        return Likelihood(iter->second);
+        case VisionHash::fnv1a("UNKNOWN"): candidate = Type::UNKNOWN; break;
+        case VisionHash::fnv1a("VERY_UNLIKELY"): candidate = Type::VERY_UNLIKELY; break;
+        case VisionHash::fnv1a("UNLIKELY"): candidate = Type::UNLIKELY; break;
+        case VisionHash::fnv1a("POSSIBLE"): candidate = Type::POSSIBLE; break;
+        case VisionHash::fnv1a("LIKELY"): candidate = Type::LIKELY; break;
+        case VisionHash::fnv1a("VERY_LIKELY"): candidate = Type::VERY_LIKELY; break;
+        default: return false;
     }
-    else
+
+    // Confirm the match, as other strings may share a hash.
+    if (text != toString(candidate))
     {
-        ofLogWarning("Likelihood::fromString") << "Unknown Likelihood: " << text;
-        return Likelihood(Type::UNKNOWN);
+        return false;
     }
+
+    type = candidate;
+    return true;
 }
 
 
@@ -108,19 +146,19 @@ EntityAnnotation::~EntityAnnotation()
 }
 
 
-std::string EntityAnnotation::mid() const
+const std::string& EntityAnnotation::mid() const
 {
     return _mid;
 }
 
 
-std::string EntityAnnotation::locale() const
+const std::string& EntityAnnotation::locale() const
 {
     return _locale;
 }
 
 
-std::string EntityAnnotation::description() const
+const std::string& EntityAnnotation::description() const
 {
     return _description;
 }
@@ -144,24 +182,84 @@ float EntityAnnotation::topicality() const
 }
 
 
-ofPolyline EntityAnnotation::boundingPoly() const
+const ofPolyline& EntityAnnotation::boundingPoly() const
 {
     return _boundingPoly;
 }
 
 
-std::vector<std::pair<double, double>> EntityAnnotation::locations()
+const std::vector<std::pair<double, double>>& EntityAnnotation::locations() const
 {
     return _locations;
 }
 
 
-std::unordered_multimap<std::string, std::string> EntityAnnotation::properties()
+const std::unordered_multimap<std::string, std::string>& EntityAnnotation::properties() const
 {
     return _properties;
 }
 
 
+std::size_t EntityAnnotation::memoryFootprint() const
+{
+    std::size_t size = sizeof(EntityAnnotation)
+                     + _mid.capacity()
+                     + _locale.capacity()
+                     + _description.capacity()
+                     + _boundingPoly.size() * sizeof(glm::vec3)
+                     + _locations.capacity() * sizeof(std::pair<double, double>);
+
+    for (const auto& property: _properties)
+    {
+        size += sizeof(property) + property.first.capacity() + property.second.capacity();
+    }
+
+    return size;
+}
+
+
+namespace {
+
+
+/// \brief EntityAnnotation json keys.
+enum
+{
+    ENTITY_MID,
+    ENTITY_LOCALE,
+    ENTITY_DESCRIPTION,
+    ENTITY_SCORE,
+    ENTITY_CONFIDENCE,
+    ENTITY_TOPICALITY,
+    ENTITY_BOUNDING_POLY,
+    ENTITY_LOCATIONS,
+    ENTITY_PROPERTIES,
+    NUM_ENTITY_KEYS
+};
+
+
+constexpr const char* ENTITY_KEY_NAMES[NUM_ENTITY_KEYS] =
+{
+    "mid",
+    "locale",
+    "description",
+    "score",
+    "confidence",
+    "topicality",
+    "boundingPoly",
+    "locations",
+    "properties"
+};
+
+
+constexpr VisionKeyTable<NUM_ENTITY_KEYS> ENTITY_KEYS(ENTITY_KEY_NAMES);
+
+
+static_assert(ENTITY_KEYS.isValid(), "No perfect hash for EntityAnnotation keys.");
+
+
+}
+
+
 EntityAnnotation EntityAnnotation::fromJSON(const ofJson& json)
 {
     EntityAnnotation annotation;
@@ -172,30 +270,31 @@ EntityAnnotation EntityAnnotation::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "mid") annotation._mid = value;
-        else if (key == "locale") annotation._locale = value;
-        else if (key == "description") annotation._description = value;
-        else if (key == "score") annotation._score = value;
-        else if (key == "confidence") annotation._score = value;
-        else if (key == "topicality") annotation._topicality = value;
-        else if (key == "boundingPoly") VisionDeserializer::fromJSON(value, annotation._boundingPoly);
-        else if (key == "locations")
+        switch (ENTITY_KEYS.find(key))
         {
-            for (const auto& location: value)
-            {
-                double latitude = location["latLng"]["latitude"];
-                double longitude = location["latLng"]["longitude"];
-                annotation._locations.push_back(std::make_pair(latitude, longitude));
-            }
+            case ENTITY_MID: annotation._mid = value; break;
+            case ENTITY_LOCALE: annotation._locale = value; break;
+            case ENTITY_DESCRIPTION: annotation._description = value; break;
+            case ENTITY_SCORE: annotation._score = value; break;
+            case ENTITY_CONFIDENCE: annotation._score = value; break;
+            case ENTITY_TOPICALITY: annotation._topicality = value; break;
+            case ENTITY_BOUNDING_POLY: VisionDeserializer::fromJSON(value, annotation._boundingPoly); break;
+            case ENTITY_LOCATIONS:
+                for (const auto& location: value)
+                {
+                    double latitude = location["latLng"]["latitude"];
+                    double longitude = location["latLng"]["longitude"];
+                    annotation._locations.push_back(std::make_pair(latitude, longitude));
+                }
+                break;
+            case ENTITY_PROPERTIES:
+                for (const auto& nameValue: value)
+                {
+                    annotation._properties.insert(std::make_pair<std::string, std::string>(nameValue["name"], nameValue["value"]));
+                }
+                break;
+            default: VisionParseDiagnostics::unknownKey("EntityAnnotation", key, value);
         }
-        else if (key == "properties")
-        {
-            for (const auto& nameValue: value)
-            {
-                annotation._properties.insert(std::make_pair<std::string, std::string>(nameValue["name"], nameValue["value"]));
-            }
-        }
-        else ofLogWarning("EntityAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
 
         ++iter;
     }
@@ -204,6 +303,15 @@ EntityAnnotation EntityAnnotation::fromJSON(const ofJson& json)
 }
 
 
+constexpr std::size_t FaceAnnotation::Landmark::NUM_TYPES;
+constexpr const char* FaceAnnotation::Landmark::TYPE_NAMES[];
+
+
+static_assert(FaceAnnotation::Landmark::NUM_TYPES
+              == static_cast<std::size_t>(FaceAnnotation::Landmark::Type::CHIN_RIGHT_GONION) + 1,
+              "TYPE_NAMES must have one name per Landmark::Type.");
+
+
 FaceAnnotation::Landmark::Landmark()
 {
 }
@@ -211,7 +319,6 @@ FaceAnnotation::Landmark::Landmark()
 
 FaceAnnotation::Landmark::Landmark(Type type, const glm::vec3& position):
     _type(type),
-    _name(LANDMARK_TYPE_STRINGS.find(Landmark::Type::UNKNOWN_LANDMARK)->second),
     _position(position)
 {
 }
@@ -223,18 +330,47 @@ FaceAnnotation::Landmark::Type FaceAnnotation::Landmark::type() const
 }
 
 
-std::string FaceAnnotation::Landmark::name() const
+const std::string& FaceAnnotation::Landmark::name() const
 {
-    return _name;
+    static const std::vector<std::string> names(std::begin(TYPE_NAMES), std::end(TYPE_NAMES));
+    return names[static_cast<std::size_t>(_type)];
 }
 
 
-glm::vec3 FaceAnnotation::Landmark::position() const
+const glm::vec3& FaceAnnotation::Landmark::position() const
 {
     return _position;
 }
 
 
+namespace {
+
+
+/// \brief FaceAnnotation::Landmark json keys.
+enum
+{
+    LANDMARK_TYPE,
+    LANDMARK_POSITION,
+    NUM_LANDMARK_KEYS
+};
+
+
+constexpr const char* LANDMARK_KEY_NAMES[NUM_LANDMARK_KEYS] =
+{
+    "type",
+    "position"
+};
+
+
+constexpr VisionKeyTable<NUM_LANDMARK_KEYS> LANDMARK_KEYS(LANDMARK_KEY_NAMES);
+
+
+static_assert(LANDMARK_KEYS.isValid(), "No perfect hash for FaceAnnotation::Landmark keys.");
+
+
+}
+
+
 FaceAnnotation::Landmark FaceAnnotation::Landmark::fromJSON(const ofJson& json)
 {
     FaceAnnotation::Landmark landmark;
@@ -243,30 +379,79 @@ FaceAnnotation::Landmark FaceAnnotation::Landmark::fromJSON(const ofJson& json)
     {
         const auto& key = iter.key();
         const auto& value = iter.value();
-        if (key == "type")
+        switch (LANDMARK_KEYS.find(key))
         {
-            const auto& iter = STRINGS_LANDMARK_TYPE.find(value);
-
-            if (iter != STRINGS_LANDMARK_TYPE.cend())
-            {
-                landmark._type = iter->second;
-                landmark._name = iter->first;
-            }
-            else
-            {
-                landmark._type = Landmark::Type::UNKNOWN_LANDMARK;
-                landmark._name = LANDMARK_TYPE_STRINGS.find(Landmark::Type::UNKNOWN_LANDMARK)->second;
-                ofLogWarning("FaceAnnotation::Landmark::fromJSON") << "Unknown Landmark Type: " << value;
-            }
+            case LANDMARK_TYPE:
+                if (!fromString(value.get_ref<const std::string&>(), landmark._type))
+                {
+                    landmark._type = Landmark::Type::UNKNOWN_LANDMARK;
+                    VisionParseDiagnostics::unknownValue("FaceAnnotation::Landmark::Type", value.get_ref<const std::string&>());
+                }
+                break;
+            case LANDMARK_POSITION: VisionDeserializer::fromJSON(value, landmark._position); break;
+            default: VisionParseDiagnostics::unknownKey("FaceAnnotation::Landmark", key, value);
         }
-        else if (key == "position") VisionDeserializer::fromJSON(value, landmark._position);
-        else ofLogWarning("FaceAnnotation::Landmark::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
         ++iter;
     }
     return landmark;
 }
 
 
+bool FaceAnnotation::Landmark::fromString(const std::string& text, Type& type)
+{
+    Type candidate;
+
+    switch (VisionHash::fnv1a(text))
+    {
+        case VisionHash::fnv1a("UNKNOWN_LANDMARK"): candidate = Type::UNKNOWN_LANDMARK; break;
+        case VisionHash::fnv1a("LEFT_EYE"): candidate = Type::LEFT_EYE; break;
+        case VisionHash::fnv1a("RIGHT_EYE"): candidate = Type::RIGHT_EYE; break;
+        case VisionHash::fnv1a("LEFT_OF_LEFT_EYEBROW"): candidate = Type::LEFT_OF_LEFT_EYEBROW; break;
+        case VisionHash::fnv1a("RIGHT_OF_LEFT_EYEBROW"): candidate = Type::RIGHT_OF_LEFT_EYEBROW; break;
+        case VisionHash::fnv1a("LEFT_OF_RIGHT_EYEBROW"): candidate = Type::LEFT_OF_RIGHT_EYEBROW; break;
+        case VisionHash::fnv1a("RIGHT_OF_RIGHT_EYEBROW"): candidate = Type::RIGHT_OF_RIGHT_EYEBROW; break;
+        case VisionHash::fnv1a("MIDPOINT_BETWEEN_EYES"): candidate = Type::MIDPOINT_BETWEEN_EYES; break;
+        case VisionHash::fnv1a("NOSE_TIP"): candidate = Type::NOSE_TIP; break;
+        case VisionHash::fnv1a("UPPER_LIP"): candidate = Type::UPPER_LIP; break;
+        case VisionHash::fnv1a("LOWER_LIP"): candidate = Type::LOWER_LIP; break;
+        case VisionHash::fnv1a("MOUTH_LEFT"): candidate = Type::MOUTH_LEFT; break;
+        case VisionHash::fnv1a("MOUTH_RIGHT"): candidate = Type::MOUTH_RIGHT; break;
+        case VisionHash::fnv1a("MOUTH_CENTER"): candidate = Type::MOUTH_CENTER; break;
+        case VisionHash::fnv1a("NOSE_BOTTOM_RIGHT"): candidate = Type::NOSE_BOTTOM_RIGHT; break;
+        case VisionHash::fnv1a("NOSE_BOTTOM_LEFT"): candidate = Type::NOSE_BOTTOM_LEFT; break;
+        case VisionHash::fnv1a("NOSE_BOTTOM_CENTER"): candidate = Type::NOSE_BOTTOM_CENTER; break;
+        case VisionHash::fnv1a("LEFT_EYE_TOP_BOUNDARY"): candidate = Type::LEFT_EYE_TOP_BOUNDARY; break;
+        case VisionHash::fnv1a("LEFT_EYE_RIGHT_CORNER"): candidate = Type::LEFT_EYE_RIGHT_CORNER; break;
+        case VisionHash::fnv1a("LEFT_EYE_BOTTOM_BOUNDARY"): candidate = Type::LEFT_EYE_BOTTOM_BOUNDARY; break;
+        case VisionHash::fnv1a("LEFT_EYE_LEFT_CORNER"): candidate = Type::LEFT_EYE_LEFT_CORNER; break;
+        case VisionHash::fnv1a("RIGHT_EYE_TOP_BOUNDARY"): candidate = Type::RIGHT_EYE_TOP_BOUNDARY; break;
+        case VisionHash::fnv1a("RIGHT_EYE_RIGHT_CORNER"): candidate = Type::RIGHT_EYE_RIGHT_CORNER; break;
+        case VisionHash::fnv1a("RIGHT_EYE_BOTTOM_BOUNDARY"): candidate = Type::RIGHT_EYE_BOTTOM_BOUNDARY; break;
+        case VisionHash::fnv1a("RIGHT_EYE_LEFT_CORNER"): candidate = Type::RIGHT_EYE_LEFT_CORNER; break;
+        case VisionHash::fnv1a("LEFT_EYEBROW_UPPER_MIDPOINT"): candidate = Type::LEFT_EYEBROW_UPPER_MIDPOINT; break;
+        case VisionHash::fnv1a("RIGHT_EYEBROW_UPPER_MIDPOINT"): candidate = Type::RIGHT_EYEBROW_UPPER_MIDPOINT; break;
+        case VisionHash::fnv1a("LEFT_EAR_TRAGION"): candidate = Type::LEFT_EAR_TRAGION; break;
+        case VisionHash::fnv1a("RIGHT_EAR_TRAGION"): candidate = Type::RIGHT_EAR_TRAGION; break;
+        case VisionHash::fnv1a("LEFT_EYE_PUPIL"): candidate = Type::LEFT_EYE_PUPIL; break;
+        case VisionHash::fnv1a("RIGHT_EYE_PUPIL"): candidate = Type::RIGHT_EYE_PUPIL; break;
+        case VisionHash::fnv1a("FOREHEAD_GLABELLA"): candidate = Type::FOREHEAD_GLABELLA; break;
+        case VisionHash::fnv1a("CHIN_GNATHION"): candidate = Type::CHIN_GNATHION; break;
+        case VisionHash::fnv1a("CHIN_LEFT_GONION"): candidate = Type::CHIN_LEFT_GONION; break;
+        case VisionHash::fnv1a("CHIN_RIGHT_GONION"): candidate = Type::CHIN_RIGHT_GONION; break;
+        default: return false;
+    }
+
+    // Confirm the match, as other strings may share a hash.
+    if (text != toString(candidate))
+    {
+        return false;
+    }
+
+    type = candidate;
+    return true;
+}
+
+
 const std::map<FaceAnnotation::Landmark::Type, std::size_t> FaceAnnotation::Landmark::LANDMARK_TYPE_INDEX =
 {
     { Type::UNKNOWN_LANDMARK, 0 },
@@ -477,19 +662,19 @@ FaceAnnotation::~FaceAnnotation()
 }
 
 
-ofPolyline FaceAnnotation::boundingPoly() const
+const ofPolyline& FaceAnnotation::boundingPoly() const
 {
     return _boundingPoly;
 }
 
 
-ofPolyline FaceAnnotation::fdBoundingPoly() const
+const ofPolyline& FaceAnnotation::fdBoundingPoly() const
 {
     return _fdBoundingPoly;
 }
 
 
-std::vector<FaceAnnotation::Landmark> FaceAnnotation::landmarks() const
+const std::vector<FaceAnnotation::Landmark>& FaceAnnotation::landmarks() const
 {
     return _landmarks;
 }
@@ -525,48 +710,110 @@ float FaceAnnotation::landmarkingConfidence() const
 }
 
 
-Likelihood FaceAnnotation::joyLikelihood() const
+const Likelihood& FaceAnnotation::joyLikelihood() const
 {
     return _joyLikelihood;
 }
 
 
-Likelihood FaceAnnotation::sorrowLikelihood() const
+const Likelihood& FaceAnnotation::sorrowLikelihood() const
 {
     return _sorrowLikelihood;
 }
 
 
-Likelihood FaceAnnotation::angerLikelihood() const
+const Likelihood& FaceAnnotation::angerLikelihood() const
 {
     return _angerLikelihood;
 }
 
 
-Likelihood FaceAnnotation::surpriseLikelihood() const
+const Likelihood& FaceAnnotation::surpriseLikelihood() const
 {
     return _surpriseLikelihood;
 }
 
 
-Likelihood FaceAnnotation::underExposedLikelihood() const
+const Likelihood& FaceAnnotation::underExposedLikelihood() const
 {
     return _underExposedLikelihood;
 }
 
 
-Likelihood FaceAnnotation::blurredLikelihood() const
+const Likelihood& FaceAnnotation::blurredLikelihood() const
 {
     return _blurredLikelihood;
 }
 
 
-Likelihood FaceAnnotation::headwearLikelihood() const
+const Likelihood& FaceAnnotation::headwearLikelihood() const
 {
     return _headwearLikelihood;
 }
 
 
+std::size_t FaceAnnotation::memoryFootprint() const
+{
+    return sizeof(FaceAnnotation)
+         + (_boundingPoly.size() + _fdBoundingPoly.size()) * sizeof(glm::vec3)
+         + _landmarks.capacity() * sizeof(Landmark);
+}
+
+
+namespace {
+
+
+/// \brief FaceAnnotation json keys.
+enum
+{
+    FACE_BOUNDING_POLY,
+    FACE_FD_BOUNDING_POLY,
+    FACE_LANDMARKS,
+    FACE_ROLL_ANGLE,
+    FACE_PAN_ANGLE,
+    FACE_TILT_ANGLE,
+    FACE_DETECTION_CONFIDENCE,
+    FACE_LANDMARKING_CONFIDENCE,
+    FACE_JOY_LIKELIHOOD,
+    FACE_SORROW_LIKELIHOOD,
+    FACE_ANGER_LIKELIHOOD,
+    FACE_SURPRISE_LIKELIHOOD,
+    FACE_UNDER_EXPOSED_LIKELIHOOD,
+    FACE_BLURRED_LIKELIHOOD,
+    FACE_HEADWEAR_LIKELIHOOD,
+    NUM_FACE_KEYS
+};
+
+
+constexpr const char* FACE_KEY_NAMES[NUM_FACE_KEYS] =
+{
+    "boundingPoly",
+    "fdBoundingPoly",
+    "landmarks",
+    "rollAngle",
+    "panAngle",
+    "tiltAngle",
+    "detectionConfidence",
+    "landmarkingConfidence",
+    "joyLikelihood",
+    "sorrowLikelihood",
+    "angerLikelihood",
+    "surpriseLikelihood",
+    "underExposedLikelihood",
+    "blurredLikelihood",
+    "headwearLikelihood"
+};
+
+
+constexpr VisionKeyTable<NUM_FACE_KEYS> FACE_KEYS(FACE_KEY_NAMES);
+
+
+static_assert(FACE_KEYS.isValid(), "No perfect hash for FaceAnnotation keys.");
+
+
+}
+
+
 FaceAnnotation FaceAnnotation::fromJSON(const ofJson& json)
 {
     FaceAnnotation annotation;
@@ -577,30 +824,32 @@ FaceAnnotation FaceAnnotation::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "boundingPoly") VisionDeserializer::fromJSON(value, annotation._boundingPoly);
-        else if (key == "fdBoundingPoly") VisionDeserializer::fromJSON(value, annotation._fdBoundingPoly);
-        else if (key == "landmarks")
+        switch (FACE_KEYS.find(key))
         {
-            std::vector<FaceAnnotation::Landmark> landmarks;
-
-            for (const auto& landmark : value)
-                landmarks.push_back(FaceAnnotation::Landmark::fromJSON(landmark));
-
-            annotation._landmarks = landmarks;
+            case FACE_BOUNDING_POLY: VisionDeserializer::fromJSON(value, annotation._boundingPoly); break;
+            case FACE_FD_BOUNDING_POLY: VisionDeserializer::fromJSON(value, annotation._fdBoundingPoly); break;
+            case FACE_LANDMARKS:
+                annotation._landmarks.clear();
+                annotation._landmarks.reserve(value.size());
+
+                for (const auto& landmark : value)
+                    annotation._landmarks.push_back(FaceAnnotation::Landmark::fromJSON(landmark));
+
+                break;
+            case FACE_ROLL_ANGLE: annotation._rollAngle = value; break;
+            case FACE_PAN_ANGLE: annotation._panAngle = value; break;
+            case FACE_TILT_ANGLE: annotation._tiltAngle = value; break;
+            case FACE_DETECTION_CONFIDENCE: annotation._detectionConfidence = value; break;
+            case FACE_LANDMARKING_CONFIDENCE: annotation._landmarkingConfidence = value; break;
+            case FACE_JOY_LIKELIHOOD: annotation._joyLikelihood = Likelihood::fromString(value); break;
+            case FACE_SORROW_LIKELIHOOD: annotation._sorrowLikelihood = Likelihood::fromString(value); break;
+            case FACE_ANGER_LIKELIHOOD: annotation._angerLikelihood = Likelihood::fromString(value); break;
+            case FACE_SURPRISE_LIKELIHOOD: annotation._surpriseLikelihood = Likelihood::fromString(value); break;
+            case FACE_UNDER_EXPOSED_LIKELIHOOD: annotation._underExposedLikelihood = Likelihood::fromString(value); break;
+            case FACE_BLURRED_LIKELIHOOD: annotation._blurredLikelihood = Likelihood::fromString(value); break;
+            case FACE_HEADWEAR_LIKELIHOOD: annotation._headwearLikelihood = Likelihood::fromString(value); break;
+            default: VisionParseDiagnostics::unknownKey("FaceAnnotation", key, value);
         }
-        else if (key == "rollAngle") annotation._rollAngle = value;
-        else if (key == "panAngle") annotation._panAngle = value;
-        else if (key == "tiltAngle") annotation._tiltAngle = value;
-        else if (key == "detectionConfidence") annotation._detectionConfidence = value;
-        else if (key == "landmarkingConfidence") annotation._landmarkingConfidence = value;
-        else if (key == "joyLikelihood") annotation._joyLikelihood = Likelihood::fromString(value);
-        else if (key == "sorrowLikelihood") annotation._sorrowLikelihood = Likelihood::fromString(value);
-        else if (key == "angerLikelihood") annotation._angerLikelihood = Likelihood::fromString(value);
-        else if (key == "surpriseLikelihood") annotation._surpriseLikelihood = Likelihood::fromString(value);
-        else if (key == "underExposedLikelihood") annotation._underExposedLikelihood = Likelihood::fromString(value);
-        else if (key == "blurredLikelihood") annotation._blurredLikelihood = Likelihood::fromString(value);
-        else if (key == "headwearLikelihood") annotation._headwearLikelihood = Likelihood::fromString(value);
-        else ofLogWarning("FaceAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
         ++iter;
     }
 
@@ -618,36 +867,70 @@ SafeSearchAnnotation::~SafeSearchAnnotation()
 }
 
 
-Likelihood SafeSearchAnnotation::adult() const
+const Likelihood& SafeSearchAnnotation::adult() const
 {
     return _adult;
 }
 
 
-Likelihood SafeSearchAnnotation::spoof() const
+const Likelihood& SafeSearchAnnotation::spoof() const
 {
     return _spoof;
 }
 
 
-Likelihood SafeSearchAnnotation::medical() const
+const Likelihood& SafeSearchAnnotation::medical() const
 {
     return _medical;
 }
 
 
-Likelihood SafeSearchAnnotation::violence() const
+const Likelihood& SafeSearchAnnotation::violence() const
 {
     return _violence;
 }
 
     
-Likelihood SafeSearchAnnotation::racy() const
+const Likelihood& SafeSearchAnnotation::racy() const
 {
     return _racy;
 }
 
 
+namespace {
+
+
+/// \brief SafeSearchAnnotation json keys.
+enum
+{
+    SAFE_SEARCH_ADULT,
+    SAFE_SEARCH_SPOOF,
+    SAFE_SEARCH_MEDICAL,
+    SAFE_SEARCH_VIOLENCE,
+    SAFE_SEARCH_RACY,
+    NUM_SAFE_SEARCH_KEYS
+};
+
+
+constexpr const char* SAFE_SEARCH_KEY_NAMES[NUM_SAFE_SEARCH_KEYS] =
+{
+    "adult",
+    "spoof",
+    "medical",
+    "violence",
+    "racy"
+};
+
+
+constexpr VisionKeyTable<NUM_SAFE_SEARCH_KEYS> SAFE_SEARCH_KEYS(SAFE_SEARCH_KEY_NAMES);
+
+
+static_assert(SAFE_SEARCH_KEYS.isValid(), "No perfect hash for SafeSearchAnnotation keys.");
+
+
+}
+
+
 SafeSearchAnnotation SafeSearchAnnotation::fromJSON(const ofJson& json)
 {
     SafeSearchAnnotation annotation;
@@ -658,12 +941,15 @@ SafeSearchAnnotation SafeSearchAnnotation::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "adult") annotation._adult = Likelihood::fromString(value);
-        else if (key == "spoof") annotation._spoof = Likelihood::fromString(value);
-        else if (key == "medical") annotation._medical = Likelihood::fromString(value);
-        else if (key == "violence") annotation._violence = Likelihood::fromString(value);
-        else if (key == "racy") annotation._racy = Likelihood::fromString(value);
-        else ofLogWarning("SafeSearchAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
+        switch (SAFE_SEARCH_KEYS.find(key))
+        {
+            case SAFE_SEARCH_ADULT: annotation._adult = Likelihood::fromString(value); break;
+            case SAFE_SEARCH_SPOOF: annotation._spoof = Likelihood::fromString(value); break;
+            case SAFE_SEARCH_MEDICAL: annotation._medical = Likelihood::fromString(value); break;
+            case SAFE_SEARCH_VIOLENCE: annotation._violence = Likelihood::fromString(value); break;
+            case SAFE_SEARCH_RACY: annotation._racy = Likelihood::fromString(value); break;
+            default: VisionParseDiagnostics::unknownKey("SafeSearchAnnotation", key, value);
+        }
         ++iter;
     }
 
@@ -680,7 +966,7 @@ ColorInfo::~ColorInfo()
 {
 }
 
-ofColor ColorInfo::color() const
+const ofColor& ColorInfo::color() const
 {
     return _color;
 }
@@ -698,6 +984,36 @@ float ColorInfo::pixelFraction() const
 }
 
 
+namespace {
+
+
+/// \brief ColorInfo json keys.
+enum
+{
+    COLOR_INFO_COLOR,
+    COLOR_INFO_SCORE,
+    COLOR_INFO_PIXEL_FRACTION,
+    NUM_COLOR_INFO_KEYS
+};
+
+
+constexpr const char* COLOR_INFO_KEY_NAMES[NUM_COLOR_INFO_KEYS] =
+{
+    "color",
+    "score",
+    "pixelFraction"
+};
+
+
+constexpr VisionKeyTable<NUM_COLOR_INFO_KEYS> COLOR_INFO_KEYS(COLOR_INFO_KEY_NAMES);
+
+
+static_assert(COLOR_INFO_KEYS.isValid(), "No perfect hash for ColorInfo keys.");
+
+
+}
+
+
 ColorInfo ColorInfo::fromJSON(const ofJson& json)
 {
     ColorInfo colorInfo;
@@ -708,10 +1024,13 @@ ColorInfo ColorInfo::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "color") VisionDeserializer::fromJSON(value, colorInfo._color);
-        else if (key == "score") colorInfo._score = value;
-        else if (key == "pixelFraction") colorInfo._pixelFraction = value;
-        else ofLogWarning("ColorInfo::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
+        switch (COLOR_INFO_KEYS.find(key))
+        {
+            case COLOR_INFO_COLOR: VisionDeserializer::fromJSON(value, colorInfo._color); break;
+            case COLOR_INFO_SCORE: colorInfo._score = value; break;
+            case COLOR_INFO_PIXEL_FRACTION: colorInfo._pixelFraction = value; break;
+            default: VisionParseDiagnostics::unknownKey("ColorInfo", key, value);
+        }
         ++iter;
     }
 
@@ -730,12 +1049,38 @@ ImagePropertiesAnnotation::~ImagePropertiesAnnotation()
 }
 
 
-std::vector<ColorInfo> ImagePropertiesAnnotation::dominantColors() const
+const std::vector<ColorInfo>& ImagePropertiesAnnotation::dominantColors() const
 {
     return _dominantColors;
 }
 
 
+namespace {
+
+
+/// \brief ImagePropertiesAnnotation json keys.
+enum
+{
+    IMAGE_PROPERTIES_DOMINANT_COLORS,
+    NUM_IMAGE_PROPERTIES_KEYS
+};
+
+
+constexpr const char* IMAGE_PROPERTIES_KEY_NAMES[NUM_IMAGE_PROPERTIES_KEYS] =
+{
+    "dominantColors"
+};
+
+
+constexpr VisionKeyTable<NUM_IMAGE_PROPERTIES_KEYS> IMAGE_PROPERTIES_KEYS(IMAGE_PROPERTIES_KEY_NAMES);
+
+
+static_assert(IMAGE_PROPERTIES_KEYS.isValid(), "No perfect hash for ImagePropertiesAnnotation keys.");
+
+
+}
+
+
 ImagePropertiesAnnotation ImagePropertiesAnnotation::fromJSON(const ofJson& json)
 {
     ImagePropertiesAnnotation annotation;
@@ -746,11 +1091,13 @@ ImagePropertiesAnnotation ImagePropertiesAnnotation::fromJSON(const ofJson& json
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "dominantColors")
+        switch (IMAGE_PROPERTIES_KEYS.find(key))
         {
-            for (const auto& color: value["colors"]) annotation._dominantColors.push_back(ColorInfo::fromJSON(color));
+            case IMAGE_PROPERTIES_DOMINANT_COLORS:
+                for (const auto& color: value["colors"]) annotation._dominantColors.push_back(ColorInfo::fromJSON(color));
+                break;
+            default: VisionParseDiagnostics::unknownKey("ImagePropertiesAnnotation", key, value);
         }
-        else ofLogWarning("ImagePropertiesAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
         ++iter;
     }
 
@@ -769,7 +1116,7 @@ CropHint::~CropHint()
 }
 
 
-ofPolyline CropHint::boundingPoly() const
+const ofPolyline& CropHint::boundingPoly() const
 {
     return _boundingPoly;
 }
@@ -787,6 +1134,36 @@ float CropHint::importanceFraction() const
 }
 
     
+namespace {
+
+
+/// \brief CropHint json keys.
+enum
+{
+    CROP_HINT_CONFIDENCE,
+    CROP_HINT_IMPORTANCE_FRACTION,
+    CROP_HINT_BOUNDING_POLY,
+    NUM_CROP_HINT_KEYS
+};
+
+
+constexpr const char* CROP_HINT_KEY_NAMES[NUM_CROP_HINT_KEYS] =
+{
+    "confidence",
+    "importanceFraction",
+    "boundingPoly"
+};
+
+
+constexpr VisionKeyTable<NUM_CROP_HINT_KEYS> CROP_HINT_KEYS(CROP_HINT_KEY_NAMES);
+
+
+static_assert(CROP_HINT_KEYS.isValid(), "No perfect hash for CropHint keys.");
+
+
+}
+
+
 CropHint CropHint::fromJSON(const ofJson& json)
 {
     CropHint annotation;
@@ -797,10 +1174,13 @@ CropHint CropHint::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
         
-        if (key == "confidence") annotation._confidence = value;
-        else if (key == "importanceFraction") annotation._importanceFraction = value;
-        else if (key == "boundingPoly") VisionDeserializer::fromJSON(value, annotation._boundingPoly);
-        else ofLogWarning("CropHintsAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
+        switch (CROP_HINT_KEYS.find(key))
+        {
+            case CROP_HINT_CONFIDENCE: annotation._confidence = value; break;
+            case CROP_HINT_IMPORTANCE_FRACTION: annotation._importanceFraction = value; break;
+            case CROP_HINT_BOUNDING_POLY: VisionDeserializer::fromJSON(value, annotation._boundingPoly); break;
+            default: VisionParseDiagnostics::unknownKey("CropHint", key, value);
+        }
         ++iter;
     }
     
@@ -819,12 +1199,38 @@ CropHintsAnnotation::~CropHintsAnnotation()
 }
     
 
-std::vector<CropHint> CropHintsAnnotation::cropHints() const
+const std::vector<CropHint>& CropHintsAnnotation::cropHints() const
 {
     return _cropHints;
 }
 
 
+namespace {
+
+
+/// \brief CropHintsAnnotation json keys.
+enum
+{
+    CROP_HINTS_CROP_HINTS,
+    NUM_CROP_HINTS_KEYS
+};
+
+
+constexpr const char* CROP_HINTS_KEY_NAMES[NUM_CROP_HINTS_KEYS] =
+{
+    "cropHints"
+};
+
+
+constexpr VisionKeyTable<NUM_CROP_HINTS_KEYS> CROP_HINTS_KEYS(CROP_HINTS_KEY_NAMES);
+
+
+static_assert(CROP_HINTS_KEYS.isValid(), "No perfect hash for CropHintsAnnotation keys.");
+
+
+}
+
+
 CropHintsAnnotation CropHintsAnnotation::fromJSON(const ofJson& json)
 {
     CropHintsAnnotation annotation;
@@ -835,11 +1241,13 @@ CropHintsAnnotation CropHintsAnnotation::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
         
-        if (key == "cropHints")
+        switch (CROP_HINTS_KEYS.find(key))
         {
-            for (const auto& cropHint: value) annotation._cropHints.push_back(CropHint::fromJSON(cropHint));
+            case CROP_HINTS_CROP_HINTS:
+                for (const auto& cropHint: value) annotation._cropHints.push_back(CropHint::fromJSON(cropHint));
+                break;
+            default: VisionParseDiagnostics::unknownKey("CropHintsAnnotation", key, value);
         }
-        else ofLogWarning("CropHintsAnnotation::fromJSON") << "Unknown key " << key << " - " << json.dump(4);
 
         ++iter;
     }
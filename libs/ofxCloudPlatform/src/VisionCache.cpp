@@ -0,0 +1,396 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionCache.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include "ofx/CloudPlatform/VisionHash.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+#include "ofFileUtils.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+VisionCache::VisionCache(): VisionCache(Settings())
+{
+}
+
+
+VisionCache::VisionCache(const Settings& settings): _settings(settings)
+{
+    if (!_settings.persistencePath.empty())
+    {
+        ofDirectory::createDirectory(_settings.persistencePath, false, true);
+    }
+}
+
+
+VisionCache::~VisionCache()
+{
+}
+
+
+AnnotateImageResponse VisionCache::annotate(VisionClient& client,
+                                            const VisionRequestItem& item)
+{
+    std::vector<VisionRequestItem> items = { item };
+    return annotate(client, items).front();
+}
+
+
+std::vector<AnnotateImageResponse> VisionCache::annotate(VisionClient& client,
+                                                         const std::vector<VisionRequestItem>& items)
+{
+    std::vector<uint64_t> keys;
+    keys.reserve(items.size());
+
+    for (const auto& item: items)
+    {
+        keys.push_back(key(item));
+    }
+
+    std::vector<std::shared_ptr<const AnnotateImageResponse>> results(items.size());
+    std::vector<std::shared_future<std::shared_ptr<const AnnotateImageResponse>>> pending(items.size());
+
+    // Keys missing from memory are claimed in _inFlight, so only this call
+    // loads them from disk or requests them.
+    std::vector<std::size_t> claimedIndices;
+    std::vector<std::promise<std::shared_ptr<const AnnotateImageResponse>>> claimedPromises;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (std::size_t i = 0; i < items.size(); ++i)
+        {
+            results[i] = find(keys[i]);
+
+            if (results[i])
+            {
+                continue;
+            }
+
+            auto iter = _inFlight.find(keys[i]);
+
+            if (iter != _inFlight.end())
+            {
+                pending[i] = iter->second;
+                ++_statistics.coalesced;
+            }
+            else
+            {
+                claimedPromises.emplace_back();
+                _inFlight[keys[i]] = claimedPromises.back().get_future().share();
+                claimedIndices.push_back(i);
+            }
+        }
+    }
+
+    // Disk reads and parsing happen without the lock.
+    std::vector<std::shared_ptr<const AnnotateImageResponse>> loaded(claimedIndices.size());
+
+    if (!_settings.persistencePath.empty())
+    {
+        for (std::size_t j = 0; j < claimedIndices.size(); ++j)
+        {
+            loaded[j] = load(keys[claimedIndices[j]]);
+        }
+    }
+
+    std::vector<std::size_t> missIndices;
+    std::vector<std::promise<std::shared_ptr<const AnnotateImageResponse>>> promises;
+
+    if (!claimedIndices.empty())
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (std::size_t j = 0; j < claimedIndices.size(); ++j)
+        {
+            std::size_t i = claimedIndices[j];
+
+            if (loaded[j])
+            {
+                insert(keys[i], loaded[j]);
+                ++_statistics.diskHits;
+                results[i] = loaded[j];
+                claimedPromises[j].set_value(loaded[j]);
+                _inFlight.erase(keys[i]);
+            }
+            else
+            {
+                missIndices.push_back(i);
+                promises.push_back(std::move(claimedPromises[j]));
+                ++_statistics.misses;
+            }
+        }
+    }
+
+    if (!missIndices.empty())
+    {
+        std::vector<VisionRequestItem> missItems;
+        missItems.reserve(missIndices.size());
+
+        for (auto i: missIndices)
+        {
+            missItems.push_back(items[i]);
+        }
+
+        std::vector<AnnotateImageResponse> responses;
+
+        try
+        {
+            // Persisted responses are written from their raw json.
+            responses = client.annotate(missItems,
+                                        client.getRetainJSON() || !_settings.persistencePath.empty());
+
+            if (responses.size() != missItems.size())
+            {
+                throw Poco::Net::HTTPException("Unexpected number of responses.");
+            }
+        }
+        catch (...)
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            for (std::size_t j = 0; j < missIndices.size(); ++j)
+            {
+                promises[j].set_exception(std::current_exception());
+                _inFlight.erase(keys[missIndices[j]]);
+            }
+
+            throw;
+        }
+
+        std::vector<std::shared_ptr<const AnnotateImageResponse>> received;
+        received.reserve(missIndices.size());
+
+        for (std::size_t j = 0; j < missIndices.size(); ++j)
+        {
+            received.push_back(std::make_shared<const AnnotateImageResponse>(std::move(responses[j])));
+
+            // Serialization and disk writes happen without the lock. Per-image
+            // errors are returned, but never cached.
+            if (!_settings.persistencePath.empty()
+            &&  !received[j]->hasError()
+            &&  received[j]->hasJSON())
+            {
+                persist(keys[missIndices[j]], received[j]->json().dump());
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        for (std::size_t j = 0; j < missIndices.size(); ++j)
+        {
+            std::size_t i = missIndices[j];
+
+            if (!received[j]->hasError())
+            {
+                insert(keys[i], received[j]);
+            }
+
+            results[i] = received[j];
+            promises[j].set_value(received[j]);
+            _inFlight.erase(keys[i]);
+        }
+    }
+
+    std::vector<AnnotateImageResponse> responses;
+    responses.reserve(items.size());
+
+    for (std::size_t i = 0; i < items.size(); ++i)
+    {
+        if (!results[i])
+        {
+            results[i] = pending[i].get();
+        }
+
+        responses.push_back(*results[i]);
+    }
+
+    return responses;
+}
+
+
+void VisionCache::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+    _statistics.bytes = 0;
+}
+
+
+VisionCache::Statistics VisionCache::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    Statistics statistics = _statistics;
+    statistics.count = _entries.size();
+    return statistics;
+}
+
+
+uint64_t VisionCache::key(const VisionRequestItem& item)
+{
+    uint64_t result = 0;
+
+    const auto& parameters = item.parameters();
+    auto content = item.content();
+
+    if (content)
+    {
+        result = VisionHash::hash(content->data(), content->size());
+    }
+
+    // Responses for the same crop at different positions differ.
+    const auto& region = item.region();
+
+    if (region.x != 0 || region.y != 0)
+    {
+        float position[2] = { region.x, region.y };
+        result = VisionHash::combine(result, VisionHash::hash(position, sizeof(position)));
+    }
+
+    auto requestTemplate = item.requestTemplate();
+
+    if (requestTemplate)
+    {
+        result = VisionHash::combine(result, requestTemplate->hash());
+    }
+
+    if (!parameters.is_object())
+    {
+        return result;
+    }
+
+    auto image = parameters.find("image");
+
+    if (image != parameters.end())
+    {
+        result = VisionHash::combine(result, VisionHash::hash(image->dump()));
+    }
+
+    // Features are normalized so their order and duplicates do not matter.
+    auto features = parameters.find("features");
+
+    if (features != parameters.end())
+    {
+        std::vector<std::string> normalized;
+
+        for (const auto& feature: *features)
+        {
+            normalized.push_back(feature.dump());
+        }
+
+        std::sort(normalized.begin(), normalized.end());
+        normalized.erase(std::unique(normalized.begin(), normalized.end()), normalized.end());
+
+        for (const auto& feature: normalized)
+        {
+            result = VisionHash::combine(result, VisionHash::hash(feature));
+        }
+    }
+
+    auto imageContext = parameters.find("imageContext");
+
+    if (imageContext != parameters.end())
+    {
+        result = VisionHash::combine(result, VisionHash::hash(imageContext->dump()));
+    }
+
+    return result;
+}
+
+
+std::shared_ptr<const AnnotateImageResponse> VisionCache::find(uint64_t key)
+{
+    auto iter = _index.find(key);
+
+    if (iter != _index.end())
+    {
+        _entries.splice(_entries.begin(), _entries, iter->second);
+        ++_statistics.hits;
+        return iter->second->response;
+    }
+
+    return nullptr;
+}
+
+
+std::shared_ptr<const AnnotateImageResponse> VisionCache::load(uint64_t key) const
+{
+    std::string filename = path(key);
+
+    if (ofFile::doesFileExist(filename, false))
+    {
+        try
+        {
+            ofBuffer buffer = ofBufferFromFile(filename);
+            std::string serialized(buffer.getData(), buffer.size());
+            return std::make_shared<const AnnotateImageResponse>(AnnotateImageResponse::fromJSON(ofJson::parse(serialized)));
+        }
+        catch (const std::exception& exc)
+        {
+            ofLogError("VisionCache::load") << "Unable to load " << filename << ": " << exc.what();
+        }
+    }
+
+    return nullptr;
+}
+
+
+void VisionCache::insert(uint64_t key,
+                         std::shared_ptr<const AnnotateImageResponse> response)
+{
+    auto iter = _index.find(key);
+
+    if (iter != _index.end())
+    {
+        _statistics.bytes -= iter->second->bytes;
+        _entries.erase(iter->second);
+        _index.erase(iter);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.response = response;
+    entry.bytes = response->memoryFootprint();
+
+    _entries.push_front(entry);
+    _index[key] = _entries.begin();
+    _statistics.bytes += entry.bytes;
+
+    while (_statistics.bytes > _settings.maxBytes && _entries.size() > 1)
+    {
+        _statistics.bytes -= _entries.back().bytes;
+        _index.erase(_entries.back().key);
+        _entries.pop_back();
+        ++_statistics.evictions;
+    }
+}
+
+
+void VisionCache::persist(uint64_t key, const std::string& serialized) const
+{
+    if (!ofBufferToFile(path(key), ofBuffer(serialized.data(), serialized.size())))
+    {
+        ofLogError("VisionCache::persist") << "Unable to persist " << path(key);
+    }
+}
+
+
+std::string VisionCache::path(uint64_t key) const
+{
+    std::ostringstream filename;
+    filename << std::hex << std::setw(16) << std::setfill('0') << key << ".json";
+    return ofFilePath::join(_settings.persistencePath, filename.str());
+}
+
+
+} } // namespace ofx::CloudPlatform
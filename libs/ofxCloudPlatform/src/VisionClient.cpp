@@ -6,6 +6,7 @@
 
 
 #include "ofx/CloudPlatform/VisionClient.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
 
 
 namespace ofx {
@@ -25,6 +26,13 @@ std::vector<AnnotateImageResponse> VisionClient::annotate(const VisionRequestIte
 
 
 std::vector<AnnotateImageResponse> VisionClient::annotate(const std::vector<VisionRequestItem>& items)
+{
+    return annotate(items, _retainJSON);
+}
+
+
+std::vector<AnnotateImageResponse> VisionClient::annotate(const std::vector<VisionRequestItem>& items,
+                                                          bool retainJSON)
 {
     VisionRequest request(items);
     auto response = execute(request);
@@ -38,20 +46,37 @@ std::vector<AnnotateImageResponse> VisionClient::annotate(const std::vector<Visi
         
     std::vector<AnnotateImageResponse> responses;
     
-    auto iter = json.cbegin();
-    while (iter != json.cend())
+    auto iter = json.begin();
+    while (iter != json.end())
     {
         const auto& key = iter.key();
-        const auto& value = iter.value();
+        auto& value = iter.value();
         
         if (key == "responses")
         {
-            for (const auto& response: value)
+            for (auto& response: value)
             {
-                responses.push_back(AnnotateImageResponse::fromJSON(response));
+                // Map region of interest coordinates into the full image.
+                glm::vec2 offset(0, 0);
+
+                if (responses.size() < items.size())
+                {
+                    const auto& region = items[responses.size()].region();
+                    offset = glm::vec2(region.x, region.y);
+                }
+
+                if (_lazyDecoding)
+                {
+                    AnnotateImageResponse::translate(response, offset);
+                    responses.push_back(AnnotateImageResponse::fromJSONLazy(std::make_shared<const ofJson>(std::move(response))));
+                }
+                else
+                {
+                    responses.push_back(AnnotateImageResponse::fromJSON(response, offset, retainJSON));
+                }
             }
         }
-        else ofLogWarning("VisionClient::annotate") << "Unknown key: " << key;
+        else VisionParseDiagnostics::unknownKey("BatchAnnotateImagesResponse", key, value);
         
         ++iter;
     }
@@ -60,4 +85,28 @@ std::vector<AnnotateImageResponse> VisionClient::annotate(const std::vector<Visi
 }
     
 
+void VisionClient::setLazyDecoding(bool lazyDecoding)
+{
+    _lazyDecoding = lazyDecoding;
+}
+
+
+bool VisionClient::getLazyDecoding() const
+{
+    return _lazyDecoding;
+}
+
+
+void VisionClient::setRetainJSON(bool retainJSON)
+{
+    _retainJSON = retainJSON;
+}
+
+
+bool VisionClient::getRetainJSON() const
+{
+    return _retainJSON;
+}
+
+
 } } // namespace ofx::CloudPlatform
@@ -0,0 +1,442 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionColumnStore.h"
+#include <algorithm>
+#include <limits>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_CLOUDPLATFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+double VisionColumnStore::Aggregate::mean() const
+{
+    return count > 0 ? sum / count : std::numeric_limits<double>::quiet_NaN();
+}
+
+
+VisionColumnStore::VisionColumnStore()
+{
+}
+
+
+VisionColumnStore::~VisionColumnStore()
+{
+}
+
+
+std::size_t VisionColumnStore::append(const AnnotateImageResponse& response)
+{
+    uint32_t index = static_cast<uint32_t>(size());
+
+    const auto& safeSearch = response.safeSearchAnnotation();
+
+    _responses.faceBegin.push_back(static_cast<uint32_t>(_faces.response.size()));
+    _responses.entityBegin.push_back(static_cast<uint32_t>(_entities.response.size()));
+    _responses.adult.push_back(static_cast<uint8_t>(safeSearch.adult().type()));
+    _responses.spoof.push_back(static_cast<uint8_t>(safeSearch.spoof().type()));
+    _responses.medical.push_back(static_cast<uint8_t>(safeSearch.medical().type()));
+    _responses.violence.push_back(static_cast<uint8_t>(safeSearch.violence().type()));
+    _responses.racy.push_back(static_cast<uint8_t>(safeSearch.racy().type()));
+
+    const float missing = std::numeric_limits<float>::quiet_NaN();
+
+    for (const auto& face: response.faceAnnotations())
+    {
+        _faces.response.push_back(index);
+        _faces.rollAngle.push_back(face.rollAngle());
+        _faces.panAngle.push_back(face.panAngle());
+        _faces.tiltAngle.push_back(face.tiltAngle());
+        _faces.detectionConfidence.push_back(face.detectionConfidence());
+        _faces.landmarkingConfidence.push_back(face.landmarkingConfidence());
+        _faces.joy.push_back(static_cast<uint8_t>(face.joyLikelihood().type()));
+        _faces.sorrow.push_back(static_cast<uint8_t>(face.sorrowLikelihood().type()));
+        _faces.anger.push_back(static_cast<uint8_t>(face.angerLikelihood().type()));
+        _faces.surprise.push_back(static_cast<uint8_t>(face.surpriseLikelihood().type()));
+        _faces.underExposed.push_back(static_cast<uint8_t>(face.underExposedLikelihood().type()));
+        _faces.blurred.push_back(static_cast<uint8_t>(face.blurredLikelihood().type()));
+        _faces.headwear.push_back(static_cast<uint8_t>(face.headwearLikelihood().type()));
+
+        for (std::size_t i = 0; i < NUM_LANDMARK_SLOTS; ++i)
+        {
+            _faces.landmarkX[i].push_back(missing);
+            _faces.landmarkY[i].push_back(missing);
+            _faces.landmarkZ[i].push_back(missing);
+        }
+
+        for (const auto& landmark: face.landmarks())
+        {
+            if (landmark.type() == FaceAnnotation::Landmark::Type::UNKNOWN_LANDMARK)
+            {
+                continue;
+            }
+
+            std::size_t i = slot(landmark.type());
+            _faces.landmarkX[i].back() = landmark.position().x;
+            _faces.landmarkY[i].back() = landmark.position().y;
+            _faces.landmarkZ[i].back() = landmark.position().z;
+        }
+    }
+
+    appendEntities(index, EntityKind::LABEL, response.labelAnnotations());
+    appendEntities(index, EntityKind::LANDMARK, response.landmarkAnnotations());
+    appendEntities(index, EntityKind::LOGO, response.logoAnnotations());
+    appendEntities(index, EntityKind::TEXT, response.textAnnotations());
+
+    return index;
+}
+
+
+void VisionColumnStore::clear()
+{
+    _responses = ResponseColumns();
+    _faces = FaceColumns();
+    _entities = EntityColumns();
+    _mids.clear();
+    _midIndex.clear();
+}
+
+
+std::size_t VisionColumnStore::size() const
+{
+    return _responses.faceBegin.size();
+}
+
+
+const VisionColumnStore::ResponseColumns& VisionColumnStore::responses() const
+{
+    return _responses;
+}
+
+
+const VisionColumnStore::FaceColumns& VisionColumnStore::faces() const
+{
+    return _faces;
+}
+
+
+const VisionColumnStore::EntityColumns& VisionColumnStore::entities() const
+{
+    return _entities;
+}
+
+
+const std::vector<std::string>& VisionColumnStore::mids() const
+{
+    return _mids;
+}
+
+
+bool VisionColumnStore::findMid(const std::string& mid, uint32_t& index) const
+{
+    auto iter = _midIndex.find(mid);
+
+    if (iter != _midIndex.end())
+    {
+        index = iter->second;
+        return true;
+    }
+
+    return false;
+}
+
+
+glm::vec3 VisionColumnStore::landmark(std::size_t face,
+                                      FaceAnnotation::Landmark::Type type) const
+{
+    // UNKNOWN_LANDMARK has no slot; slot() wraps it past the last slot.
+    std::size_t i = slot(type);
+
+    if (i >= NUM_LANDMARK_SLOTS || face >= _faces.landmarkX[0].size())
+    {
+        return glm::vec3(std::numeric_limits<float>::quiet_NaN());
+    }
+
+    return glm::vec3(_faces.landmarkX[i][face],
+                     _faces.landmarkY[i][face],
+                     _faces.landmarkZ[i][face]);
+}
+
+
+std::size_t VisionColumnStore::slot(FaceAnnotation::Landmark::Type type)
+{
+    return static_cast<std::size_t>(type) - 1;
+}
+
+
+std::size_t VisionColumnStore::filter(const std::vector<float>& column,
+                                      float min,
+                                      float max,
+                                      std::vector<uint32_t>& rows)
+{
+    std::size_t count = rows.size();
+    std::size_t size = column.size();
+    const float* values = column.data();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 lower = _mm_set1_ps(min);
+    __m128 upper = _mm_set1_ps(max);
+
+    for (; i + 4 <= size; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(values + i);
+        int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(v, lower),
+                                              _mm_cmple_ps(v, upper)));
+
+        // Most blocks are usually all or nothing.
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+            if (mask & (1 << k))
+            {
+                rows.push_back(static_cast<uint32_t>(i + k));
+            }
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (values[i] >= min && values[i] <= max)
+        {
+            rows.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    return rows.size() - count;
+}
+
+
+std::size_t VisionColumnStore::filter(const std::vector<uint32_t>& column,
+                                      uint32_t value,
+                                      std::vector<uint32_t>& rows)
+{
+    std::size_t count = rows.size();
+    std::size_t size = column.size();
+    const uint32_t* values = column.data();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128i target = _mm_set1_epi32(static_cast<int>(value));
+
+    for (; i + 4 <= size; i += 4)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, target)));
+
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+            if (mask & (1 << k))
+            {
+                rows.push_back(static_cast<uint32_t>(i + k));
+            }
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (values[i] == value)
+        {
+            rows.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    return rows.size() - count;
+}
+
+
+std::size_t VisionColumnStore::filter(const std::vector<uint8_t>& column,
+                                      Likelihood::Type minimum,
+                                      std::vector<uint32_t>& rows)
+{
+    std::size_t count = rows.size();
+    std::size_t size = column.size();
+    const uint8_t* values = column.data();
+    uint8_t threshold = static_cast<uint8_t>(minimum);
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128i target = _mm_set1_epi8(static_cast<char>(threshold));
+
+    for (; i + 16 <= size; i += 16)
+    {
+        // Values are small, so v >= t is max(v, t) == v.
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, target), v));
+
+        if (mask == 0)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 16; ++k)
+        {
+            if (mask & (1 << k))
+            {
+                rows.push_back(static_cast<uint32_t>(i + k));
+            }
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        if (values[i] >= threshold)
+        {
+            rows.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    return rows.size() - count;
+}
+
+
+VisionColumnStore::Aggregate VisionColumnStore::aggregate(const std::vector<float>& column)
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    std::size_t size = column.size();
+    const float* values = column.data();
+    std::size_t i = 0;
+
+    Aggregate result;
+    float min = infinity;
+    float max = -infinity;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 positive = _mm_set1_ps(infinity);
+    __m128 negative = _mm_set1_ps(-infinity);
+    __m128 mins = positive;
+    __m128 maxs = negative;
+    __m128d sumLow = _mm_setzero_pd();
+    __m128d sumHigh = _mm_setzero_pd();
+
+    for (; i + 4 <= size; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(values + i);
+        __m128 ordered = _mm_cmpord_ps(v, v);
+        __m128 zeroed = _mm_and_ps(ordered, v);
+
+        mins = _mm_min_ps(mins, _mm_or_ps(zeroed, _mm_andnot_ps(ordered, positive)));
+        maxs = _mm_max_ps(maxs, _mm_or_ps(zeroed, _mm_andnot_ps(ordered, negative)));
+
+        // Sum in double precision so long columns do not lose accuracy.
+        sumLow = _mm_add_pd(sumLow, _mm_cvtps_pd(zeroed));
+        sumHigh = _mm_add_pd(sumHigh, _mm_cvtps_pd(_mm_movehl_ps(zeroed, zeroed)));
+
+        int mask = _mm_movemask_ps(ordered);
+        result.count += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, mins);
+    min = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, maxs);
+    max = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    double sums[2];
+    _mm_storeu_pd(sums, _mm_add_pd(sumLow, sumHigh));
+    result.sum = sums[0] + sums[1];
+#endif
+
+    for (; i < size; ++i)
+    {
+        float value = values[i];
+
+        if (value == value)
+        {
+            min = std::min(min, value);
+            max = std::max(max, value);
+            result.sum += value;
+            ++result.count;
+        }
+    }
+
+    result.min = result.count > 0 ? min : std::numeric_limits<float>::quiet_NaN();
+    result.max = result.count > 0 ? max : std::numeric_limits<float>::quiet_NaN();
+
+    return result;
+}
+
+
+VisionColumnStore::Aggregate VisionColumnStore::aggregate(const std::vector<float>& column,
+                                                          const std::vector<uint32_t>& rows)
+{
+    Aggregate result;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -min;
+
+    for (auto row: rows)
+    {
+        float value = column[row];
+
+        if (value == value)
+        {
+            min = std::min(min, value);
+            max = std::max(max, value);
+            result.sum += value;
+            ++result.count;
+        }
+    }
+
+    result.min = result.count > 0 ? min : std::numeric_limits<float>::quiet_NaN();
+    result.max = result.count > 0 ? max : std::numeric_limits<float>::quiet_NaN();
+
+    return result;
+}
+
+
+void VisionColumnStore::appendEntities(uint32_t response,
+                                       EntityKind kind,
+                                       const std::vector<EntityAnnotation>& entities)
+{
+    for (const auto& entity: entities)
+    {
+        _entities.response.push_back(response);
+        _entities.kind.push_back(kind);
+        _entities.mid.push_back(intern(entity.mid()));
+        _entities.score.push_back(entity.score());
+        _entities.topicality.push_back(entity.topicality());
+    }
+}
+
+
+uint32_t VisionColumnStore::intern(const std::string& mid)
+{
+    auto iter = _midIndex.find(mid);
+
+    if (iter != _midIndex.end())
+    {
+        return iter->second;
+    }
+
+    uint32_t index = static_cast<uint32_t>(_mids.size());
+    _mids.push_back(mid);
+    _midIndex.emplace(mid, index);
+    return index;
+}
+
+
+} } // namespace ofx::CloudPlatform
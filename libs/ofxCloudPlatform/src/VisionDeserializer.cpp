@@ -6,6 +6,8 @@
 
 
 #include "ofx/CloudPlatform/VisionDeserializer.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
 
 
 namespace ofx {
@@ -25,6 +27,36 @@ bool VisionDeserializer::fromJSON(const ofJson& json, ofPolyline& polyline)
 }
 
 
+namespace {
+
+
+/// \brief Position json keys.
+enum
+{
+    POSITION_X,
+    POSITION_Y,
+    POSITION_Z,
+    NUM_POSITION_KEYS
+};
+
+
+constexpr const char* POSITION_KEY_NAMES[NUM_POSITION_KEYS] =
+{
+    "x",
+    "y",
+    "z"
+};
+
+
+constexpr VisionKeyTable<NUM_POSITION_KEYS> POSITION_KEYS(POSITION_KEY_NAMES);
+
+
+static_assert(POSITION_KEYS.isValid(), "No perfect hash for position keys.");
+
+
+}
+
+
 bool VisionDeserializer::fromJSON(const ofJson& json, glm::vec3& position)
 {
     auto iter = json.cbegin();
@@ -32,10 +64,13 @@ bool VisionDeserializer::fromJSON(const ofJson& json, glm::vec3& position)
     {
         const auto& key = iter.key();
         const auto& value = iter.value();
-        if (key == "x") position.x = value;
-        else if (key == "y") position.y = value;
-        else if (key == "z") position.z = value;
-        else ofLogWarning() << "Unknown key " << key << " - " << json.dump(4);
+        switch (POSITION_KEYS.find(key))
+        {
+            case POSITION_X: position.x = value; break;
+            case POSITION_Y: position.y = value; break;
+            case POSITION_Z: position.z = value; break;
+            default: VisionParseDiagnostics::unknownKey("Position", key, value);
+        }
         ++iter;
     }
 
@@ -43,6 +78,38 @@ bool VisionDeserializer::fromJSON(const ofJson& json, glm::vec3& position)
 }
 
 
+namespace {
+
+
+/// \brief Color json keys.
+enum
+{
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_BLUE,
+    COLOR_ALPHA,
+    NUM_COLOR_KEYS
+};
+
+
+constexpr const char* COLOR_KEY_NAMES[NUM_COLOR_KEYS] =
+{
+    "red",
+    "green",
+    "blue",
+    "alpha"
+};
+
+
+constexpr VisionKeyTable<NUM_COLOR_KEYS> COLOR_KEYS(COLOR_KEY_NAMES);
+
+
+static_assert(COLOR_KEYS.isValid(), "No perfect hash for color keys.");
+
+
+}
+
+
 bool VisionDeserializer::fromJSON(const ofJson& json, ofColor& color)
 {
     auto iter = json.cbegin();
@@ -50,11 +117,14 @@ bool VisionDeserializer::fromJSON(const ofJson& json, ofColor& color)
     {
         const auto& key = iter.key();
         const auto& value = iter.value();
-        if (key == "red") color.r = value;
-        else if (key == "green") color.g = value;
-        else if (key == "blue") color.b = value;
-        else if (key == "alpha") color.a = value;
-        else ofLogWarning() << "Unknown key " << key << " - " << json.dump(4);
+        switch (COLOR_KEYS.find(key))
+        {
+            case COLOR_RED: color.r = value; break;
+            case COLOR_GREEN: color.g = value; break;
+            case COLOR_BLUE: color.b = value; break;
+            case COLOR_ALPHA: color.a = value; break;
+            default: VisionParseDiagnostics::unknownKey("Color", key, value);
+        }
         ++iter;
     }
     
@@ -62,4 +132,39 @@ bool VisionDeserializer::fromJSON(const ofJson& json, ofColor& color)
 }
 
 
+std::size_t VisionDeserializer::memoryFootprint(const ofJson& json)
+{
+    // Estimate a tree node's overhead as three pointers and a color.
+    const std::size_t NODE_SIZE = 4 * sizeof(void*);
+
+    std::size_t size = sizeof(ofJson);
+
+    if (json.is_object())
+    {
+        size += sizeof(ofJson::object_t);
+
+        for (auto iter = json.cbegin(); iter != json.cend(); ++iter)
+        {
+            size += NODE_SIZE + sizeof(std::string) + iter.key().capacity();
+            size += memoryFootprint(iter.value());
+        }
+    }
+    else if (json.is_array())
+    {
+        size += sizeof(ofJson::array_t);
+
+        for (const auto& value: json)
+        {
+            size += memoryFootprint(value);
+        }
+    }
+    else if (json.is_string())
+    {
+        size += sizeof(std::string) + json.get_ref<const std::string&>().capacity();
+    }
+
+    return size;
+}
+
+
 } } // namespace ofx::CloudPlatform
@@ -0,0 +1,520 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionFaceTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief The cost of a pair that must not be matched.
+constexpr float INFEASIBLE = 1e6f;
+
+
+/// \brief The number of bounding poly points before the landmarks.
+constexpr std::size_t POLY_POINTS = 8;
+
+
+/// \brief Append the four vertices of a bounding poly.
+///
+/// A poly with fewer vertices repeats its last vertex, as VisionQuads::add().
+void addQuad(const ofPolyline& polyline, std::vector<glm::vec3>& points)
+{
+    const auto& vertices = polyline.getVertices();
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        if (!vertices.empty())
+        {
+            points.push_back(vertices[std::min(c, vertices.size() - 1)]);
+        }
+        else
+        {
+            points.push_back(glm::vec3(0, 0, 0));
+        }
+    }
+}
+
+
+/// \brief Set the vertices of a bounding poly, keeping its vertex count.
+void setQuad(const glm::vec3* points, ofPolyline& polyline)
+{
+    auto& vertices = polyline.getVertices();
+
+    for (std::size_t c = 0; c < std::min<std::size_t>(4, vertices.size()); ++c)
+    {
+        vertices[c] = points[c];
+    }
+}
+
+
+} // namespace
+
+
+VisionFaceTracker::VisionFaceTracker(): VisionFaceTracker(Settings())
+{
+}
+
+
+VisionFaceTracker::VisionFaceTracker(const Settings& settings):
+    _settings(settings)
+{
+}
+
+
+VisionFaceTracker::~VisionFaceTracker()
+{
+}
+
+
+std::vector<uint64_t> VisionFaceTracker::update(const AnnotateImageResponse& response,
+                                                uint64_t timestamp)
+{
+    if (!_states.empty() && timestamp < _timestamp)
+    {
+        return std::vector<uint64_t>();
+    }
+
+    _timestamp = timestamp;
+
+    const auto& faces = response.faceAnnotations();
+    std::vector<uint64_t> ids(faces.size(), 0);
+    std::vector<bool> matched(_states.size(), false);
+
+    std::size_t rows = _states.size();
+    std::size_t columns = faces.size();
+
+    if (rows > 0 && columns > 0)
+    {
+        VisionQuads quads;
+        quads.reserve(columns);
+
+        std::vector<std::vector<glm::vec3>> facePoints(columns);
+
+        for (std::size_t c = 0; c < columns; ++c)
+        {
+            quads.add(faces[c].boundingPoly());
+            points(faces[c], facePoints[c]);
+        }
+
+        std::vector<float> areas(columns);
+        quads.areas(areas.data());
+
+        std::vector<float> costs(rows * columns, INFEASIBLE);
+        std::vector<float> iou(columns);
+        std::vector<glm::vec3> predicted;
+
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            const State& state = _states[r];
+            predict(state, timestamp, _settings.maxPrediction, predicted);
+
+            VisionQuads::Quad quad;
+
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                quad[c] = glm::vec2(predicted[c].x, predicted[c].y);
+            }
+
+            quads.iou(quad, iou.data());
+
+            for (std::size_t c = 0; c < columns; ++c)
+            {
+                // The mean landmark distance relative to the face size, or
+                // infinity if the landmarks cannot be compared.
+                float distance = std::numeric_limits<float>::infinity();
+                std::size_t landmarks = predicted.size() - POLY_POINTS;
+
+                if (landmarks > 0 && sameLandmarks(state.track.face, faces[c]))
+                {
+                    float sum = 0;
+
+                    for (std::size_t k = POLY_POINTS; k < predicted.size(); ++k)
+                    {
+                        float dx = predicted[k].x - facePoints[c][k].x;
+                        float dy = predicted[k].y - facePoints[c][k].y;
+                        sum += std::sqrt(dx * dx + dy * dy);
+                    }
+
+                    distance = sum / (landmarks * std::max(1.0f, std::sqrt(areas[c])));
+                }
+
+                if (iou[c] < _settings.minIoU && distance > _settings.maxLandmarkDistance)
+                {
+                    continue;
+                }
+
+                float cost = 1 - iou[c] + _settings.landmarkWeight * std::min(1.0f, distance);
+
+                costs[r * columns + c] = cost;
+            }
+        }
+
+        std::vector<std::size_t> assignment = assign(costs, rows, columns);
+
+        for (std::size_t r = 0; r < rows; ++r)
+        {
+            std::size_t c = assignment[r];
+
+            if (c < columns && costs[r * columns + c] < INFEASIBLE)
+            {
+                observe(_states[r], faces[c], timestamp);
+                ids[c] = _states[r].track.id;
+                matched[r] = true;
+            }
+        }
+    }
+
+    // Age the unmatched tracks and remove the lost ones.
+    std::size_t kept = 0;
+
+    for (std::size_t r = 0; r < _states.size(); ++r)
+    {
+        if (!matched[r] && ++_states[r].track.misses > _settings.maxMisses)
+        {
+            continue;
+        }
+
+        if (kept != r)
+        {
+            _states[kept] = std::move(_states[r]);
+        }
+
+        ++kept;
+    }
+
+    _states.resize(kept);
+
+    // Unmatched faces start new tracks.
+    for (std::size_t c = 0; c < columns; ++c)
+    {
+        if (ids[c] == 0)
+        {
+            State state;
+            state.track.id = _nextId++;
+            observe(state, faces[c], timestamp);
+            ids[c] = state.track.id;
+            _states.push_back(std::move(state));
+        }
+    }
+
+    return ids;
+}
+
+
+std::vector<VisionFaceTracker::Track> VisionFaceTracker::tracks() const
+{
+    std::vector<Track> tracks;
+    tracks.reserve(_states.size());
+
+    for (const auto& state: _states)
+    {
+        tracks.push_back(state.track);
+    }
+
+    return tracks;
+}
+
+
+std::vector<VisionFaceTracker::Track> VisionFaceTracker::faces(uint64_t timestamp) const
+{
+    std::vector<Track> tracks;
+    tracks.reserve(_states.size());
+
+    std::vector<glm::vec3> predicted;
+
+    for (const auto& state: _states)
+    {
+        tracks.push_back(state.track);
+        predict(state, timestamp, _settings.maxPrediction, predicted);
+        apply(predicted, tracks.back().face);
+    }
+
+    return tracks;
+}
+
+
+bool VisionFaceTracker::face(uint64_t id, uint64_t timestamp, Track& track) const
+{
+    for (const auto& state: _states)
+    {
+        if (state.track.id == id)
+        {
+            std::vector<glm::vec3> predicted;
+            predict(state, timestamp, _settings.maxPrediction, predicted);
+            track = state.track;
+            apply(predicted, track.face);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void VisionFaceTracker::clear()
+{
+    _states.clear();
+    _timestamp = 0;
+}
+
+
+std::size_t VisionFaceTracker::size() const
+{
+    return _states.size();
+}
+
+
+std::vector<std::size_t> VisionFaceTracker::assign(const std::vector<float>& costs,
+                                                   std::size_t rows,
+                                                   std::size_t columns)
+{
+    std::vector<std::size_t> assignment(rows, columns);
+
+    if (rows == 0 || columns == 0)
+    {
+        return assignment;
+    }
+
+    // The method assigns every row of an n x m matrix with n <= m, so a
+    // tall matrix is solved transposed.
+    bool transposed = rows > columns;
+    std::size_t n = transposed ? columns : rows;
+    std::size_t m = transposed ? rows : columns;
+
+    auto cost = [&](std::size_t i, std::size_t j) {
+        return transposed ? costs[j * columns + i] : costs[i * columns + j];
+    };
+
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // Potentials u and v, 1-based with 0 as a virtual start column.
+    std::vector<double> u(n + 1, 0);
+    std::vector<double> v(m + 1, 0);
+    std::vector<double> minimum(m + 1);
+    std::vector<std::size_t> match(m + 1, 0);
+    std::vector<std::size_t> way(m + 1, 0);
+    std::vector<bool> used(m + 1);
+
+    for (std::size_t i = 1; i <= n; ++i)
+    {
+        match[0] = i;
+        std::size_t j0 = 0;
+        std::fill(minimum.begin(), minimum.end(), infinity);
+        std::fill(used.begin(), used.end(), false);
+
+        // Grow an alternating tree from row i until it reaches a free column.
+        do
+        {
+            used[j0] = true;
+            std::size_t i0 = match[j0];
+            double delta = infinity;
+            std::size_t j1 = 0;
+
+            for (std::size_t j = 1; j <= m; ++j)
+            {
+                if (!used[j])
+                {
+                    double reduced = cost(i0 - 1, j - 1) - u[i0] - v[j];
+
+                    if (reduced < minimum[j])
+                    {
+                        minimum[j] = reduced;
+                        way[j] = j0;
+                    }
+
+                    if (minimum[j] < delta)
+                    {
+                        delta = minimum[j];
+                        j1 = j;
+                    }
+                }
+            }
+
+            for (std::size_t j = 0; j <= m; ++j)
+            {
+                if (used[j])
+                {
+                    u[match[j]] += delta;
+                    v[j] -= delta;
+                }
+                else
+                {
+                    minimum[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+        }
+        while (match[j0] != 0);
+
+        // Augment along the path.
+        do
+        {
+            std::size_t j1 = way[j0];
+            match[j0] = match[j1];
+            j0 = j1;
+        }
+        while (j0 != 0);
+    }
+
+    for (std::size_t j = 1; j <= m; ++j)
+    {
+        if (match[j] != 0)
+        {
+            if (transposed)
+            {
+                assignment[j - 1] = match[j] - 1;
+            }
+            else
+            {
+                assignment[match[j] - 1] = j - 1;
+            }
+        }
+    }
+
+    return assignment;
+}
+
+
+void VisionFaceTracker::points(const FaceAnnotation& face,
+                               std::vector<glm::vec3>& points)
+{
+    points.clear();
+    points.reserve(POLY_POINTS + face.landmarks().size());
+
+    addQuad(face.boundingPoly(), points);
+    addQuad(face.fdBoundingPoly(), points);
+
+    for (const auto& landmark: face.landmarks())
+    {
+        points.push_back(landmark.position());
+    }
+}
+
+
+void VisionFaceTracker::predict(const State& state,
+                                uint64_t timestamp,
+                                uint64_t maxPrediction,
+                                std::vector<glm::vec3>& points)
+{
+    points = state.points;
+
+    uint64_t last = state.track.timestamp;
+    uint64_t previous = state.previousTimestamp;
+
+    if (timestamp > last)
+    {
+        float seconds = std::min(timestamp - last, maxPrediction) / 1000000.0f;
+
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            points[i] += state.velocity[i] * seconds;
+        }
+    }
+    else if (timestamp <= previous)
+    {
+        points = state.previousPoints;
+    }
+    else if (timestamp < last)
+    {
+        float t = float(timestamp - previous) / float(last - previous);
+
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            points[i] = state.previousPoints[i] + (state.points[i] - state.previousPoints[i]) * t;
+        }
+    }
+}
+
+
+void VisionFaceTracker::apply(const std::vector<glm::vec3>& points,
+                              FaceAnnotation& face)
+{
+    setQuad(points.data(), face._boundingPoly);
+    setQuad(points.data() + 4, face._fdBoundingPoly);
+
+    for (std::size_t k = 0; k < face._landmarks.size(); ++k)
+    {
+        face._landmarks[k] = FaceAnnotation::Landmark(face._landmarks[k].type(),
+                                                      points[POLY_POINTS + k]);
+    }
+}
+
+
+bool VisionFaceTracker::sameLandmarks(const FaceAnnotation& a,
+                                      const FaceAnnotation& b)
+{
+    const auto& x = a.landmarks();
+    const auto& y = b.landmarks();
+
+    if (x.size() != y.size())
+    {
+        return false;
+    }
+
+    for (std::size_t k = 0; k < x.size(); ++k)
+    {
+        if (x[k].type() != y[k].type())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void VisionFaceTracker::observe(State& state,
+                                const FaceAnnotation& face,
+                                uint64_t timestamp)
+{
+    std::vector<glm::vec3> current;
+    points(face, current);
+
+    if (state.track.observations > 0
+        && timestamp > state.track.timestamp
+        && sameLandmarks(state.track.face, face))
+    {
+        float seconds = (timestamp - state.track.timestamp) / 1000000.0f;
+
+        // The first estimate is taken as is, later ones are smoothed.
+        float weight = state.track.observations > 1 ? _settings.velocitySmoothing : 1.0f;
+
+        for (std::size_t i = 0; i < current.size(); ++i)
+        {
+            glm::vec3 velocity = (current[i] - state.points[i]) * (1.0f / seconds);
+            state.velocity[i] = state.velocity[i] * (1.0f - weight) + velocity * weight;
+        }
+
+        state.previousPoints = std::move(state.points);
+        state.previousTimestamp = state.track.timestamp;
+    }
+    else
+    {
+        // The points cannot be compared, so motion starts over.
+        state.velocity.assign(current.size(), glm::vec3(0, 0, 0));
+        state.previousPoints = current;
+        state.previousTimestamp = timestamp;
+    }
+
+    state.points = std::move(current);
+    state.track.face = face;
+    state.track.timestamp = timestamp;
+    state.track.observations++;
+    state.track.misses = 0;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,384 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionFrameCache.h"
+#include <algorithm>
+#include <bitset>
+#include <set>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+double VisionFrameCache::Statistics::hitRate() const
+{
+    uint64_t total = hits + misses;
+    return total > 0 ? double(hits) / total : 0.0;
+}
+
+
+double VisionFrameCache::Statistics::falseReuseRate() const
+{
+    return verifications > 0 ? double(falseReuses) / verifications : 0.0;
+}
+
+
+VisionFrameCache::VisionFrameCache(): VisionFrameCache(Settings())
+{
+}
+
+
+VisionFrameCache::VisionFrameCache(const Settings& settings):
+    _settings(settings),
+    _template(std::make_shared<VisionRequestTemplate>(settings.features))
+{
+    _settings.maxDistance = std::max(0, std::min(_settings.maxDistance, int(MAX_DISTANCE_LIMIT)));
+    _settings.capacity = std::max(std::size_t(1), _settings.capacity);
+    _chunkIndex.resize(_settings.maxDistance + 1);
+}
+
+
+VisionFrameCache::~VisionFrameCache()
+{
+}
+
+
+AnnotateImageResponse VisionFrameCache::annotate(VisionClient& client,
+                                                 const ofPixels& pixels)
+{
+    uint64_t hash = 0;
+
+    if (!dHash(pixels, hash))
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_statistics.bypasses;
+        }
+
+        auto responses = client.annotate(VisionRequestItem(pixels, _template));
+
+        if (responses.empty())
+        {
+            throw Poco::Net::HTTPException("No response.");
+        }
+
+        return responses.front();
+    }
+
+    std::shared_ptr<const AnnotateImageResponse> cached;
+    bool verify = false;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        const Entry* entry = findNearest(hash);
+
+        if (entry)
+        {
+            cached = entry->response;
+            ++_statistics.hits;
+
+            if (_settings.verificationInterval > 0
+            && _statistics.hits % _settings.verificationInterval == 0)
+            {
+                verify = true;
+            }
+        }
+        else
+        {
+            ++_statistics.misses;
+        }
+    }
+
+    if (cached && !verify)
+    {
+        return *cached;
+    }
+
+    auto responses = client.annotate(VisionRequestItem(pixels, _template));
+
+    if (responses.empty())
+    {
+        throw Poco::Net::HTTPException("No response.");
+    }
+
+    auto response = std::make_shared<const AnnotateImageResponse>(responses.front());
+
+    // A transient error must not be reused by similar frames, nor count
+    // against the cached response.
+    if (response->hasError())
+    {
+        return *response;
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (verify)
+    {
+        ++_statistics.verifications;
+
+        if (!isEquivalent(*cached, *response))
+        {
+            ++_statistics.falseReuses;
+        }
+    }
+
+    insertEntry(hash, response);
+
+    return *response;
+}
+
+
+bool VisionFrameCache::find(uint64_t hash, AnnotateImageResponse& response)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    const Entry* entry = findNearest(hash);
+
+    if (entry)
+    {
+        response = *entry->response;
+        return true;
+    }
+
+    return false;
+}
+
+
+void VisionFrameCache::insert(uint64_t hash, const AnnotateImageResponse& response)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    insertEntry(hash, std::make_shared<const AnnotateImageResponse>(response));
+}
+
+
+void VisionFrameCache::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _entries.clear();
+
+    for (auto& index: _chunkIndex)
+    {
+        index.clear();
+    }
+}
+
+
+VisionFrameCache::Statistics VisionFrameCache::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+
+bool VisionFrameCache::dHash(const ofPixels& pixels, uint64_t& hash)
+{
+    const std::size_t GRID_WIDTH = 9;
+    const std::size_t GRID_HEIGHT = 8;
+
+    // Sample at most this many pixels per cell in each direction.
+    const std::size_t MAX_SAMPLES = 8;
+
+    std::size_t width = pixels.getWidth();
+    std::size_t height = pixels.getHeight();
+    std::size_t channels = pixels.getNumChannels();
+    std::size_t stride = pixels.getBytesStride();
+
+    if (width < GRID_WIDTH || height < GRID_HEIGHT || channels == 0)
+    {
+        return false;
+    }
+
+    const unsigned char* data = pixels.getData();
+
+    uint32_t cells[GRID_HEIGHT][GRID_WIDTH];
+
+    for (std::size_t cy = 0; cy < GRID_HEIGHT; ++cy)
+    {
+        std::size_t y0 = cy * height / GRID_HEIGHT;
+        std::size_t y1 = (cy + 1) * height / GRID_HEIGHT;
+        std::size_t yStep = std::max(std::size_t(1), (y1 - y0) / MAX_SAMPLES);
+
+        for (std::size_t cx = 0; cx < GRID_WIDTH; ++cx)
+        {
+            std::size_t x0 = cx * width / GRID_WIDTH;
+            std::size_t x1 = (cx + 1) * width / GRID_WIDTH;
+            std::size_t xStep = std::max(std::size_t(1), (x1 - x0) / MAX_SAMPLES);
+
+            uint32_t sum = 0;
+            uint32_t count = 0;
+
+            for (std::size_t y = y0; y < y1; y += yStep)
+            {
+                const unsigned char* row = data + y * stride;
+
+                for (std::size_t x = x0; x < x1; x += xStep)
+                {
+                    const unsigned char* p = row + x * channels;
+
+                    if (channels >= 3)
+                    {
+                        sum += (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+                    }
+                    else
+                    {
+                        sum += p[0];
+                    }
+
+                    ++count;
+                }
+            }
+
+            cells[cy][cx] = count > 0 ? sum / count : 0;
+        }
+    }
+
+    hash = 0;
+
+    for (std::size_t y = 0; y < GRID_HEIGHT; ++y)
+    {
+        for (std::size_t x = 0; x < GRID_WIDTH - 1; ++x)
+        {
+            if (cells[y][x] > cells[y][x + 1])
+            {
+                hash |= uint64_t(1) << (y * (GRID_WIDTH - 1) + x);
+            }
+        }
+    }
+
+    return true;
+}
+
+
+int VisionFrameCache::distance(uint64_t a, uint64_t b)
+{
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+
+bool VisionFrameCache::isEquivalent(const AnnotateImageResponse& a,
+                                    const AnnotateImageResponse& b)
+{
+    if (a.faceAnnotations().size() != b.faceAnnotations().size()
+    ||  a.logoAnnotations().size() != b.logoAnnotations().size()
+    ||  a.landmarkAnnotations().size() != b.landmarkAnnotations().size())
+    {
+        return false;
+    }
+
+    std::set<std::string> labelsA;
+    std::set<std::string> labelsB;
+
+    for (const auto& label: a.labelAnnotations()) labelsA.insert(label.mid());
+    for (const auto& label: b.labelAnnotations()) labelsB.insert(label.mid());
+
+    if (labelsA.empty() && labelsB.empty())
+    {
+        return true;
+    }
+
+    std::size_t common = 0;
+
+    for (const auto& label: labelsA)
+    {
+        common += labelsB.count(label);
+    }
+
+    std::size_t total = labelsA.size() + labelsB.size() - common;
+
+    // Require a Jaccard similarity of at least one half.
+    return 2 * common >= total;
+}
+
+
+uint64_t VisionFrameCache::chunk(uint64_t hash, std::size_t i) const
+{
+    std::size_t chunks = _chunkIndex.size();
+    std::size_t begin = i * 64 / chunks;
+    std::size_t end = (i + 1) * 64 / chunks;
+    std::size_t bits = end - begin;
+
+    uint64_t mask = bits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << bits) - 1);
+
+    return (hash >> begin) & mask;
+}
+
+
+const VisionFrameCache::Entry* VisionFrameCache::findNearest(uint64_t hash) const
+{
+    if (_entries.empty())
+    {
+        return nullptr;
+    }
+
+    uint64_t firstId = _entries.front().id;
+
+    const Entry* nearest = nullptr;
+    int nearestDistance = _settings.maxDistance + 1;
+
+    for (std::size_t i = 0; i < _chunkIndex.size(); ++i)
+    {
+        auto range = _chunkIndex[i].equal_range(chunk(hash, i));
+
+        for (auto iter = range.first; iter != range.second; ++iter)
+        {
+            const Entry& entry = _entries[iter->second - firstId];
+            int d = distance(hash, entry.hash);
+
+            // Prefer the closest, then the most recent frame.
+            if (d < nearestDistance || (d == nearestDistance && nearest && entry.id > nearest->id))
+            {
+                nearest = &entry;
+                nearestDistance = d;
+            }
+        }
+    }
+
+    return nearest;
+}
+
+
+void VisionFrameCache::insertEntry(uint64_t hash,
+                                   std::shared_ptr<const AnnotateImageResponse> response)
+{
+    while (_entries.size() >= _settings.capacity)
+    {
+        const Entry& oldest = _entries.front();
+
+        for (std::size_t i = 0; i < _chunkIndex.size(); ++i)
+        {
+            auto range = _chunkIndex[i].equal_range(chunk(oldest.hash, i));
+
+            for (auto iter = range.first; iter != range.second; ++iter)
+            {
+                if (iter->second == oldest.id)
+                {
+                    _chunkIndex[i].erase(iter);
+                    break;
+                }
+            }
+        }
+
+        _entries.pop_front();
+    }
+
+    Entry entry;
+    entry.id = _nextId++;
+    entry.hash = hash;
+    entry.response = response;
+
+    for (std::size_t i = 0; i < _chunkIndex.size(); ++i)
+    {
+        _chunkIndex[i].insert(std::make_pair(chunk(hash, i), entry.id));
+    }
+
+    _entries.push_back(entry);
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,150 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionHash.h"
+#include <cstring>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+const std::uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const std::uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const std::uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+const std::uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const std::uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+
+inline std::uint64_t rotl(std::uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+
+// Reads are little endian, which matches all supported targets.
+inline std::uint64_t read64(const std::uint8_t* p)
+{
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+inline std::uint32_t read32(const std::uint8_t* p)
+{
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+
+inline std::uint64_t round(std::uint64_t accumulator, std::uint64_t input)
+{
+    accumulator += input * PRIME64_2;
+    accumulator = rotl(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+
+inline std::uint64_t mergeRound(std::uint64_t accumulator, std::uint64_t value)
+{
+    accumulator ^= round(0, value);
+    return accumulator * PRIME64_1 + PRIME64_4;
+}
+
+
+} // namespace
+
+
+std::uint64_t VisionHash::hash(const void* data,
+                               std::size_t size,
+                               std::uint64_t seed)
+{
+    const std::uint8_t* p = static_cast<const std::uint8_t*>(data);
+    const std::uint8_t* end = p + size;
+
+    std::uint64_t h = 0;
+
+    if (size >= 32)
+    {
+        const std::uint8_t* limit = end - 32;
+
+        std::uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        std::uint64_t v2 = seed + PRIME64_2;
+        std::uint64_t v3 = seed;
+        std::uint64_t v4 = seed - PRIME64_1;
+
+        do
+        {
+            v1 = round(v1, read64(p)); p += 8;
+            v2 = round(v2, read64(p)); p += 8;
+            v3 = round(v3, read64(p)); p += 8;
+            v4 = round(v4, read64(p)); p += 8;
+        }
+        while (p <= limit);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = mergeRound(h, v1);
+        h = mergeRound(h, v2);
+        h = mergeRound(h, v3);
+        h = mergeRound(h, v4);
+    }
+    else
+    {
+        h = seed + PRIME64_5;
+    }
+
+    h += static_cast<std::uint64_t>(size);
+
+    while (p + 8 <= end)
+    {
+        h ^= round(0, read64(p));
+        h = rotl(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+
+    if (p + 4 <= end)
+    {
+        h ^= static_cast<std::uint64_t>(read32(p)) * PRIME64_1;
+        h = rotl(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+
+    while (p < end)
+    {
+        h ^= (*p) * PRIME64_5;
+        h = rotl(h, 11) * PRIME64_1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+
+std::uint64_t VisionHash::hash(const std::string& text, std::uint64_t seed)
+{
+    return hash(text.data(), text.size(), seed);
+}
+
+
+std::uint64_t VisionHash::combine(std::uint64_t seed, std::uint64_t value)
+{
+    return mergeRound(seed, value);
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionImageContent.h"
+#include <algorithm>
+#include "ofx/CloudPlatform/Base64.h"
+#include "Poco/File.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+VisionImageContent::~VisionImageContent()
+{
+}
+
+
+std::size_t VisionImageContent::base64Size() const
+{
+    return Base64::encodedSize(size());
+}
+
+
+void VisionImageContent::writeBase64(std::ostream& output) const
+{
+    // Input chunks are a multiple of 3 so padding only occurs at the end.
+    const std::size_t CHUNK_SIZE = 3 * 4096;
+    char encoded[4 * 4096];
+
+    const char* input = data();
+    std::size_t remaining = size();
+
+    while (remaining > 0)
+    {
+        std::size_t count = std::min(remaining, CHUNK_SIZE);
+        output.write(encoded, Base64::encode(input, count, encoded));
+        input += count;
+        remaining -= count;
+    }
+}
+
+
+std::string VisionImageContent::toBase64() const
+{
+    return Base64::encode(data(), size());
+}
+
+
+BufferImageContent::BufferImageContent(const ofBuffer& buffer):
+    _buffer(buffer)
+{
+}
+
+
+BufferImageContent::BufferImageContent(ofBuffer&& buffer):
+    _buffer(std::move(buffer))
+{
+}
+
+
+BufferImageContent::~BufferImageContent()
+{
+}
+
+
+const char* BufferImageContent::data() const
+{
+    return _buffer.getData();
+}
+
+
+std::size_t BufferImageContent::size() const
+{
+    return _buffer.size();
+}
+
+
+MappedFileImageContent::MappedFileImageContent(const std::string& path):
+    _path(ofToDataPath(path, true))
+{
+    Poco::File file(_path);
+
+    _size = static_cast<std::size_t>(file.getSize());
+
+    // Empty files cannot be mapped.
+    if (_size > 0)
+    {
+        _memory.reset(new Poco::SharedMemory(file, Poco::SharedMemory::AM_READ));
+    }
+}
+
+
+MappedFileImageContent::~MappedFileImageContent()
+{
+}
+
+
+const char* MappedFileImageContent::data() const
+{
+    return _memory ? _memory->begin() : nullptr;
+}
+
+
+std::size_t MappedFileImageContent::size() const
+{
+    return _size;
+}
+
+
+const std::string& MappedFileImageContent::path() const
+{
+    return _path;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,184 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionImageEncoder.h"
+#include <algorithm>
+#include "FreeImage.h"
+#include "ofLog.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+int toFreeImageFlags(int quality, VisionImageEncoder::ChromaSubsampling subsampling)
+{
+    int flags = quality;
+
+    switch (subsampling)
+    {
+        case VisionImageEncoder::ChromaSubsampling::CHROMA_444:
+            flags |= JPEG_SUBSAMPLING_444;
+            break;
+        case VisionImageEncoder::ChromaSubsampling::CHROMA_422:
+            flags |= JPEG_SUBSAMPLING_422;
+            break;
+        case VisionImageEncoder::ChromaSubsampling::CHROMA_420:
+            flags |= JPEG_SUBSAMPLING_420;
+            break;
+        case VisionImageEncoder::ChromaSubsampling::CHROMA_411:
+            flags |= JPEG_SUBSAMPLING_411;
+            break;
+    }
+
+    return flags;
+}
+
+
+} // namespace
+
+
+VisionImageEncoder::VisionImageEncoder():
+    _best(FreeImage_OpenMemory()),
+    _current(FreeImage_OpenMemory())
+{
+}
+
+
+VisionImageEncoder::~VisionImageEncoder()
+{
+    FreeImage_CloseMemory(_best);
+    FreeImage_CloseMemory(_current);
+}
+
+
+VisionImageEncoder::Result VisionImageEncoder::encode(const ofPixels& pixels,
+                                                      const Settings& settings,
+                                                      ofBuffer& buffer)
+{
+    Result result;
+
+    if (!pixels.isAllocated())
+    {
+        ofLogError("VisionImageEncoder::encode") << "Pixels are not allocated.";
+        buffer.clear();
+        return result;
+    }
+
+    // Convert once and reuse the bitmap for every attempt.
+    _pixels = pixels;
+
+    if (_pixels.getNumChannels() == 4)
+    {
+        _pixels.setNumChannels(3);
+    }
+
+#ifdef TARGET_LITTLE_ENDIAN
+    if (_pixels.getNumChannels() == 3)
+    {
+        _pixels.swapRgb();
+    }
+#endif
+
+    FIBITMAP* bitmap = FreeImage_ConvertFromRawBits(_pixels.getData(),
+                                                    _pixels.getWidth(),
+                                                    _pixels.getHeight(),
+                                                    _pixels.getBytesStride(),
+                                                    _pixels.getBitsPerPixel(),
+                                                    FI_RGBA_RED_MASK,
+                                                    FI_RGBA_GREEN_MASK,
+                                                    FI_RGBA_BLUE_MASK,
+                                                    true);
+
+    if (bitmap == nullptr)
+    {
+        ofLogError("VisionImageEncoder::encode") << "Unable to convert pixels.";
+        buffer.clear();
+        return result;
+    }
+
+    int minQuality = std::max(1, std::min(settings.minQuality, 100));
+    int maxQuality = std::max(minQuality, std::min(settings.maxQuality, 100));
+
+    bool hasBest = false;
+
+    for (auto subsampling: settings.chromaSubsampling)
+    {
+        int low = minQuality;
+        int high = maxQuality;
+
+        while (low <= high && result.attempts < settings.maxAttempts)
+        {
+            int quality = (low + high + 1) / 2;
+
+            FreeImage_SeekMemory(_current, 0, SEEK_SET);
+
+            if (!FreeImage_SaveToMemory(FIF_JPEG,
+                                        bitmap,
+                                        _current,
+                                        toFreeImageFlags(quality, subsampling)))
+            {
+                ofLogError("VisionImageEncoder::encode") << "Unable to encode JPEG.";
+                break;
+            }
+
+            ++result.attempts;
+
+            std::size_t size = FreeImage_TellMemory(_current);
+            bool withinBudget = size <= settings.targetBytes;
+
+            // Prefer the largest encoding within budget, otherwise the smallest.
+            if (!hasBest
+            || (withinBudget && (!result.withinBudget || size > result.size))
+            || (!withinBudget && !result.withinBudget && size < result.size))
+            {
+                std::swap(_best, _current);
+                hasBest = true;
+                result.size = size;
+                result.quality = quality;
+                result.chromaSubsampling = subsampling;
+                result.withinBudget = withinBudget;
+            }
+
+            if (withinBudget)
+            {
+                low = quality + 1;
+            }
+            else
+            {
+                high = quality - 1;
+            }
+        }
+
+        if (result.withinBudget || result.attempts >= settings.maxAttempts)
+        {
+            break;
+        }
+    }
+
+    FreeImage_Unload(bitmap);
+
+    if (hasBest)
+    {
+        BYTE* data = nullptr;
+        DWORD size = 0;
+        FreeImage_AcquireMemory(_best, &data, &size);
+        buffer.set(reinterpret_cast<const char*>(data), result.size);
+    }
+    else
+    {
+        buffer.clear();
+    }
+
+    return result;
+}
+
+
+} } // namespace ofx::CloudPlatform
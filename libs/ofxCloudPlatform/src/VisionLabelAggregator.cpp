@@ -0,0 +1,392 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionLabelAggregator.h"
+#include <algorithm>
+#include "ofx/CloudPlatform/VisionHash.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+VisionLabelAggregator::VisionLabelAggregator():
+    VisionLabelAggregator(Settings())
+{
+}
+
+
+VisionLabelAggregator::VisionLabelAggregator(const Settings& settings):
+    _settings(settings)
+{
+    _settings.buckets = std::max(std::size_t(1), _settings.buckets);
+    _settings.width = std::max(std::size_t(1), _settings.width);
+    _settings.depth = std::max(std::size_t(1), _settings.depth);
+    _settings.capacity = std::max(std::size_t(1), _settings.capacity);
+    _interval = std::max(uint64_t(1), _settings.window / _settings.buckets);
+
+    std::size_t sketch = _settings.width * _settings.depth;
+    _buckets.resize(_settings.buckets * sketch, 0);
+    _window.resize(sketch, 0);
+    _totals.resize(_settings.buckets, 0);
+    _candidates.reserve(_settings.capacity);
+    _positions.reserve(_settings.capacity);
+}
+
+
+VisionLabelAggregator::~VisionLabelAggregator()
+{
+}
+
+
+void VisionLabelAggregator::add(const AnnotateImageResponse& response,
+                                uint64_t timestamp)
+{
+    for (const auto& label: response.labelAnnotations())
+    {
+        add(label, timestamp);
+    }
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _statistics.responses++;
+}
+
+
+void VisionLabelAggregator::add(const EntityAnnotation& label,
+                                uint64_t timestamp)
+{
+    if (label.score() < _settings.minScore)
+    {
+        return;
+    }
+
+    add(label.mid(),
+        label.description(),
+        _settings.weighted ? label.score() : 1.0f,
+        timestamp);
+}
+
+
+void VisionLabelAggregator::add(const std::string& mid,
+                                const std::string& description,
+                                float weight,
+                                uint64_t timestamp)
+{
+    uint64_t key = VisionHash::hash(mid);
+    uint64_t epoch = timestamp / _interval;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (epoch > _epoch)
+    {
+        advanceTo(epoch);
+    }
+    else if (epoch + _settings.buckets <= _epoch)
+    {
+        _statistics.labelsExpired++;
+        return;
+    }
+
+    std::size_t bucket = epoch % _settings.buckets;
+    float* counters = _buckets.data() + bucket * _window.size();
+
+    for (std::size_t row = 0; row < _settings.depth; ++row)
+    {
+        std::size_t i = row * _settings.width + column(key, row);
+        counters[i] += weight;
+        _window[i] += weight;
+    }
+
+    _totals[bucket] += weight;
+    _statistics.labels++;
+
+    float count = estimateKey(key);
+
+    auto iter = _positions.find(key);
+
+    if (iter != _positions.end())
+    {
+        _candidates[iter->second].count = count;
+        siftDown(iter->second);
+    }
+    else if (_candidates.size() < _settings.capacity)
+    {
+        Candidate candidate;
+        candidate.key = key;
+        candidate.mid = mid;
+        candidate.description = description;
+        candidate.count = count;
+        _candidates.push_back(std::move(candidate));
+        _positions[key] = _candidates.size() - 1;
+        siftUp(_candidates.size() - 1);
+    }
+    else if (count > _candidates[0].count)
+    {
+        // Replace the lightest candidate.
+        Candidate& candidate = _candidates[0];
+        _positions.erase(candidate.key);
+        candidate.key = key;
+        candidate.mid = mid;
+        candidate.description = description;
+        candidate.count = count;
+        _positions[key] = 0;
+        siftDown(0);
+        _statistics.replacements++;
+    }
+}
+
+
+void VisionLabelAggregator::advance(uint64_t timestamp)
+{
+    uint64_t epoch = timestamp / _interval;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (epoch > _epoch)
+    {
+        advanceTo(epoch);
+    }
+}
+
+
+std::vector<VisionLabelAggregator::Label> VisionLabelAggregator::top(std::size_t count) const
+{
+    std::vector<Label> labels;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        labels.reserve(_candidates.size());
+
+        for (const auto& candidate: _candidates)
+        {
+            Label label;
+            label.mid = candidate.mid;
+            label.description = candidate.description;
+            label.count = candidate.count;
+            labels.push_back(std::move(label));
+        }
+    }
+
+    count = std::min(count, labels.size());
+
+    std::partial_sort(labels.begin(),
+                      labels.begin() + count,
+                      labels.end(),
+                      [](const Label& a, const Label& b) {
+                          return a.count > b.count;
+                      });
+
+    labels.resize(count);
+    return labels;
+}
+
+
+float VisionLabelAggregator::estimate(const std::string& mid) const
+{
+    uint64_t key = VisionHash::hash(mid);
+    std::unique_lock<std::mutex> lock(_mutex);
+    return estimateKey(key);
+}
+
+
+float VisionLabelAggregator::total() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    float total = 0;
+
+    for (auto value: _totals)
+    {
+        total += value;
+    }
+
+    return total;
+}
+
+
+void VisionLabelAggregator::clear()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    std::fill(_buckets.begin(), _buckets.end(), 0.0f);
+    std::fill(_window.begin(), _window.end(), 0.0f);
+    std::fill(_totals.begin(), _totals.end(), 0.0f);
+    _epoch = 0;
+    _candidates.clear();
+    _positions.clear();
+    _statistics = Statistics();
+}
+
+
+VisionLabelAggregator::Statistics VisionLabelAggregator::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+
+std::size_t VisionLabelAggregator::memoryFootprint() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    std::size_t size = sizeof(*this);
+    size += (_buckets.capacity() + _window.capacity() + _totals.capacity()) * sizeof(float);
+    size += _candidates.capacity() * sizeof(Candidate);
+    size += _positions.size() * (sizeof(uint64_t) + sizeof(std::size_t) + 2 * sizeof(void*));
+
+    for (const auto& candidate: _candidates)
+    {
+        size += candidate.mid.capacity() + candidate.description.capacity();
+    }
+
+    return size;
+}
+
+
+void VisionLabelAggregator::advanceTo(uint64_t epoch)
+{
+    std::size_t sketch = _window.size();
+
+    // Clear the buckets that leave the window, at most all of them.
+    uint64_t first = std::max(_epoch + 1, epoch + 1 - std::min<uint64_t>(epoch + 1, _settings.buckets));
+
+    for (uint64_t e = first; e <= epoch; ++e)
+    {
+        std::size_t bucket = e % _settings.buckets;
+        std::fill(_buckets.begin() + bucket * sketch,
+                  _buckets.begin() + (bucket + 1) * sketch,
+                  0.0f);
+        _totals[bucket] = 0;
+    }
+
+    _epoch = epoch;
+
+    // Rebuild the window sum rather than subtracting, so rounding errors do
+    // not accumulate. This costs O(buckets * width * depth) once per bucket.
+    std::fill(_window.begin(), _window.end(), 0.0f);
+
+    for (std::size_t bucket = 0; bucket < _settings.buckets; ++bucket)
+    {
+        const float* counters = _buckets.data() + bucket * sketch;
+
+        for (std::size_t i = 0; i < sketch; ++i)
+        {
+            _window[i] += counters[i];
+        }
+    }
+
+    // Re-estimate the candidates, dropping those no longer in the window.
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < _candidates.size(); ++i)
+    {
+        float count = estimateKey(_candidates[i].key);
+
+        if (count > 0)
+        {
+            if (kept != i)
+            {
+                _candidates[kept] = std::move(_candidates[i]);
+            }
+
+            _candidates[kept++].count = count;
+        }
+    }
+
+    _candidates.resize(kept);
+    _positions.clear();
+
+    for (std::size_t i = 0; i < _candidates.size(); ++i)
+    {
+        _positions[_candidates[i].key] = i;
+    }
+
+    for (std::size_t i = _candidates.size() / 2; i-- > 0;)
+    {
+        siftDown(i);
+    }
+}
+
+
+float VisionLabelAggregator::estimateKey(uint64_t key) const
+{
+    float estimate = _window[column(key, 0)];
+
+    for (std::size_t row = 1; row < _settings.depth; ++row)
+    {
+        estimate = std::min(estimate, _window[row * _settings.width + column(key, row)]);
+    }
+
+    return std::max(0.0f, estimate);
+}
+
+
+std::size_t VisionLabelAggregator::column(uint64_t key, std::size_t row) const
+{
+    // Derive the row hashes from one 64-bit hash by double hashing.
+    uint64_t h1 = key & 0xFFFFFFFF;
+    uint64_t h2 = (key >> 32) | 1;
+    return static_cast<std::size_t>((h1 + row * h2) % _settings.width);
+}
+
+
+void VisionLabelAggregator::siftDown(std::size_t position)
+{
+    std::size_t size = _candidates.size();
+
+    while (true)
+    {
+        std::size_t smallest = position;
+        std::size_t left = 2 * position + 1;
+        std::size_t right = left + 1;
+
+        if (left < size && _candidates[left].count < _candidates[smallest].count)
+        {
+            smallest = left;
+        }
+
+        if (right < size && _candidates[right].count < _candidates[smallest].count)
+        {
+            smallest = right;
+        }
+
+        if (smallest == position)
+        {
+            return;
+        }
+
+        swap(position, smallest);
+        position = smallest;
+    }
+}
+
+
+void VisionLabelAggregator::siftUp(std::size_t position)
+{
+    while (position > 0)
+    {
+        std::size_t parent = (position - 1) / 2;
+
+        if (_candidates[parent].count <= _candidates[position].count)
+        {
+            return;
+        }
+
+        swap(position, parent);
+        position = parent;
+    }
+}
+
+
+void VisionLabelAggregator::swap(std::size_t a, std::size_t b)
+{
+    std::swap(_candidates[a], _candidates[b]);
+    _positions[_candidates[a].key] = a;
+    _positions[_candidates[b].key] = b;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,790 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionLog.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "Poco/File.h"
+#include "ofFileUtils.h"
+#include "ofx/CloudPlatform/VisionCache.h"
+#include "ofx/CloudPlatform/VisionHash.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+static_assert(sizeof(VisionLogFormat::SegmentHeader) == 24, "Unexpected SegmentHeader size.");
+static_assert(sizeof(VisionLogFormat::RecordHeader) == 24, "Unexpected RecordHeader size.");
+static_assert(sizeof(VisionLogFormat::IndexEntry) == 72, "Unexpected IndexEntry size.");
+
+
+/// \brief Flush a file and sync it to disk.
+/// \returns true if successful.
+bool syncFile(std::FILE* file)
+{
+    if (std::fflush(file) != 0)
+    {
+        return false;
+    }
+
+#if defined(_WIN32)
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+
+/// \brief Sync a directory, so the files created in it survive a crash.
+/// \returns true if successful.
+bool syncDirectory(const std::string& path)
+{
+#if defined(_WIN32)
+    // Windows cannot open a directory for syncing, and NTFS journals its entries.
+    return true;
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+
+/// \returns the two filter bits of an image id.
+std::pair<uint32_t, uint32_t> filterBits(uint64_t imageId)
+{
+    // Image ids may not be well mixed, e.g. small integers.
+    uint64_t hash = imageId * 0x9E3779B97F4A7C15ull;
+    return std::make_pair(static_cast<uint32_t>(hash >> 56),
+                          static_cast<uint32_t>(hash >> 48) & 0xFF);
+}
+
+
+}
+
+
+const char VisionLogFormat::SEGMENT_MAGIC[8] = { 'O', 'F', 'X', 'V', 'L', 'O', 'G', 'S' };
+const char VisionLogFormat::INDEX_MAGIC[8] = { 'O', 'F', 'X', 'V', 'L', 'O', 'G', 'I' };
+
+
+void VisionLogFormat::IndexEntry::add(const RecordHeader& header,
+                                      std::size_t recordSize)
+{
+    if (count == 0)
+    {
+        minTimestamp = header.timestamp;
+        maxTimestamp = header.timestamp;
+    }
+    else
+    {
+        minTimestamp = std::min(minTimestamp, header.timestamp);
+        maxTimestamp = std::max(maxTimestamp, header.timestamp);
+    }
+
+    auto bits = filterBits(header.imageId);
+    filter[bits.first >> 6] |= uint64_t(1) << (bits.first & 63);
+    filter[bits.second >> 6] |= uint64_t(1) << (bits.second & 63);
+
+    size += static_cast<uint32_t>(recordSize);
+    ++count;
+}
+
+
+bool VisionLogFormat::IndexEntry::mayContain(uint64_t imageId) const
+{
+    auto bits = filterBits(imageId);
+    return (filter[bits.first >> 6] & (uint64_t(1) << (bits.first & 63)))
+        && (filter[bits.second >> 6] & (uint64_t(1) << (bits.second & 63)));
+}
+
+
+bool VisionLogFormat::IndexEntry::overlaps(uint64_t begin, uint64_t end) const
+{
+    return count > 0 && maxTimestamp >= begin && (end == 0 || minTimestamp < end);
+}
+
+
+uint32_t VisionLogFormat::checksum(const RecordHeader& header, const char* record)
+{
+    uint64_t seed = VisionHash::combine(VisionHash::combine(header.size, header.imageId),
+                                        header.timestamp);
+    return static_cast<uint32_t>(VisionHash::hash(record, header.size, seed));
+}
+
+
+std::string VisionLogFormat::segmentName(uint64_t firstSequence)
+{
+    std::ostringstream name;
+    name << std::setw(20) << std::setfill('0') << firstSequence;
+    return name.str();
+}
+
+
+VisionLog::VisionLog(const Settings& settings): _settings(settings)
+{
+    _settings.path = ofToDataPath(_settings.path, true);
+    _settings.indexInterval = std::max(_settings.indexInterval, std::size_t(1));
+
+    ofDirectory::createDirectory(_settings.path, false, true);
+
+    // Continue the sequence after the readable records of existing segments.
+    _nextSequence = VisionLogReader(_settings.path).nextSequence();
+    _durableSequence = _nextSequence;
+    _writtenSequence = _nextSequence;
+
+    openSegment(_nextSequence);
+
+    _thread = std::thread(&VisionLog::run, this);
+}
+
+
+VisionLog::~VisionLog()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+
+    _condition.notify_all();
+    _thread.join();
+}
+
+
+uint64_t VisionLog::append(uint64_t imageId,
+                           const AnnotateImageResponse& response,
+                           uint64_t timestamp)
+{
+    VisionLogFormat::RecordHeader header;
+    header.imageId = imageId;
+    header.timestamp = timestamp;
+
+    // Serialize outside of the lock.
+    std::string record(sizeof(header), '\0');
+    VisionSnapshot::serialize(response, record);
+
+    header.size = static_cast<uint32_t>(record.size() - sizeof(header));
+    header.checksum = VisionLogFormat::checksum(header, record.data() + sizeof(header));
+    std::memcpy(&record[0], &header, sizeof(header));
+
+    uint64_t sequence = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        sequence = _nextSequence++;
+        _pending += record;
+        _statistics.records++;
+    }
+
+    _condition.notify_all();
+
+    return sequence;
+}
+
+
+uint64_t VisionLog::append(uint64_t imageId,
+                           const AnnotateImageResponse& response)
+{
+    return append(imageId, response, now());
+}
+
+
+uint64_t VisionLog::append(const std::vector<VisionRequestItem>& items,
+                           const std::vector<AnnotateImageResponse>& responses)
+{
+    if (items.size() != responses.size())
+    {
+        ofLogError("VisionLog::append") << "Expected " << items.size() << " responses, got " << responses.size() << ".";
+    }
+
+    uint64_t timestamp = now();
+    uint64_t sequence = 0;
+
+    for (std::size_t i = 0; i < std::min(items.size(), responses.size()); ++i)
+    {
+        sequence = append(VisionCache::key(items[i]), responses[i], timestamp);
+    }
+
+    return sequence;
+}
+
+
+void VisionLog::sync(uint64_t sequence)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (_durableSequence == _nextSequence)
+    {
+        if (!_error.empty()) throw Poco::Exception(_error);
+        return;
+    }
+
+    sequence = std::min(sequence, _nextSequence - 1);
+
+    // A waiter makes the commit thread commit without gathering a group.
+    ++_waiters;
+    _condition.notify_all();
+    _condition.wait(lock, [&] { return _durableSequence > sequence; });
+    --_waiters;
+
+    if (!_error.empty())
+    {
+        throw Poco::Exception(_error);
+    }
+}
+
+
+void VisionLog::sync()
+{
+    uint64_t sequence = 0;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        sequence = _nextSequence;
+    }
+
+    if (sequence > 0)
+    {
+        sync(sequence - 1);
+    }
+}
+
+
+VisionLog::Statistics VisionLog::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+
+uint64_t VisionLog::imageId(const std::string& id)
+{
+    return VisionHash::hash(id);
+}
+
+
+uint64_t VisionLog::now()
+{
+    auto time = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+
+void VisionLog::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    while (true)
+    {
+        _condition.wait(lock, [this] { return _stop || !_pending.empty(); });
+
+        if (_pending.empty())
+        {
+            break;
+        }
+
+        // Gather a group of appends, unless someone is waiting for them.
+        if (!_stop && _waiters == 0)
+        {
+            _condition.wait_for(lock,
+                                std::chrono::microseconds(_settings.commitInterval),
+                                [this] { return _stop || _waiters > 0; });
+        }
+
+        std::string records;
+        records.swap(_pending);
+        uint64_t sequence = _nextSequence;
+
+        lock.unlock();
+
+        std::string error;
+
+        try
+        {
+            commit(records);
+        }
+        catch (const Poco::Exception& exception)
+        {
+            error = exception.displayText();
+            ofLogError("VisionLog::run") << error;
+        }
+
+        lock.lock();
+
+        if (_error.empty())
+        {
+            _error = error;
+        }
+
+        _durableSequence = sequence;
+        _statistics.bytes += records.size();
+        _statistics.commits++;
+
+        _condition.notify_all();
+    }
+
+    lock.unlock();
+
+    try
+    {
+        closeSegment();
+    }
+    catch (const Poco::Exception& exception)
+    {
+        ofLogError("VisionLog::run") << exception.displayText();
+    }
+}
+
+
+void VisionLog::commit(const std::string& records)
+{
+    if (!_segment)
+    {
+        throw Poco::Exception("No open segment in " + _settings.path);
+    }
+
+    std::size_t offset = 0;
+
+    while (offset < records.size())
+    {
+        VisionLogFormat::RecordHeader header;
+        std::memcpy(&header, records.data() + offset, sizeof(header));
+        std::size_t size = sizeof(header) + header.size;
+
+        bool empty = _segmentBytes == sizeof(VisionLogFormat::SegmentHeader);
+
+        if (!empty && _segmentBytes + size > _settings.maxSegmentBytes)
+        {
+            closeSegment();
+            openSegment(_writtenSequence);
+        }
+
+        if (_entry.count == 0)
+        {
+            _entry.offset = _segmentBytes;
+            _entry.firstSequence = _writtenSequence;
+        }
+
+        if (std::fwrite(records.data() + offset, 1, size, _segment) != size)
+        {
+            throw Poco::Exception("Unable to write to segment in " + _settings.path);
+        }
+
+        _entry.add(header, size);
+        _segmentBytes += size;
+        _writtenSequence++;
+        offset += size;
+
+        if (_entry.count >= _settings.indexInterval)
+        {
+            writeIndexEntry();
+        }
+    }
+
+    // The index is not synced; readers index any unindexed tail themselves.
+    std::fflush(_index);
+
+    if (!syncFile(_segment))
+    {
+        throw Poco::Exception("Unable to sync segment in " + _settings.path);
+    }
+}
+
+
+void VisionLog::openSegment(uint64_t firstSequence)
+{
+    std::string name = ofFilePath::join(_settings.path, VisionLogFormat::segmentName(firstSequence));
+
+    _segment = std::fopen((name + ".log").c_str(), "wb");
+    _index = std::fopen((name + ".idx").c_str(), "wb");
+
+    if (!_segment || !_index)
+    {
+        if (_segment) std::fclose(_segment);
+        if (_index) std::fclose(_index);
+        _segment = nullptr;
+        _index = nullptr;
+        throw Poco::Exception("Unable to create segment " + name);
+    }
+
+    VisionLogFormat::SegmentHeader header;
+    header.firstSequence = firstSequence;
+
+    std::memcpy(header.magic, VisionLogFormat::SEGMENT_MAGIC, sizeof(header.magic));
+    std::fwrite(&header, sizeof(header), 1, _segment);
+
+    std::memcpy(header.magic, VisionLogFormat::INDEX_MAGIC, sizeof(header.magic));
+    std::fwrite(&header, sizeof(header), 1, _index);
+
+    // Commits only sync the files, so make their directory entries durable
+    // before the first commit into them is acknowledged.
+    if (!syncDirectory(_settings.path))
+    {
+        std::fclose(_segment);
+        std::fclose(_index);
+        _segment = nullptr;
+        _index = nullptr;
+        throw Poco::Exception("Unable to sync log directory " + _settings.path);
+    }
+
+    _segmentBytes = sizeof(header);
+    _entry = VisionLogFormat::IndexEntry();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _statistics.segments++;
+}
+
+
+void VisionLog::closeSegment()
+{
+    if (!_segment)
+    {
+        return;
+    }
+
+    if (_entry.count > 0)
+    {
+        writeIndexEntry();
+    }
+
+    bool synced = syncFile(_segment) && syncFile(_index);
+
+    std::fclose(_segment);
+    std::fclose(_index);
+    _segment = nullptr;
+    _index = nullptr;
+
+    if (!synced)
+    {
+        throw Poco::Exception("Unable to sync segment in " + _settings.path);
+    }
+}
+
+
+void VisionLog::writeIndexEntry()
+{
+    std::fwrite(&_entry, sizeof(_entry), 1, _index);
+    _entry = VisionLogFormat::IndexEntry();
+}
+
+
+VisionLogReader::VisionLogReader(const std::string& path):
+    _path(ofToDataPath(path, true))
+{
+    refresh();
+}
+
+
+VisionLogReader::~VisionLogReader()
+{
+}
+
+
+void VisionLogReader::refresh()
+{
+    _segments.clear();
+
+    if (!ofDirectory::doesDirectoryExist(_path, false))
+    {
+        return;
+    }
+
+    ofDirectory directory(_path);
+    directory.allowExt("log");
+    directory.listDir();
+    directory.sort();
+
+    for (std::size_t i = 0; i < directory.size(); ++i)
+    {
+        Segment segment;
+        segment.path = directory.getPath(i);
+
+        if (load(segment))
+        {
+            _segments.push_back(std::move(segment));
+        }
+    }
+}
+
+
+std::size_t VisionLogReader::segments() const
+{
+    return _segments.size();
+}
+
+
+uint64_t VisionLogReader::size() const
+{
+    uint64_t size = 0;
+
+    for (const auto& segment: _segments)
+    {
+        for (const auto& entry: segment.index)
+        {
+            size += entry.count;
+        }
+    }
+
+    return size;
+}
+
+
+uint64_t VisionLogReader::nextSequence() const
+{
+    if (_segments.empty())
+    {
+        return 0;
+    }
+
+    const auto& segment = _segments.back();
+
+    if (segment.index.empty())
+    {
+        return segment.firstSequence;
+    }
+
+    return segment.index.back().firstSequence + segment.index.back().count;
+}
+
+
+void VisionLogReader::find(uint64_t imageId, const Callback& callback) const
+{
+    for (const auto& segment: _segments)
+    {
+        for (const auto& entry: segment.index)
+        {
+            if (!entry.mayContain(imageId))
+            {
+                continue;
+            }
+
+            bool more = visit(segment, entry, [&](const Entry& record) {
+                return record.imageId != imageId || callback(record);
+            });
+
+            if (!more)
+            {
+                return;
+            }
+        }
+    }
+}
+
+
+std::vector<VisionLogReader::Entry> VisionLogReader::find(uint64_t imageId) const
+{
+    std::vector<Entry> entries;
+
+    find(imageId, [&](const Entry& entry) {
+        entries.push_back(entry);
+        return true;
+    });
+
+    return entries;
+}
+
+
+void VisionLogReader::scan(uint64_t begin,
+                           uint64_t end,
+                           const Callback& callback) const
+{
+    for (const auto& segment: _segments)
+    {
+        for (const auto& entry: segment.index)
+        {
+            if (!entry.overlaps(begin, end))
+            {
+                continue;
+            }
+
+            bool more = visit(segment, entry, [&](const Entry& record) {
+                bool inRange = record.timestamp >= begin && (end == 0 || record.timestamp < end);
+                return !inRange || callback(record);
+            });
+
+            if (!more)
+            {
+                return;
+            }
+        }
+    }
+}
+
+
+bool VisionLogReader::load(Segment& segment)
+{
+    Poco::File file(segment.path);
+
+    segment.size = static_cast<std::size_t>(file.getSize());
+
+    if (segment.size < sizeof(VisionLogFormat::SegmentHeader))
+    {
+        return false;
+    }
+
+    segment.memory.reset(new Poco::SharedMemory(file, Poco::SharedMemory::AM_READ));
+
+    VisionLogFormat::SegmentHeader header;
+    std::memcpy(&header, segment.memory->begin(), sizeof(header));
+
+    if (std::memcmp(header.magic, VisionLogFormat::SEGMENT_MAGIC, sizeof(header.magic)) != 0
+    ||  header.version != VisionLogFormat::VERSION
+    ||  header.byteOrder != VisionLogFormat::SegmentHeader().byteOrder)
+    {
+        ofLogWarning("VisionLogReader::load") << "Skipping invalid segment " << segment.path;
+        return false;
+    }
+
+    segment.firstSequence = header.firstSequence;
+
+    uint64_t offset = sizeof(header);
+    uint64_t sequence = header.firstSequence;
+
+    // Use the index entries that match the segment.
+    std::ifstream index(segment.path.substr(0, segment.path.size() - 4) + ".idx", std::ios::binary);
+    VisionLogFormat::SegmentHeader indexHeader;
+
+    if (index.read(reinterpret_cast<char*>(&indexHeader), sizeof(indexHeader))
+    &&  std::memcmp(indexHeader.magic, VisionLogFormat::INDEX_MAGIC, sizeof(indexHeader.magic)) == 0
+    &&  indexHeader.firstSequence == header.firstSequence)
+    {
+        VisionLogFormat::IndexEntry entry;
+
+        while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry))
+           &&  entry.offset == offset
+           &&  entry.firstSequence == sequence
+           &&  entry.size <= segment.size - offset)
+        {
+            segment.index.push_back(entry);
+            offset += entry.size;
+            sequence += entry.count;
+        }
+    }
+
+    // Index the tail that was written after the last index entry.
+    VisionLogFormat::IndexEntry entry;
+    Entry record;
+    std::size_t size = 0;
+
+    while (read(segment, offset, record, size))
+    {
+        if (entry.count == 0)
+        {
+            entry.offset = offset;
+            entry.firstSequence = sequence;
+        }
+
+        VisionLogFormat::RecordHeader recordHeader;
+        recordHeader.imageId = record.imageId;
+        recordHeader.timestamp = record.timestamp;
+        entry.add(recordHeader, size);
+
+        offset += size;
+        sequence++;
+
+        if (entry.count >= VisionLog::DEFAULT_INDEX_INTERVAL)
+        {
+            segment.index.push_back(entry);
+            entry = VisionLogFormat::IndexEntry();
+        }
+    }
+
+    if (entry.count > 0)
+    {
+        segment.index.push_back(entry);
+    }
+
+    return true;
+}
+
+
+bool VisionLogReader::visit(const Segment& segment,
+                            const VisionLogFormat::IndexEntry& entry,
+                            const Callback& visitor) const
+{
+    uint64_t offset = entry.offset;
+
+    for (uint32_t i = 0; i < entry.count; ++i)
+    {
+        Entry record;
+        std::size_t size = 0;
+
+        // A damaged record ends its block.
+        if (!read(segment, offset, record, size))
+        {
+            return true;
+        }
+
+        record.sequence = entry.firstSequence + i;
+
+        if (!visitor(record))
+        {
+            return false;
+        }
+
+        offset += size;
+    }
+
+    return true;
+}
+
+
+bool VisionLogReader::read(const Segment& segment,
+                           uint64_t offset,
+                           Entry& entry,
+                           std::size_t& size)
+{
+    if (offset > segment.size
+    ||  segment.size - offset < sizeof(VisionLogFormat::RecordHeader))
+    {
+        return false;
+    }
+
+    const char* data = segment.memory->begin() + offset;
+
+    VisionLogFormat::RecordHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    const char* record = data + sizeof(header);
+
+    if (header.size > segment.size - offset - sizeof(header)
+    ||  header.checksum != VisionLogFormat::checksum(header, record)
+    ||  !VisionSnapshot::isValid(record, header.size))
+    {
+        return false;
+    }
+
+    entry.imageId = header.imageId;
+    entry.timestamp = header.timestamp;
+    entry.record = VisionSnapshot::Record(record);
+    size = sizeof(header) + header.size;
+
+    return true;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,335 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <tuple>
+#include <unordered_map>
+#include "Poco/RWLock.h"
+#include "ofx/CloudPlatform/VisionHash.h"
+#include "ofLog.h"
+#include "ofUtils.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief The count of one kind, type and name.
+struct Count
+{
+    VisionParseDiagnostics::Kind kind;
+    std::string type;
+    std::string name;
+    std::atomic<uint64_t> count { 0 };
+};
+
+
+/// \brief The shared diagnostics state.
+///
+/// Counts are only added and removed with the write lock held, so a count
+/// found with the read lock held can be incremented without it.
+struct State
+{
+    VisionParseDiagnostics::Settings settings;
+
+    /// \brief Counts by a hash of their kind, type and name.
+    std::unordered_multimap<uint64_t, std::unique_ptr<Count>> counts;
+
+    std::deque<VisionParseDiagnostics::Sample> samples;
+
+    /// \brief The earliest time of the next sample in microseconds.
+    std::atomic<uint64_t> nextSampleTime { 0 };
+
+    std::atomic<uint64_t> unknownKeys { 0 };
+    std::atomic<uint64_t> unknownValues { 0 };
+
+    Poco::RWLock lock;
+};
+
+
+State& state()
+{
+    static State state;
+    return state;
+}
+
+
+/// \returns the hash of a kind, type and name, computed without allocating.
+uint64_t countKey(VisionParseDiagnostics::Kind kind,
+                  const char* type,
+                  const std::string& name)
+{
+    return VisionHash::combine(VisionHash::hash(type, std::strlen(type), static_cast<uint64_t>(kind)),
+                               VisionHash::hash(name));
+}
+
+
+/// \brief Find a count. A lock must be held.
+Count* findCount(State& s,
+                 uint64_t key,
+                 VisionParseDiagnostics::Kind kind,
+                 const char* type,
+                 const std::string& name)
+{
+    auto range = s.counts.equal_range(key);
+
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        Count& count = *iter->second;
+
+        if (count.kind == kind && count.name == name && count.type.compare(type) == 0)
+        {
+            return &count;
+        }
+    }
+
+    return nullptr;
+}
+
+
+}
+
+
+void VisionParseDiagnostics::setSettings(const Settings& settings)
+{
+    auto& s = state();
+    Poco::ScopedWriteRWLock lock(s.lock);
+    s.settings = settings;
+
+    while (s.samples.size() > s.settings.maxSamples)
+    {
+        s.samples.pop_front();
+    }
+}
+
+
+VisionParseDiagnostics::Settings VisionParseDiagnostics::getSettings()
+{
+    auto& s = state();
+    Poco::ScopedReadRWLock lock(s.lock);
+    return s.settings;
+}
+
+
+void VisionParseDiagnostics::unknownKey(const char* type,
+                                        const std::string& key,
+                                        const ofJson& value)
+{
+    state().unknownKeys++;
+
+    uint64_t timestamp = 0;
+
+    if (record(Kind::UNKNOWN_KEY, type, key, timestamp))
+    {
+        addSample(Kind::UNKNOWN_KEY, type, key, value.dump(), timestamp);
+    }
+}
+
+
+void VisionParseDiagnostics::unknownValue(const char* type, const std::string& value)
+{
+    state().unknownValues++;
+
+    uint64_t timestamp = 0;
+
+    if (record(Kind::UNKNOWN_VALUE, type, value, timestamp))
+    {
+        addSample(Kind::UNKNOWN_VALUE, type, value, value, timestamp);
+    }
+}
+
+
+uint64_t VisionParseDiagnostics::unknownKeys()
+{
+    return state().unknownKeys;
+}
+
+
+uint64_t VisionParseDiagnostics::unknownValues()
+{
+    return state().unknownValues;
+}
+
+
+std::vector<VisionParseDiagnostics::Counter> VisionParseDiagnostics::counters()
+{
+    auto& s = state();
+    Poco::ScopedReadRWLock lock(s.lock);
+
+    std::vector<Counter> counters;
+    counters.reserve(s.counts.size());
+
+    for (const auto& count: s.counts)
+    {
+        Counter counter;
+        counter.kind = count.second->kind;
+        counter.type = count.second->type;
+        counter.name = count.second->name;
+        counter.count = count.second->count;
+        counters.push_back(counter);
+    }
+
+    // Hash order is arbitrary, so sort as the counters used to be.
+    std::sort(counters.begin(), counters.end(), [](const Counter& a, const Counter& b) {
+        return std::tie(a.kind, a.type, a.name) < std::tie(b.kind, b.type, b.name);
+    });
+
+    return counters;
+}
+
+
+std::vector<VisionParseDiagnostics::Sample> VisionParseDiagnostics::samples()
+{
+    auto& s = state();
+    Poco::ScopedReadRWLock lock(s.lock);
+    return std::vector<Sample>(s.samples.begin(), s.samples.end());
+}
+
+
+void VisionParseDiagnostics::reset()
+{
+    auto& s = state();
+    Poco::ScopedWriteRWLock lock(s.lock);
+    s.counts.clear();
+    s.samples.clear();
+    s.nextSampleTime = 0;
+    s.unknownKeys = 0;
+    s.unknownValues = 0;
+}
+
+
+std::string VisionParseDiagnostics::toString(Kind kind)
+{
+    switch (kind)
+    {
+        case Kind::UNKNOWN_KEY: return "UNKNOWN_KEY";
+        case Kind::UNKNOWN_VALUE: return "UNKNOWN_VALUE";
+    }
+
+    return "UNKNOWN";
+}
+
+
+bool VisionParseDiagnostics::record(Kind kind,
+                                    const char* type,
+                                    const std::string& name,
+                                    uint64_t& timestamp)
+{
+    auto& s = state();
+    uint64_t key = countKey(kind, type, name);
+
+    bool found = false;
+    bool logFirstOccurrence = false;
+    double samplesPerSecond = 0;
+    std::size_t maxSamples = 0;
+
+    // Fields seen before only need the read lock.
+    {
+        Poco::ScopedReadRWLock lock(s.lock);
+
+        Count* count = findCount(s, key, kind, type, name);
+
+        if (count)
+        {
+            count->count++;
+            found = true;
+        }
+
+        logFirstOccurrence = s.settings.logFirstOccurrence;
+        samplesPerSecond = s.settings.samplesPerSecond;
+        maxSamples = s.settings.maxSamples;
+    }
+
+    if (!found)
+    {
+        bool first = false;
+
+        {
+            Poco::ScopedWriteRWLock lock(s.lock);
+
+            // Another thread may have added it since the read lock was released.
+            Count* count = findCount(s, key, kind, type, name);
+
+            if (!count)
+            {
+                std::unique_ptr<Count> added(new Count());
+                added->kind = kind;
+                added->type = type;
+                added->name = name;
+                count = added.get();
+                s.counts.insert(std::make_pair(key, std::move(added)));
+                first = true;
+            }
+
+            count->count++;
+        }
+
+        if (first && logFirstOccurrence)
+        {
+            ofLogWarning(type) << (kind == Kind::UNKNOWN_KEY ? "Unknown key: " : "Unknown value: ") << name;
+        }
+    }
+
+    if (samplesPerSecond <= 0 || maxSamples == 0)
+    {
+        return false;
+    }
+
+    uint64_t now = ofGetElapsedTimeMicros();
+    uint64_t interval = static_cast<uint64_t>(1000000.0 / samplesPerSecond);
+    uint64_t next = s.nextSampleTime;
+
+    // Claim the sample, so only one thread serializes a snippet per interval.
+    if (now < next || !s.nextSampleTime.compare_exchange_strong(next, now + interval))
+    {
+        return false;
+    }
+
+    timestamp = now;
+    return true;
+}
+
+
+void VisionParseDiagnostics::addSample(Kind kind,
+                                       const char* type,
+                                       const std::string& name,
+                                       std::string snippet,
+                                       uint64_t timestamp)
+{
+    auto& s = state();
+    Poco::ScopedWriteRWLock lock(s.lock);
+
+    if (snippet.size() > s.settings.maxSnippetSize)
+    {
+        snippet.resize(s.settings.maxSnippetSize);
+    }
+
+    Sample sample;
+    sample.kind = kind;
+    sample.type = type;
+    sample.name = name;
+    sample.snippet = std::move(snippet);
+    sample.timestamp = timestamp;
+
+    s.samples.push_back(std::move(sample));
+
+    while (s.samples.size() > s.settings.maxSamples)
+    {
+        s.samples.pop_front();
+    }
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,636 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionQuads.h"
+#include <algorithm>
+#include <cmath>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_CLOUDPLATFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief Areas below this are treated as degenerate.
+constexpr float EPSILON = 1e-6f;
+
+
+/// \brief The capacity of a clipped polygon. Convex quads need at most 8.
+constexpr std::size_t MAX_VERTICES = 16;
+
+
+/// \returns twice the signed area of a quad, positive if counter-clockwise
+/// in a y-up frame.
+float signedArea2(const VisionQuads::Quad& quad)
+{
+    float sum = 0;
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        const auto& p = quad[c];
+        const auto& q = quad[(c + 1) % 4];
+        sum += p.x * q.y - q.x * p.y;
+    }
+
+    return sum;
+}
+
+
+/// \brief Clip a convex polygon by the half-plane left of the edge a to b.
+/// \returns the number of output vertices.
+std::size_t clip(const glm::vec2* input,
+                 std::size_t size,
+                 const glm::vec2& a,
+                 const glm::vec2& b,
+                 float orientation,
+                 glm::vec2* output)
+{
+    std::size_t count = 0;
+    glm::vec2 edge = b - a;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const glm::vec2& p = input[i];
+        const glm::vec2& q = input[(i + 1) % size];
+
+        float sp = orientation * (edge.x * (p.y - a.y) - edge.y * (p.x - a.x));
+        float sq = orientation * (edge.x * (q.y - a.y) - edge.y * (q.x - a.x));
+
+        if (sp >= 0 && count < MAX_VERTICES)
+        {
+            output[count++] = p;
+        }
+
+        if ((sp >= 0) != (sq >= 0) && count < MAX_VERTICES)
+        {
+            float t = sp / (sp - sq);
+            output[count++] = p + (q - p) * t;
+        }
+    }
+
+    return count;
+}
+
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+/// \returns the absolute value of each lane.
+inline __m128 abs4(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+
+/// \returns a where the mask is set, otherwise b.
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+
+/// \returns twice the signed area of four quads.
+inline __m128 signedArea2(const __m128* x, const __m128* y)
+{
+    __m128 sum = _mm_setzero_ps();
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        std::size_t n = (c + 1) % 4;
+        sum = _mm_add_ps(sum, _mm_sub_ps(_mm_mul_ps(x[c], y[n]),
+                                         _mm_mul_ps(x[n], y[c])));
+    }
+
+    return sum;
+}
+
+
+/// \brief Load the corners of four quads.
+inline void load(const std::array<std::vector<float>, 4>& columns,
+                 std::size_t i,
+                 __m128* values)
+{
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        values[c] = _mm_loadu_ps(columns[c].data() + i);
+    }
+}
+#endif
+
+
+} // namespace
+
+
+VisionQuads::VisionQuads()
+{
+}
+
+
+VisionQuads::~VisionQuads()
+{
+}
+
+
+std::size_t VisionQuads::add(const Quad& quad)
+{
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        _x[c].push_back(quad[c].x);
+        _y[c].push_back(quad[c].y);
+    }
+
+    return size() - 1;
+}
+
+
+std::size_t VisionQuads::add(const ofPolyline& polyline)
+{
+    const auto& vertices = polyline.getVertices();
+
+    Quad quad;
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        if (!vertices.empty())
+        {
+            const auto& vertex = vertices[std::min(c, vertices.size() - 1)];
+            quad[c] = glm::vec2(vertex.x, vertex.y);
+        }
+        else
+        {
+            quad[c] = glm::vec2(0, 0);
+        }
+    }
+
+    return add(quad);
+}
+
+
+void VisionQuads::reserve(std::size_t size)
+{
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        _x[c].reserve(size);
+        _y[c].reserve(size);
+    }
+}
+
+
+void VisionQuads::clear()
+{
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        _x[c].clear();
+        _y[c].clear();
+    }
+}
+
+
+std::size_t VisionQuads::size() const
+{
+    return _x[0].size();
+}
+
+
+VisionQuads::Quad VisionQuads::quad(std::size_t index) const
+{
+    Quad quad;
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        quad[c] = glm::vec2(_x[c][index], _y[c][index]);
+    }
+
+    return quad;
+}
+
+
+const float* VisionQuads::x(std::size_t corner) const
+{
+    return _x[corner].data();
+}
+
+
+const float* VisionQuads::y(std::size_t corner) const
+{
+    return _y[corner].data();
+}
+
+
+void VisionQuads::areas(float* areas) const
+{
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+        _mm_storeu_ps(areas + i, _mm_mul_ps(half, abs4(signedArea2(x, y))));
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        areas[i] = area(quad(i));
+    }
+}
+
+
+void VisionQuads::centroids(float* cx, float* cy) const
+{
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 quarter = _mm_set1_ps(0.25f);
+    __m128 third = _mm_set1_ps(1.0f / 3.0f);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 epsilon = _mm_set1_ps(2 * EPSILON);
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        __m128 sumX = _mm_setzero_ps();
+        __m128 sumY = _mm_setzero_ps();
+        __m128 meanX = _mm_setzero_ps();
+        __m128 meanY = _mm_setzero_ps();
+        __m128 area2 = _mm_setzero_ps();
+
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            std::size_t n = (c + 1) % 4;
+            __m128 cross = _mm_sub_ps(_mm_mul_ps(x[c], y[n]),
+                                      _mm_mul_ps(x[n], y[c]));
+            area2 = _mm_add_ps(area2, cross);
+            sumX = _mm_add_ps(sumX, _mm_mul_ps(_mm_add_ps(x[c], x[n]), cross));
+            sumY = _mm_add_ps(sumY, _mm_mul_ps(_mm_add_ps(y[c], y[n]), cross));
+            meanX = _mm_add_ps(meanX, x[c]);
+            meanY = _mm_add_ps(meanY, y[c]);
+        }
+
+        // The centroid is sum / (3 * area2); degenerate lanes use the mean.
+        __m128 degenerate = _mm_cmplt_ps(abs4(area2), epsilon);
+        __m128 scale = _mm_div_ps(third, select(degenerate, one, area2));
+
+        _mm_storeu_ps(cx + i, select(degenerate, _mm_mul_ps(meanX, quarter), _mm_mul_ps(sumX, scale)));
+        _mm_storeu_ps(cy + i, select(degenerate, _mm_mul_ps(meanY, quarter), _mm_mul_ps(sumY, scale)));
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        glm::vec2 c = centroid(quad(i));
+        cx[i] = c.x;
+        cy[i] = c.y;
+    }
+}
+
+
+void VisionQuads::bounds(glm::vec2* min, glm::vec2* max) const
+{
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    alignas(16) float minX[4];
+    alignas(16) float minY[4];
+    alignas(16) float maxX[4];
+    alignas(16) float maxY[4];
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        _mm_store_ps(minX, _mm_min_ps(_mm_min_ps(x[0], x[1]), _mm_min_ps(x[2], x[3])));
+        _mm_store_ps(minY, _mm_min_ps(_mm_min_ps(y[0], y[1]), _mm_min_ps(y[2], y[3])));
+        _mm_store_ps(maxX, _mm_max_ps(_mm_max_ps(x[0], x[1]), _mm_max_ps(x[2], x[3])));
+        _mm_store_ps(maxY, _mm_max_ps(_mm_max_ps(y[0], y[1]), _mm_max_ps(y[2], y[3])));
+
+        for (std::size_t k = 0; k < 4; ++k)
+        {
+            min[i + k] = glm::vec2(minX[k], minY[k]);
+            max[i + k] = glm::vec2(maxX[k], maxY[k]);
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        min[i] = glm::vec2(std::min(std::min(_x[0][i], _x[1][i]), std::min(_x[2][i], _x[3][i])),
+                           std::min(std::min(_y[0][i], _y[1][i]), std::min(_y[2][i], _y[3][i])));
+        max[i] = glm::vec2(std::max(std::max(_x[0][i], _x[1][i]), std::max(_x[2][i], _x[3][i])),
+                           std::max(std::max(_y[0][i], _y[1][i]), std::max(_y[2][i], _y[3][i])));
+    }
+}
+
+
+void VisionQuads::contains(const glm::vec2& point, uint8_t* contains) const
+{
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 px = _mm_set1_ps(point.x);
+    __m128 py = _mm_set1_ps(point.y);
+    __m128 zero = _mm_setzero_ps();
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        // A convex quad contains the point if it is on the same side of
+        // every edge.
+        __m128 allLeft = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        __m128 allRight = allLeft;
+
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            std::size_t n = (c + 1) % 4;
+            __m128 side = _mm_sub_ps(_mm_mul_ps(_mm_sub_ps(x[n], x[c]), _mm_sub_ps(py, y[c])),
+                                     _mm_mul_ps(_mm_sub_ps(y[n], y[c]), _mm_sub_ps(px, x[c])));
+            allLeft = _mm_and_ps(allLeft, _mm_cmpge_ps(side, zero));
+            allRight = _mm_and_ps(allRight, _mm_cmple_ps(side, zero));
+        }
+
+        int mask = _mm_movemask_ps(_mm_or_ps(allLeft, allRight));
+
+        for (int k = 0; k < 4; ++k)
+        {
+            contains[i + k] = (mask >> k) & 1;
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        bool left = true;
+        bool right = true;
+
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            std::size_t n = (c + 1) % 4;
+            float side = (_x[n][i] - _x[c][i]) * (point.y - _y[c][i])
+                       - (_y[n][i] - _y[c][i]) * (point.x - _x[c][i]);
+            left = left && side >= 0;
+            right = right && side <= 0;
+        }
+
+        contains[i] = left || right;
+    }
+}
+
+
+void VisionQuads::intersectionAreas(const Quad& quad, float* areas) const
+{
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+    glm::vec2 qMin = quad[0];
+    glm::vec2 qMax = quad[0];
+
+    for (std::size_t c = 1; c < 4; ++c)
+    {
+        qMin = glm::vec2(std::min(qMin.x, quad[c].x), std::min(qMin.y, quad[c].y));
+        qMax = glm::vec2(std::max(qMax.x, quad[c].x), std::max(qMax.y, quad[c].y));
+    }
+
+    bool aligned = isAxisAligned(quad);
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 minX = _mm_set1_ps(qMin.x);
+    __m128 minY = _mm_set1_ps(qMin.y);
+    __m128 maxX = _mm_set1_ps(qMax.x);
+    __m128 maxY = _mm_set1_ps(qMax.y);
+    __m128 zero = _mm_setzero_ps();
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        // The overlap of the bounds is exact for two axis-aligned quads and
+        // zero for any disjoint pair.
+        __m128 w = _mm_sub_ps(_mm_min_ps(maxX, _mm_max_ps(_mm_max_ps(x[0], x[1]), _mm_max_ps(x[2], x[3]))),
+                              _mm_max_ps(minX, _mm_min_ps(_mm_min_ps(x[0], x[1]), _mm_min_ps(x[2], x[3]))));
+        __m128 h = _mm_sub_ps(_mm_min_ps(maxY, _mm_max_ps(_mm_max_ps(y[0], y[1]), _mm_max_ps(y[2], y[3]))),
+                              _mm_max_ps(minY, _mm_min_ps(_mm_min_ps(y[0], y[1]), _mm_min_ps(y[2], y[3]))));
+        __m128 overlap = _mm_mul_ps(_mm_max_ps(w, zero), _mm_max_ps(h, zero));
+        _mm_storeu_ps(areas + i, overlap);
+
+        int exact = 0;
+
+        if (aligned)
+        {
+            __m128 horizontal = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(y[0], y[1]), _mm_cmpeq_ps(x[1], x[2])),
+                                           _mm_and_ps(_mm_cmpeq_ps(y[2], y[3]), _mm_cmpeq_ps(x[3], x[0])));
+            __m128 vertical = _mm_and_ps(_mm_and_ps(_mm_cmpeq_ps(x[0], x[1]), _mm_cmpeq_ps(y[1], y[2])),
+                                         _mm_and_ps(_mm_cmpeq_ps(x[2], x[3]), _mm_cmpeq_ps(y[3], y[0])));
+            exact = _mm_movemask_ps(_mm_or_ps(horizontal, vertical));
+        }
+
+        int clip = _mm_movemask_ps(_mm_cmpgt_ps(overlap, zero)) & ~exact;
+
+        // Most blocks are usually disjoint or axis-aligned.
+        if (clip == 0)
+        {
+            continue;
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+            if (clip & (1 << k))
+            {
+                areas[i + k] = intersectionArea(this->quad(i + k), quad);
+            }
+        }
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        areas[i] = intersectionArea(this->quad(i), quad);
+    }
+}
+
+
+void VisionQuads::iou(const Quad& quad, float* iou) const
+{
+    intersectionAreas(quad, iou);
+
+    std::size_t size = this->size();
+    std::size_t i = 0;
+    float quadArea = area(quad);
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 epsilon = _mm_set1_ps(EPSILON);
+    __m128 b = _mm_set1_ps(quadArea);
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        __m128 a = _mm_mul_ps(half, abs4(signedArea2(x, y)));
+        __m128 intersection = _mm_loadu_ps(iou + i);
+        __m128 united = _mm_sub_ps(_mm_add_ps(a, b), intersection);
+        __m128 valid = _mm_cmpgt_ps(united, epsilon);
+        __m128 ratio = _mm_min_ps(one, _mm_div_ps(intersection, select(valid, united, one)));
+        _mm_storeu_ps(iou + i, _mm_and_ps(valid, ratio));
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        float united = area(this->quad(i)) + quadArea - iou[i];
+        iou[i] = united > EPSILON ? std::min(1.0f, iou[i] / united) : 0;
+    }
+}
+
+
+void VisionQuads::containment(const Quad& quad, float* containment) const
+{
+    intersectionAreas(quad, containment);
+
+    std::size_t size = this->size();
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128 half = _mm_set1_ps(0.5f);
+    __m128 one = _mm_set1_ps(1.0f);
+    __m128 epsilon = _mm_set1_ps(EPSILON);
+    __m128 x[4];
+    __m128 y[4];
+
+    for (; i + 4 <= size; i += 4)
+    {
+        load(_x, i, x);
+        load(_y, i, y);
+
+        __m128 a = _mm_mul_ps(half, abs4(signedArea2(x, y)));
+        __m128 valid = _mm_cmpgt_ps(a, epsilon);
+        __m128 ratio = _mm_min_ps(one, _mm_div_ps(_mm_loadu_ps(containment + i),
+                                                  select(valid, a, one)));
+        _mm_storeu_ps(containment + i, _mm_and_ps(valid, ratio));
+    }
+#endif
+
+    for (; i < size; ++i)
+    {
+        float a = area(this->quad(i));
+        containment[i] = a > EPSILON ? std::min(1.0f, containment[i] / a) : 0;
+    }
+}
+
+
+float VisionQuads::area(const Quad& quad)
+{
+    return 0.5f * std::abs(signedArea2(quad));
+}
+
+
+glm::vec2 VisionQuads::centroid(const Quad& quad)
+{
+    float area2 = 0;
+    glm::vec2 sum(0, 0);
+    glm::vec2 mean(0, 0);
+
+    for (std::size_t c = 0; c < 4; ++c)
+    {
+        const auto& p = quad[c];
+        const auto& q = quad[(c + 1) % 4];
+        float cross = p.x * q.y - q.x * p.y;
+        area2 += cross;
+        sum += (p + q) * cross;
+        mean += p;
+    }
+
+    if (std::abs(area2) < 2 * EPSILON)
+    {
+        return mean * 0.25f;
+    }
+
+    return sum / (3 * area2);
+}
+
+
+float VisionQuads::intersectionArea(const Quad& a, const Quad& b)
+{
+    float orientation = signedArea2(b);
+
+    if (std::abs(orientation) < 2 * EPSILON)
+    {
+        return 0;
+    }
+
+    orientation = orientation > 0 ? 1.0f : -1.0f;
+
+    // Clipping a convex polygon by a half-plane adds at most one vertex.
+    glm::vec2 buffers[2][MAX_VERTICES];
+    std::size_t size = 4;
+    std::copy(a.begin(), a.end(), buffers[0]);
+
+    for (std::size_t c = 0; c < 4 && size > 0; ++c)
+    {
+        size = clip(buffers[c % 2],
+                    size,
+                    b[c],
+                    b[(c + 1) % 4],
+                    orientation,
+                    buffers[(c + 1) % 2]);
+    }
+
+    float sum = 0;
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        const auto& p = buffers[0][i];
+        const auto& q = buffers[0][(i + 1) % size];
+        sum += p.x * q.y - q.x * p.y;
+    }
+
+    return 0.5f * std::abs(sum);
+}
+
+
+bool VisionQuads::isAxisAligned(const Quad& quad)
+{
+    return (quad[0].y == quad[1].y && quad[1].x == quad[2].x &&
+            quad[2].y == quad[3].y && quad[3].x == quad[0].x) ||
+           (quad[0].x == quad[1].x && quad[1].y == quad[2].y &&
+            quad[2].x == quad[3].x && quad[3].y == quad[0].y);
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -6,12 +6,38 @@
 
 
 #include "ofx/CloudPlatform/VisionRequest.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
 
 
 namespace ofx {
 namespace CloudPlatform {
 
 
+namespace {
+
+
+/// \returns an item's JSON without its image content.
+ofJson parametersJSON(const VisionRequestItem& item)
+{
+    ofJson json = item.parameters();
+
+    if (item.requestTemplate())
+    {
+        const auto& parameters = item.requestTemplate()->json();
+
+        for (auto iter = parameters.cbegin(); iter != parameters.cend(); ++iter)
+        {
+            json[iter.key()] = iter.value();
+        }
+    }
+
+    return json;
+}
+
+
+}
+
+
 const std::string VisionRequest::DEFAULT_VISION_REQUEST_URI = "https://vision.googleapis.com/v1/images:annotate";
 
 
@@ -38,6 +64,18 @@ VisionRequest::VisionRequest(const std::vector<VisionRequestItem>& requestItems)
 }
 
 
+VisionRequest::VisionRequest(std::vector<VisionRequestItem>&& requestItems):
+    HTTP::JSONRequest(DEFAULT_VISION_REQUEST_URI,
+                      Poco::Net::HTTPMessage::HTTP_1_1),
+    _requestItems(std::move(requestItems))
+{
+    for (const auto& item: _requestItems)
+    {
+        _json["requests"].push_back(parametersJSON(item));
+    }
+}
+
+
 VisionRequest::~VisionRequest()
 {
 }
@@ -45,12 +83,22 @@ VisionRequest::~VisionRequest()
 
 void VisionRequest::addRequestItem(const VisionRequestItem& requestItem)
 {
-    _json["requests"].push_back(requestItem.json());
+    _json["requests"].push_back(parametersJSON(requestItem));
+    _requestItems.push_back(requestItem);
+}
+
+
+void VisionRequest::addRequestItem(VisionRequestItem&& requestItem)
+{
+    _json["requests"].push_back(parametersJSON(requestItem));
+    _requestItems.push_back(std::move(requestItem));
 }
 
 
 void VisionRequest::addRequestItems(const std::vector<VisionRequestItem>& requestItems)
 {
+    _requestItems.reserve(_requestItems.size() + requestItems.size());
+
     for (auto& item: requestItems)
     {
         addRequestItem(item);
@@ -58,10 +106,105 @@ void VisionRequest::addRequestItems(const std::vector<VisionRequestItem>& reques
 }
 
 
+const std::vector<VisionRequestItem>& VisionRequest::requestItems() const
+{
+    return _requestItems;
+}
+
+
 void VisionRequest::setJSON(const ofJson& json)
 {
     JSONRequest::setJSON(json);
 }
 
 
+void VisionRequest::prepareRequest()
+{
+    // The body is {"requests":[item,item,...]}, where an item with content is
+    // {"image":{"content":"<base64>"},<parameters>}.
+    _bodyParts.clear();
+
+    std::string text = "{\"requests\":[";
+
+    for (std::size_t i = 0; i < _requestItems.size(); ++i)
+    {
+        const auto& item = _requestItems[i];
+
+        if (i > 0)
+        {
+            text += ",";
+        }
+
+        // The members of the item's JSON object, without braces.
+        std::string parameters;
+
+        if (item.parameters().is_object() && !item.parameters().empty())
+        {
+            parameters = item.parameters().dump();
+            parameters = parameters.substr(1, parameters.size() - 2);
+        }
+
+        auto requestTemplate = item.requestTemplate();
+
+        if (requestTemplate && !requestTemplate->fragment().empty())
+        {
+            parameters = parameters.empty() ? requestTemplate->fragment() : requestTemplate->fragment() + "," + parameters;
+        }
+
+        if (item.content())
+        {
+            text += "{\"image\":{\"content\":\"";
+            _bodyParts.push_back({ text, item.content() });
+            text = "\"}";
+
+            if (!parameters.empty())
+            {
+                text += ",";
+                text += parameters;
+            }
+
+            text += "}";
+        }
+        else
+        {
+            text += "{";
+            text += parameters;
+            text += "}";
+        }
+    }
+
+    text += "]}";
+    _bodyParts.push_back({ text, nullptr });
+
+    std::streamsize contentLength = 0;
+
+    for (const auto& part: _bodyParts)
+    {
+        contentLength += part.text.size();
+
+        if (part.content)
+        {
+            contentLength += part.content->base64Size();
+        }
+    }
+
+    setContentType("application/json");
+    setContentLength(contentLength);
+}
+
+
+void VisionRequest::writeRequestBody(std::ostream& requestStream)
+{
+    for (const auto& part: _bodyParts)
+    {
+        requestStream.write(part.text.data(), part.text.size());
+
+        if (part.content)
+        {
+            part.content->writeBase64(requestStream);
+        }
+    }
+}
+
+
 } } // namespace ofx::CloudPlatform
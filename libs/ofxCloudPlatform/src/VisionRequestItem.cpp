@@ -6,8 +6,9 @@
 
 
 #include "ofx/CloudPlatform/VisionRequestItem.h"
-#include "ofx/IO/ByteBuffer.h"
-#include "ofx/IO/Base64Encoding.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+#include <cmath>
+#include "ofLog.h"
 
 
 namespace ofx {
@@ -30,33 +31,54 @@ const std::map<VisionRequestItem::Feature::Type, std::string> VisionRequestItem:
 };
 
 
-VisionRequestItem::Feature::Feature(Type type, std::size_t maxResults)
-{
-    _json["type"] = TYPE_STRINGS.find(type)->second;
-    _json["maxResults"] = maxResults;
-}
+constexpr const char* VisionRequestItem::Feature::TYPE_NAMES[];
+
 
+static_assert(sizeof(VisionRequestItem::Feature::TYPE_NAMES) / sizeof(const char*)
+              == static_cast<std::size_t>(VisionRequestItem::Feature::Type::WEB_DETECTION) + 1,
+              "TYPE_NAMES must have one name per Feature::Type.");
 
-const ofJson& VisionRequestItem::Feature::json() const
+
+ofJson VisionRequestItem::Feature::json() const
 {
-    return _json;
+    return {
+        { "type", toString(_type) },
+        { "maxResults", _maxResults }
+    };
 }
 
 
-const std::vector<VisionRequestItem::Feature> VisionRequestItem::DEFAULT_FEATURES =
+namespace {
+
+
+constexpr VisionRequestItem::Feature DEFAULT_FEATURE_LIST[] =
 {
-    Feature(Feature::Type::LABEL_DETECTION),
-    Feature(Feature::Type::DOCUMENT_TEXT_DETECTION),
-    Feature(Feature::Type::FACE_DETECTION),
-    Feature(Feature::Type::LANDMARK_DETECTION),
-    Feature(Feature::Type::LOGO_DETECTION),
-    Feature(Feature::Type::SAFE_SEARCH_DETECTION),
-    Feature(Feature::Type::IMAGE_PROPERTIES),
-    Feature(Feature::Type::CROP_HINTS),
-    Feature(Feature::Type::WEB_DETECTION)
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::LABEL_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::DOCUMENT_TEXT_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::FACE_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::LANDMARK_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::LOGO_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::SAFE_SEARCH_DETECTION),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::IMAGE_PROPERTIES),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::CROP_HINTS),
+    VisionRequestItem::Feature(VisionRequestItem::Feature::Type::WEB_DETECTION)
 };
 
 
+} // namespace
+
+
+const std::vector<VisionRequestItem::Feature>& VisionRequestItem::defaultFeatures()
+{
+    static const std::vector<Feature> features(std::begin(DEFAULT_FEATURE_LIST),
+                                               std::end(DEFAULT_FEATURE_LIST));
+    return features;
+}
+
+
+const std::vector<VisionRequestItem::Feature> VisionRequestItem::DEFAULT_FEATURES = VisionRequestItem::defaultFeatures();
+
+
 VisionRequestItem::VisionRequestItem()
 {
 }
@@ -82,6 +104,16 @@ VisionRequestItem::VisionRequestItem(const ofPixels& pixels,
 }
 
 
+VisionRequestItem::VisionRequestItem(const ofPixels& pixels,
+                                     const ofRectangle& region,
+                                     float padding,
+                                     const std::vector<Feature>& features)
+{
+    setImage(pixels, region, padding);
+    setFeatures(features);
+}
+
+
 VisionRequestItem::VisionRequestItem(const std::string& uri,
                                      const std::vector<Feature>& features)
 {
@@ -98,6 +130,38 @@ VisionRequestItem::VisionRequestItem(const ofBuffer& buffer,
 }
 
 
+VisionRequestItem::VisionRequestItem(ofBuffer&& buffer,
+                                     const std::vector<Feature>& features)
+{
+    setImage(std::move(buffer));
+    setFeatures(features);
+}
+
+
+VisionRequestItem::VisionRequestItem(std::shared_ptr<const VisionImageContent> content,
+                                     const std::vector<Feature>& features)
+{
+    setImage(content);
+    setFeatures(features);
+}
+
+
+VisionRequestItem::VisionRequestItem(const ofPixels& pixels,
+                                     std::shared_ptr<const VisionRequestTemplate> requestTemplate)
+{
+    setImage(pixels);
+    setTemplate(requestTemplate);
+}
+
+
+VisionRequestItem::VisionRequestItem(std::shared_ptr<const VisionImageContent> content,
+                                     std::shared_ptr<const VisionRequestTemplate> requestTemplate)
+{
+    setImage(content);
+    setTemplate(requestTemplate);
+}
+
+
 VisionRequestItem::~VisionRequestItem()
 {
 }
@@ -109,7 +173,58 @@ void VisionRequestItem::setImage(const ofPixels& pixels,
 {
     ofBuffer buffer;
     ofSaveImage(pixels, buffer, format, quality);
-    setImage(buffer);
+    setImage(std::move(buffer));
+}
+
+
+void VisionRequestItem::setImage(const ofPixels& pixels,
+                                 const ofRectangle& region,
+                                 float padding,
+                                 ofImageFormat format,
+                                 ofImageQualityType quality)
+{
+    ofRectangle padded = region.getStandardized();
+    padded.x -= padding;
+    padded.y -= padding;
+    padded.width += 2 * padding;
+    padded.height += 2 * padding;
+
+    float x0 = std::max(0.0f, std::floor(padded.getMinX()));
+    float y0 = std::max(0.0f, std::floor(padded.getMinY()));
+    float x1 = std::min(float(pixels.getWidth()), std::ceil(padded.getMaxX()));
+    float y1 = std::min(float(pixels.getHeight()), std::ceil(padded.getMaxY()));
+
+    if (x1 <= x0 || y1 <= y0)
+    {
+        ofLogWarning("VisionRequestItem::setImage") << "Region " << region << " is outside of the image, sending the entire image.";
+        setImage(pixels, format, quality);
+        return;
+    }
+
+    ofPixels cropped;
+    pixels.cropTo(cropped, x0, y0, x1 - x0, y1 - y0);
+    setImage(cropped, format, quality);
+
+    _region.set(x0, y0, x1 - x0, y1 - y0);
+}
+
+
+void VisionRequestItem::setImage(const ofPixels& pixels,
+                                 const VisionImageEncoder::Settings& settings)
+{
+    static thread_local VisionImageEncoder encoder;
+    setImage(pixels, settings, encoder);
+}
+
+
+void VisionRequestItem::setImage(const ofPixels& pixels,
+                                 const VisionImageEncoder::Settings& settings,
+                                 VisionImageEncoder& encoder)
+{
+    ofBuffer buffer;
+    auto result = encoder.encode(pixels, settings, buffer);
+    setImage(std::move(buffer));
+    _encodingResult = result;
 }
 
 
@@ -119,29 +234,79 @@ void VisionRequestItem::setImage(const std::string& uri)
     {
         _json["image"].clear();
         _json["image"]["source"]["gcs_image_uri"] = uri;
+        _content.reset();
+        _encodingResult = VisionImageEncoder::Result();
+        _region = ofRectangle();
     }
     else
     {
-        setImage(ofBufferFromFile(uri));
+        try
+        {
+            setImage(std::make_shared<MappedFileImageContent>(uri));
+        }
+        catch (const Poco::Exception& exc)
+        {
+            ofLogError("VisionRequestItem::setImage") << "Unable to map " << uri << ": " << exc.displayText();
+            setImage(ofBuffer());
+        }
     }
 }
 
 
 void VisionRequestItem::setImage(const ofBuffer& buffer)
 {
-    _json["image"].clear();
-    _json["image"]["content"] = IO::Base64Encoding::encode(IO::ByteBuffer(buffer));
+    setImage(std::make_shared<BufferImageContent>(buffer));
+}
+
+
+void VisionRequestItem::setImage(ofBuffer&& buffer)
+{
+    setImage(std::make_shared<BufferImageContent>(std::move(buffer)));
+}
+
+
+void VisionRequestItem::setImage(std::shared_ptr<const VisionImageContent> content)
+{
+    if (_json.is_object())
+    {
+        _json.erase("image");
+    }
+
+    _content = content;
+    _encodingResult = VisionImageEncoder::Result();
+    _region = ofRectangle();
+}
+
+
+void VisionRequestItem::setTemplate(std::shared_ptr<const VisionRequestTemplate> requestTemplate)
+{
+    if (_json.is_object())
+    {
+        _json.erase("features");
+        _json.erase("imageContext");
+    }
+
+    _template = requestTemplate;
+}
+
+
+std::shared_ptr<const VisionRequestTemplate> VisionRequestItem::requestTemplate() const
+{
+    return _template;
 }
 
 
 void VisionRequestItem::addFeature(const Feature& feature)
 {
+    detachTemplate();
     _json["features"].push_back(feature.json());
 }
 
 
 void VisionRequestItem::setFeatures(const std::vector<Feature>& features)
 {
+    detachTemplate();
+
     _json["features"].clear();
 
     for (auto& feature: features)
@@ -155,9 +320,9 @@ void VisionRequestItem::addAllFeatures()
 {
     std::vector<Feature> features;
 
-    for (auto& feature: Feature::TYPE_STRINGS)
+    for (std::size_t i = 0; i < sizeof(Feature::TYPE_NAMES) / sizeof(const char*); ++i)
     {
-        features.push_back(Feature(feature.first));
+        features.push_back(Feature(static_cast<Feature::Type>(i)));
     }
 
     setFeatures(features);
@@ -169,6 +334,8 @@ void VisionRequestItem::setLatitudeLongitudeBounds(double minLatitude,
                                                    double maxLatitude,
                                                    double maxLongitude)
 {
+    detachTemplate();
+
     _json["imageContext"]["latLongRect"] = {
         "minLatLng", {
             { "latitude", minLatitude },
@@ -183,6 +350,8 @@ void VisionRequestItem::setLatitudeLongitudeBounds(double minLatitude,
 
 void VisionRequestItem::setLanguageHints(const std::vector<std::string>& languages)
 {
+    detachTemplate();
+
     _json["imageContext"]["languageHints"].clear();
 
     for (auto& language: languages)
@@ -194,14 +363,90 @@ void VisionRequestItem::setLanguageHints(const std::vector<std::string>& languag
 
 void VisionRequestItem::addLanguageHint(const std::string& language)
 {
+    detachTemplate();
+
     _json["imageContext"]["languageHints"].push_back(language);
 }
 
 
-const ofJson& VisionRequestItem::json() const
+ofJson VisionRequestItem::json() const
+{
+    ofJson json = _json;
+
+    if (_template)
+    {
+        const auto& parameters = _template->json();
+
+        for (auto iter = parameters.cbegin(); iter != parameters.cend(); ++iter)
+        {
+            json[iter.key()] = iter.value();
+        }
+    }
+
+    if (_content)
+    {
+        json["image"]["content"] = _content->toBase64();
+    }
+
+    return json;
+}
+
+
+const ofJson& VisionRequestItem::parameters() const
 {
     return _json;
 }
 
 
+std::shared_ptr<const VisionImageContent> VisionRequestItem::content() const
+{
+    return _content;
+}
+
+
+const VisionImageEncoder::Result& VisionRequestItem::encodingResult() const
+{
+    return _encodingResult;
+}
+
+
+void VisionRequestItem::detachTemplate()
+{
+    if (_template)
+    {
+        const auto& parameters = _template->json();
+
+        for (auto iter = parameters.cbegin(); iter != parameters.cend(); ++iter)
+        {
+            _json[iter.key()] = iter.value();
+        }
+
+        _template.reset();
+    }
+}
+
+
+const ofRectangle& VisionRequestItem::region() const
+{
+    return _region;
+}
+
+
+std::vector<VisionRequestItem> VisionRequestItem::fromRegions(const ofPixels& pixels,
+                                                              const std::vector<ofRectangle>& regions,
+                                                              float padding,
+                                                              const std::vector<Feature>& features)
+{
+    std::vector<VisionRequestItem> items;
+    items.reserve(regions.size());
+
+    for (const auto& region: regions)
+    {
+        items.push_back(VisionRequestItem(pixels, region, padding, features));
+    }
+
+    return items;
+}
+
+
 } } // namespace ofx::CloudPlatform
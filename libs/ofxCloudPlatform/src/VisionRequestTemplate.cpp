@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+#include "ofx/CloudPlatform/VisionHash.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+VisionRequestTemplate::VisionRequestTemplate(const std::vector<VisionRequestItem::Feature>& features)
+{
+    setFeatures(features);
+}
+
+
+VisionRequestTemplate::~VisionRequestTemplate()
+{
+}
+
+
+void VisionRequestTemplate::addFeature(const VisionRequestItem::Feature& feature)
+{
+    _json["features"].push_back(feature.json());
+    render();
+}
+
+
+void VisionRequestTemplate::setFeatures(const std::vector<VisionRequestItem::Feature>& features)
+{
+    ofJson json = ofJson::array();
+
+    for (const auto& feature: features)
+    {
+        json.push_back(feature.json());
+    }
+
+    _json["features"] = json;
+    render();
+}
+
+
+void VisionRequestTemplate::setLatitudeLongitudeBounds(double minLatitude,
+                                                       double minLongitude,
+                                                       double maxLatitude,
+                                                       double maxLongitude)
+{
+    _json["imageContext"]["latLongRect"] = {
+        { "minLatLng", {
+            { "latitude", minLatitude },
+            { "longitude", minLongitude }
+        }},
+        { "maxLatLng", {
+            { "latitude", maxLatitude },
+            { "longitude", maxLongitude }
+        }}
+    };
+
+    render();
+}
+
+
+void VisionRequestTemplate::setLanguageHints(const std::vector<std::string>& languages)
+{
+    _json["imageContext"]["languageHints"] = languages;
+    render();
+}
+
+
+void VisionRequestTemplate::addLanguageHint(const std::string& language)
+{
+    _json["imageContext"]["languageHints"].push_back(language);
+    render();
+}
+
+
+const ofJson& VisionRequestTemplate::json() const
+{
+    return _json;
+}
+
+
+const std::string& VisionRequestTemplate::fragment() const
+{
+    return _fragment;
+}
+
+
+uint64_t VisionRequestTemplate::hash() const
+{
+    return _hash;
+}
+
+
+void VisionRequestTemplate::render()
+{
+    std::string text = _json.dump();
+
+    // Strip the enclosing braces.
+    _fragment = text.size() > 2 ? text.substr(1, text.size() - 2) : std::string();
+    _hash = VisionHash::hash(_fragment);
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -6,6 +6,9 @@
 
 
 #include "ofx/CloudPlatform/VisionResponse.h"
+#include "ofx/CloudPlatform/VisionDeserializer.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
 
 
 namespace ofx {
@@ -24,59 +27,203 @@ AnnotateImageResponse::~AnnotateImageResponse()
 
 const std::vector<FaceAnnotation>& AnnotateImageResponse::faceAnnotations() const
 {
+    if (_lazy) return decode(_lazy->faceAnnotations);
     return _faceAnnotations;
 }
 
 
 const std::vector<EntityAnnotation>& AnnotateImageResponse::landmarkAnnotations() const
 {
+    if (_lazy) return decode(_lazy->landmarkAnnotations);
     return _landmarkAnnotations;
 }
 
 
 const std::vector<EntityAnnotation>& AnnotateImageResponse::logoAnnotations() const
 {
+    if (_lazy) return decode(_lazy->logoAnnotations);
     return _logoAnnotations;
 }
 
 
 const std::vector<EntityAnnotation>& AnnotateImageResponse::labelAnnotations() const
 {
+    if (_lazy) return decode(_lazy->labelAnnotations);
     return _labelAnnotations;
 }
 
 
 const std::vector<EntityAnnotation>& AnnotateImageResponse::textAnnotations() const
 {
+    if (_lazy) return decode(_lazy->textAnnotations);
     return _textAnnotations;
 }
 
 
 const SafeSearchAnnotation& AnnotateImageResponse::safeSearchAnnotation() const
 {
+    if (_lazy) return decode(_lazy->safeSearchAnnotation);
     return _safeSearchAnnotation;
 }
 
 
 const ImagePropertiesAnnotation& AnnotateImageResponse::imagePropertiesAnnotation() const
 {
+    if (_lazy) return decode(_lazy->imagePropertiesAnnotation);
     return _imagePropertiesAnnotation;
 }
 
     
 const CropHintsAnnotation& AnnotateImageResponse::cropHintsAnnotation() const
 {
+    if (_lazy) return decode(_lazy->cropHintsAnnotation);
     return _cropHintsAnnotation;
 }
+
+
+const TextAnnotation& AnnotateImageResponse::fullTextAnnotation() const
+{
+    if (_lazy) return decode(_lazy->fullTextAnnotation);
+    return _fullTextAnnotation;
+}
+
+
+const WebDetection& AnnotateImageResponse::webDetection() const
+{
+    if (_lazy) return decode(_lazy->webDetection);
+    return _webDetection;
+}
     
     
-ofJson AnnotateImageResponse::json() const
+bool AnnotateImageResponse::hasError() const
+{
+    return _hasError;
+}
+
+
+int AnnotateImageResponse::errorCode() const
+{
+    return _errorCode;
+}
+
+
+const std::string& AnnotateImageResponse::errorMessage() const
+{
+    return _errorMessage;
+}
+
+
+const ofJson& AnnotateImageResponse::json() const
+{
+    static const ofJson null;
+    return _json ? *_json : null;
+}
+
+
+bool AnnotateImageResponse::hasJSON() const
 {
-    return _json;
+    return _json != nullptr;
+}
+
+
+std::size_t AnnotateImageResponse::memoryFootprint() const
+{
+    std::size_t size = sizeof(AnnotateImageResponse) + _errorMessage.capacity();
+
+    for (const auto& annotation: _faceAnnotations) size += annotation.memoryFootprint();
+    for (const auto& annotation: _landmarkAnnotations) size += annotation.memoryFootprint();
+    for (const auto& annotation: _logoAnnotations) size += annotation.memoryFootprint();
+    for (const auto& annotation: _labelAnnotations) size += annotation.memoryFootprint();
+    for (const auto& annotation: _textAnnotations) size += annotation.memoryFootprint();
+
+    size += _imagePropertiesAnnotation.dominantColors().size() * sizeof(ColorInfo);
+
+    for (const auto& hint: _cropHintsAnnotation.cropHints())
+    {
+        size += sizeof(CropHint) + hint.boundingPoly().size() * sizeof(glm::vec3);
+    }
+
+    // The objects themselves are already counted.
+    size += _fullTextAnnotation.memoryFootprint() - sizeof(TextAnnotation);
+    size += _webDetection.memoryFootprint() - sizeof(WebDetection);
+
+    if (_lazy)
+    {
+        size += sizeof(LazyState);
+        size += memoryFootprint(_lazy->faceAnnotations);
+        size += memoryFootprint(_lazy->landmarkAnnotations);
+        size += memoryFootprint(_lazy->logoAnnotations);
+        size += memoryFootprint(_lazy->labelAnnotations);
+        size += memoryFootprint(_lazy->textAnnotations);
+        size += memoryFootprint(_lazy->imagePropertiesAnnotation);
+        size += memoryFootprint(_lazy->cropHintsAnnotation);
+        size += memoryFootprint(_lazy->fullTextAnnotation);
+        size += memoryFootprint(_lazy->webDetection);
+    }
+
+    if (_json)
+    {
+        size += VisionDeserializer::memoryFootprint(*_json);
+    }
+
+    return size;
+}
+
+
+bool AnnotateImageResponse::isLazy() const
+{
+    return _lazy != nullptr;
 }
     
 
-AnnotateImageResponse AnnotateImageResponse::fromJSON(const ofJson& json)
+namespace {
+
+
+/// \brief AnnotateImageResponse json keys.
+enum
+{
+    RESPONSE_FACES,
+    RESPONSE_LANDMARKS,
+    RESPONSE_LOGOS,
+    RESPONSE_LABELS,
+    RESPONSE_TEXT,
+    RESPONSE_SAFE_SEARCH,
+    RESPONSE_IMAGE_PROPERTIES,
+    RESPONSE_CROP_HINTS,
+    RESPONSE_FULL_TEXT,
+    RESPONSE_WEB_DETECTION,
+    RESPONSE_ERROR,
+    NUM_RESPONSE_KEYS
+};
+
+
+constexpr const char* RESPONSE_KEY_NAMES[NUM_RESPONSE_KEYS] =
+{
+    "faceAnnotations",
+    "landmarkAnnotations",
+    "logoAnnotations",
+    "labelAnnotations",
+    "textAnnotations",
+    "safeSearchAnnotation",
+    "imagePropertiesAnnotation",
+    "cropHintsAnnotation",
+    "fullTextAnnotation",
+    "webDetection",
+    "error"
+};
+
+
+constexpr VisionKeyTable<NUM_RESPONSE_KEYS> RESPONSE_KEYS(RESPONSE_KEY_NAMES);
+
+
+static_assert(RESPONSE_KEYS.isValid(), "No perfect hash for AnnotateImageResponse keys.");
+
+
+}
+
+
+AnnotateImageResponse AnnotateImageResponse::fromJSON(const ofJson& json,
+                                                      bool retainJSON)
 {
     AnnotateImageResponse annotation;
     auto iter = json.cbegin();
@@ -85,50 +232,253 @@ AnnotateImageResponse AnnotateImageResponse::fromJSON(const ofJson& json)
         const auto& key = iter.key();
         const auto& value = iter.value();
 
-        if (key == "faceAnnotations")
+        switch (RESPONSE_KEYS.find(key))
         {
-            for (const auto& _annotation: value)
-                annotation._faceAnnotations.push_back(FaceAnnotation::fromJSON(_annotation));
+            case RESPONSE_FACES:
+                for (const auto& _annotation: value)
+                    annotation._faceAnnotations.push_back(FaceAnnotation::fromJSON(_annotation));
+                break;
+            case RESPONSE_LANDMARKS:
+                for (const auto& _annotation: value)
+                    annotation._landmarkAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
+                break;
+            case RESPONSE_LOGOS:
+                for (const auto& _annotation: value)
+                    annotation._logoAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
+                break;
+            case RESPONSE_LABELS:
+                for (const auto& _annotation: value)
+                    annotation._labelAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
+                break;
+            case RESPONSE_TEXT:
+                for (const auto& _annotation: value)
+                    annotation._textAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
+                break;
+            case RESPONSE_SAFE_SEARCH:
+                annotation._safeSearchAnnotation = SafeSearchAnnotation::fromJSON(value);
+                break;
+            case RESPONSE_IMAGE_PROPERTIES:
+                annotation._imagePropertiesAnnotation = ImagePropertiesAnnotation::fromJSON(value);
+                break;
+            case RESPONSE_CROP_HINTS:
+                annotation._cropHintsAnnotation = CropHintsAnnotation::fromJSON(value);
+                break;
+            case RESPONSE_FULL_TEXT:
+                annotation._fullTextAnnotation = TextAnnotation::fromJSON(value);
+                break;
+            case RESPONSE_WEB_DETECTION:
+                annotation._webDetection = WebDetection::fromJSON(value);
+                break;
+            case RESPONSE_ERROR:
+                annotation.setError(value);
+                break;
+            default: VisionParseDiagnostics::unknownKey("AnnotateImageResponse", key, value);
         }
-        else if (key == "landmarkAnnotations")
-        {
-            for (const auto& _annotation: value)
-                annotation._landmarkAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
-        }
-        else if (key == "logoAnnotations")
-        {
-            for (const auto& _annotation: value)
-                annotation._logoAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
-        }
-        else if (key == "labelAnnotations")
-        {
-            for (const auto& _annotation: value)
-                annotation._labelAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
-        }
-        else if (key == "textAnnotations")
+
+        ++iter;
+    }
+
+    if (retainJSON)
+    {
+        annotation._json = std::make_shared<const ofJson>(json);
+    }
+
+    return annotation;
+}
+
+
+AnnotateImageResponse AnnotateImageResponse::fromJSONLazy(std::shared_ptr<const ofJson> json)
+{
+    AnnotateImageResponse annotation;
+    annotation._lazy = std::make_shared<LazyState>();
+
+    auto& state = *annotation._lazy;
+    annotation._json = json;
+
+    if (!json)
+    {
+        return annotation;
+    }
+
+    auto iter = json->cbegin();
+    while (iter != json->cend())
+    {
+        const auto& key = iter.key();
+        const ofJson* value = &iter.value();
+
+        switch (RESPONSE_KEYS.find(key))
         {
-            for (const auto& _annotation: value)
-                annotation._textAnnotations.push_back(EntityAnnotation::fromJSON(_annotation));
+            case RESPONSE_FACES: state.faceAnnotations.json = value; break;
+            case RESPONSE_LANDMARKS: state.landmarkAnnotations.json = value; break;
+            case RESPONSE_LOGOS: state.logoAnnotations.json = value; break;
+            case RESPONSE_LABELS: state.labelAnnotations.json = value; break;
+            case RESPONSE_TEXT: state.textAnnotations.json = value; break;
+            case RESPONSE_SAFE_SEARCH: state.safeSearchAnnotation.json = value; break;
+            case RESPONSE_IMAGE_PROPERTIES: state.imagePropertiesAnnotation.json = value; break;
+            case RESPONSE_CROP_HINTS: state.cropHintsAnnotation.json = value; break;
+            case RESPONSE_FULL_TEXT: state.fullTextAnnotation.json = value; break;
+            case RESPONSE_WEB_DETECTION: state.webDetection.json = value; break;
+            case RESPONSE_ERROR: annotation.setError(*value); break;
+            default: VisionParseDiagnostics::unknownKey("AnnotateImageResponse", key, *value);
         }
-        else if (key == "safeSearchAnnotation")
+
+        ++iter;
+    }
+
+    return annotation;
+}
+
+
+template <typename T>
+const std::vector<T>& AnnotateImageResponse::decode(LazySection<std::vector<T>>& section)
+{
+    std::call_once(section.flag, [&section] {
+        if (section.json)
         {
-            annotation._safeSearchAnnotation = SafeSearchAnnotation::fromJSON(value);
+            section.value.reserve(section.json->size());
+
+            for (const auto& value: *section.json)
+                section.value.push_back(T::fromJSON(value));
         }
-        else if (key == "imagePropertiesAnnotation")
+
+        section.decoded = true;
+    });
+
+    return section.value;
+}
+
+
+template <typename T>
+const T& AnnotateImageResponse::decode(LazySection<T>& section)
+{
+    std::call_once(section.flag, [&section] {
+        if (section.json)
+            section.value = T::fromJSON(*section.json);
+
+        section.decoded = true;
+    });
+
+    return section.value;
+}
+
+
+template <typename T>
+std::size_t AnnotateImageResponse::memoryFootprint(const LazySection<std::vector<T>>& section)
+{
+    std::size_t size = 0;
+
+    if (section.decoded)
+    {
+        for (const auto& annotation: section.value)
+            size += annotation.memoryFootprint();
+    }
+
+    return size;
+}
+
+
+std::size_t AnnotateImageResponse::memoryFootprint(const LazySection<ImagePropertiesAnnotation>& section)
+{
+    return section.decoded ? section.value.dominantColors().size() * sizeof(ColorInfo) : 0;
+}
+
+
+std::size_t AnnotateImageResponse::memoryFootprint(const LazySection<CropHintsAnnotation>& section)
+{
+    std::size_t size = 0;
+
+    if (section.decoded)
+    {
+        for (const auto& hint: section.value.cropHints())
+            size += sizeof(CropHint) + hint.boundingPoly().size() * sizeof(glm::vec3);
+    }
+
+    return size;
+}
+
+
+std::size_t AnnotateImageResponse::memoryFootprint(const LazySection<TextAnnotation>& section)
+{
+    return section.decoded ? section.value.memoryFootprint() - sizeof(TextAnnotation) : 0;
+}
+
+
+std::size_t AnnotateImageResponse::memoryFootprint(const LazySection<WebDetection>& section)
+{
+    return section.decoded ? section.value.memoryFootprint() - sizeof(WebDetection) : 0;
+}
+
+
+void AnnotateImageResponse::setError(const ofJson& json)
+{
+    _hasError = true;
+    _errorCode = json.value("code", 0);
+    _errorMessage = json.value("message", std::string());
+}
+
+
+AnnotateImageResponse AnnotateImageResponse::fromJSON(const ofJson& json,
+                                                      const glm::vec2& offset,
+                                                      bool retainJSON)
+{
+    if (offset.x == 0 && offset.y == 0)
+    {
+        return fromJSON(json, retainJSON);
+    }
+
+    auto translated = std::make_shared<ofJson>(json);
+    translate(*translated, offset);
+
+    auto annotation = fromJSON(*translated, false);
+
+    if (retainJSON)
+    {
+        annotation._json = translated;
+    }
+
+    return annotation;
+}
+
+
+void AnnotateImageResponse::translate(ofJson& json, const glm::vec2& offset)
+{
+    if (offset.x == 0 && offset.y == 0)
+    {
+        return;
+    }
+
+    if (json.is_array())
+    {
+        for (auto& value: json)
         {
-            annotation._imagePropertiesAnnotation = ImagePropertiesAnnotation::fromJSON(value);
+            translate(value, offset);
         }
-        else if (key == "cropHintsAnnotation")
+    }
+    else if (json.is_object())
+    {
+        for (auto iter = json.begin(); iter != json.end(); ++iter)
         {
-            annotation._cropHintsAnnotation = CropHintsAnnotation::fromJSON(value);
+            // Zero coordinates are omitted by the API, so they are added here.
+            if (iter.key() == "vertices" && iter.value().is_array())
+            {
+                for (auto& vertex: iter.value())
+                {
+                    vertex["x"] = vertex.value("x", 0.0f) + offset.x;
+                    vertex["y"] = vertex.value("y", 0.0f) + offset.y;
+                }
+            }
+            else if (iter.key() == "position" && iter.value().is_object())
+            {
+                auto& position = iter.value();
+                position["x"] = position.value("x", 0.0f) + offset.x;
+                position["y"] = position.value("y", 0.0f) + offset.y;
+            }
+            else if (iter.key() != "normalizedVertices")
+            {
+                translate(iter.value(), offset);
+            }
         }
-        else ofLogWarning("AnnotateImageResponse::fromJSON") << "Unknown key: " << key;
-
-        ++iter;
     }
-
-    annotation._json = json;
-    return annotation;
 }
 
 
@@ -0,0 +1,1158 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionSnapshot.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include "Poco/File.h"
+#include "ofUtils.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+// The sizes are part of the file format.
+static_assert(sizeof(VisionSnapshot::FileHeader) == 40, "Unexpected FileHeader size.");
+static_assert(sizeof(VisionSnapshot::RecordHeader) == 252, "Unexpected RecordHeader size.");
+static_assert(sizeof(VisionSnapshot::Face) == 52, "Unexpected Face size.");
+static_assert(sizeof(VisionSnapshot::Landmark) == 16, "Unexpected Landmark size.");
+static_assert(sizeof(VisionSnapshot::Entity) == 44, "Unexpected Entity size.");
+static_assert(sizeof(VisionSnapshot::Color) == 12, "Unexpected Color size.");
+static_assert(sizeof(VisionSnapshot::CropHint) == 16, "Unexpected CropHint size.");
+static_assert(sizeof(TextAnnotation::Symbol) == 56, "Unexpected TextAnnotation::Symbol size.");
+static_assert(std::is_trivially_copyable<TextAnnotation::Block>::value, "TextAnnotation::Block must be trivially copyable.");
+static_assert(std::is_trivially_copyable<WebDetection::WebPage>::value, "WebDetection::WebPage must be trivially copyable.");
+
+
+/// \brief Every record and section starts on this boundary.
+constexpr std::size_t ALIGNMENT = 8;
+
+
+/// \brief The element size of each section.
+constexpr std::size_t SECTION_ELEMENT_SIZES[VisionSnapshot::NUM_SECTIONS] =
+{
+    sizeof(VisionSnapshot::Face),
+    sizeof(VisionSnapshot::Landmark),
+    sizeof(glm::vec3),
+    sizeof(VisionSnapshot::Entity),
+    sizeof(VisionSnapshot::Entity),
+    sizeof(VisionSnapshot::Entity),
+    sizeof(VisionSnapshot::Entity),
+    sizeof(VisionSnapshot::Location),
+    sizeof(VisionSnapshot::Property),
+    sizeof(VisionSnapshot::Color),
+    sizeof(VisionSnapshot::CropHint),
+    sizeof(TextAnnotation::Page),
+    sizeof(TextAnnotation::Block),
+    sizeof(TextAnnotation::Paragraph),
+    sizeof(TextAnnotation::Word),
+    sizeof(TextAnnotation::Symbol),
+    sizeof(TextAnnotation::DetectedLanguage),
+    sizeof(char),
+    sizeof(WebDetection::WebEntity),
+    sizeof(WebDetection::WebImage),
+    sizeof(WebDetection::WebImage),
+    sizeof(WebDetection::WebPage),
+    sizeof(WebDetection::WebImage),
+    sizeof(WebDetection::WebLabel),
+    sizeof(WebDetection::WebImage),
+    sizeof(VisionSnapshot::StringEntry),
+    sizeof(char)
+};
+
+
+std::size_t align(std::size_t offset)
+{
+    return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+
+/// \returns true if a half-open range lies within [0, size).
+template <typename Range>
+bool inRange(const Range& range, std::size_t size)
+{
+    return range.begin <= range.end && range.end <= size;
+}
+
+
+bool isKnown(Likelihood::Type type)
+{
+    return type <= Likelihood::Type::VERY_LIKELY;
+}
+
+
+bool isKnown(FaceAnnotation::Landmark::Type type)
+{
+    return static_cast<std::size_t>(type) < FaceAnnotation::Landmark::NUM_TYPES;
+}
+
+
+bool isKnown(TextAnnotation::BreakType type)
+{
+    return type <= TextAnnotation::BreakType::LINE_BREAK;
+}
+
+
+bool isKnown(TextAnnotation::BlockType type)
+{
+    return type <= TextAnnotation::BlockType::BARCODE;
+}
+
+
+/// \returns true if a mapped bool holds 0 or 1, checked through its byte.
+bool isBool(const bool& value)
+{
+    uint8_t byte = 0;
+    std::memcpy(&byte, &value, 1);
+    return byte <= 1;
+}
+
+
+/// \brief Builds the sections of a single record.
+class RecordBuilder
+{
+public:
+    RecordBuilder()
+    {
+        // String 0 is the empty string.
+        add(std::string());
+    }
+
+    template <typename T>
+    void append(VisionSnapshot::Section section, const T& value)
+    {
+        append(section, &value, 1);
+    }
+
+    template <typename T>
+    void append(VisionSnapshot::Section section, const T* values, std::size_t count)
+    {
+        _sections[section].append(reinterpret_cast<const char*>(values), count * sizeof(T));
+    }
+
+    template <typename T>
+    void append(VisionSnapshot::Section section, const std::vector<T>& values)
+    {
+        append(section, values.data(), values.size());
+    }
+
+    uint32_t count(VisionSnapshot::Section section) const
+    {
+        return static_cast<uint32_t>(_sections[section].size() / SECTION_ELEMENT_SIZES[section]);
+    }
+
+    VisionSnapshot::Range polyline(const ofPolyline& polyline)
+    {
+        VisionSnapshot::Range range;
+        range.begin = count(VisionSnapshot::VERTICES);
+        append(VisionSnapshot::VERTICES, polyline.getVertices());
+        range.end = count(VisionSnapshot::VERTICES);
+        return range;
+    }
+
+    /// \brief Add a string to the string table without interning it.
+    VisionSnapshot::StringId add(const std::string& text)
+    {
+        VisionSnapshot::StringEntry entry;
+        entry.offset = static_cast<uint32_t>(_sections[VisionSnapshot::STRING_DATA].size());
+        entry.size = static_cast<uint32_t>(text.size());
+        _sections[VisionSnapshot::STRING_DATA].append(text.c_str(), text.size() + 1);
+
+        VisionSnapshot::StringId id = count(VisionSnapshot::STRINGS);
+        append(VisionSnapshot::STRINGS, entry);
+        return id;
+    }
+
+    /// \brief Add a string to the string table, reusing an equal string.
+    VisionSnapshot::StringId intern(const std::string& text)
+    {
+        if (text.empty())
+        {
+            return 0;
+        }
+
+        auto iter = _index.find(text);
+
+        if (iter == _index.end())
+        {
+            iter = _index.emplace(text, add(text)).first;
+        }
+
+        return iter->second;
+    }
+
+    void entities(VisionSnapshot::Section section,
+                  const std::vector<EntityAnnotation>& annotations)
+    {
+        for (const auto& annotation: annotations)
+        {
+            VisionSnapshot::Entity entity;
+            entity.mid = intern(annotation.mid());
+            entity.locale = intern(annotation.locale());
+            entity.description = intern(annotation.description());
+            entity.score = annotation.score();
+            entity.topicality = annotation.topicality();
+            entity.boundingPoly = polyline(annotation.boundingPoly());
+
+            entity.locations.begin = count(VisionSnapshot::LOCATIONS);
+            for (const auto& latLng: annotation.locations())
+            {
+                VisionSnapshot::Location location;
+                location.latitude = latLng.first;
+                location.longitude = latLng.second;
+                append(VisionSnapshot::LOCATIONS, location);
+            }
+            entity.locations.end = count(VisionSnapshot::LOCATIONS);
+
+            entity.properties.begin = count(VisionSnapshot::PROPERTIES);
+            for (const auto& nameValue: annotation.properties())
+            {
+                VisionSnapshot::Property property;
+                property.name = intern(nameValue.first);
+                property.value = intern(nameValue.second);
+                append(VisionSnapshot::PROPERTIES, property);
+            }
+            entity.properties.end = count(VisionSnapshot::PROPERTIES);
+
+            append(section, entity);
+        }
+    }
+
+    /// \brief Write the header and aligned sections to a buffer.
+    void finish(VisionSnapshot::RecordHeader& header, std::string& buffer) const
+    {
+        std::size_t start = buffer.size();
+        std::size_t offset = align(sizeof(VisionSnapshot::RecordHeader));
+
+        for (std::size_t i = 0; i < VisionSnapshot::NUM_SECTIONS; ++i)
+        {
+            auto section = static_cast<VisionSnapshot::Section>(i);
+            header.sections[i].offset = static_cast<uint32_t>(offset);
+            header.sections[i].count = count(section);
+            offset = align(offset + _sections[i].size());
+        }
+
+        header.size = static_cast<uint32_t>(offset);
+
+        buffer.resize(start + offset, '\0');
+        std::memcpy(&buffer[start], &header, sizeof(header));
+
+        for (std::size_t i = 0; i < VisionSnapshot::NUM_SECTIONS; ++i)
+        {
+            if (!_sections[i].empty())
+            {
+                std::memcpy(&buffer[start + header.sections[i].offset],
+                            _sections[i].data(),
+                            _sections[i].size());
+            }
+        }
+    }
+
+private:
+    std::array<std::string, VisionSnapshot::NUM_SECTIONS> _sections;
+
+    std::unordered_map<std::string, VisionSnapshot::StringId> _index;
+
+};
+
+
+}
+
+
+VisionSnapshot::Record::Record(const char* data): _data(data)
+{
+}
+
+
+const VisionSnapshot::RecordHeader& VisionSnapshot::Record::header() const
+{
+    return *reinterpret_cast<const RecordHeader*>(_data);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Face> VisionSnapshot::Record::faces() const
+{
+    return section<Face>(FACES);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Landmark> VisionSnapshot::Record::landmarks(const Face& face) const
+{
+    return section<Landmark>(LANDMARKS, face.landmarks);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Entity> VisionSnapshot::Record::landmarkAnnotations() const
+{
+    return section<Entity>(LANDMARK_ANNOTATIONS);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Entity> VisionSnapshot::Record::logoAnnotations() const
+{
+    return section<Entity>(LOGO_ANNOTATIONS);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Entity> VisionSnapshot::Record::labelAnnotations() const
+{
+    return section<Entity>(LABEL_ANNOTATIONS);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Entity> VisionSnapshot::Record::textAnnotations() const
+{
+    return section<Entity>(TEXT_ANNOTATIONS);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Location> VisionSnapshot::Record::locations(const Entity& entity) const
+{
+    return section<Location>(LOCATIONS, entity.locations);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Property> VisionSnapshot::Record::properties(const Entity& entity) const
+{
+    return section<Property>(PROPERTIES, entity.properties);
+}
+
+
+const VisionSnapshot::SafeSearch& VisionSnapshot::Record::safeSearch() const
+{
+    return header().safeSearch;
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::Color> VisionSnapshot::Record::dominantColors() const
+{
+    return section<Color>(COLORS);
+}
+
+
+VisionSnapshot::ArrayView<VisionSnapshot::CropHint> VisionSnapshot::Record::cropHints() const
+{
+    return section<CropHint>(CROP_HINTS);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::Page> VisionSnapshot::Record::textPages() const
+{
+    return section<TextAnnotation::Page>(TEXT_PAGES);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::Block> VisionSnapshot::Record::textBlocks() const
+{
+    return section<TextAnnotation::Block>(TEXT_BLOCKS);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::Paragraph> VisionSnapshot::Record::textParagraphs() const
+{
+    return section<TextAnnotation::Paragraph>(TEXT_PARAGRAPHS);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::Word> VisionSnapshot::Record::textWords() const
+{
+    return section<TextAnnotation::Word>(TEXT_WORDS);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::Symbol> VisionSnapshot::Record::textSymbols() const
+{
+    return section<TextAnnotation::Symbol>(TEXT_SYMBOLS);
+}
+
+
+VisionSnapshot::ArrayView<TextAnnotation::DetectedLanguage> VisionSnapshot::Record::textLanguages() const
+{
+    return section<TextAnnotation::DetectedLanguage>(TEXT_LANGUAGES);
+}
+
+
+VisionSnapshot::ArrayView<char> VisionSnapshot::Record::text() const
+{
+    return section<char>(TEXT_BUFFER);
+}
+
+
+const char* VisionSnapshot::Record::textLanguageCode(uint32_t code) const
+{
+    const Range& range = header().textLanguageCodes;
+    return code < range.end - range.begin ? string(range.begin + code) : "";
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebEntity> VisionSnapshot::Record::webEntities() const
+{
+    return section<WebDetection::WebEntity>(WEB_ENTITIES);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebImage> VisionSnapshot::Record::webFullMatchingImages() const
+{
+    return section<WebDetection::WebImage>(WEB_FULL_MATCHING_IMAGES);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebImage> VisionSnapshot::Record::webPartialMatchingImages() const
+{
+    return section<WebDetection::WebImage>(WEB_PARTIAL_MATCHING_IMAGES);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebPage> VisionSnapshot::Record::webPagesWithMatchingImages() const
+{
+    return section<WebDetection::WebPage>(WEB_PAGES_WITH_MATCHING_IMAGES);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebImage> VisionSnapshot::Record::webVisuallySimilarImages() const
+{
+    return section<WebDetection::WebImage>(WEB_VISUALLY_SIMILAR_IMAGES);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebLabel> VisionSnapshot::Record::webBestGuessLabels() const
+{
+    return section<WebDetection::WebLabel>(WEB_BEST_GUESS_LABELS);
+}
+
+
+VisionSnapshot::ArrayView<WebDetection::WebImage> VisionSnapshot::Record::webPageImages() const
+{
+    return section<WebDetection::WebImage>(WEB_PAGE_IMAGES);
+}
+
+
+const char* VisionSnapshot::Record::webString(WebDetection::StringId id) const
+{
+    const Range& range = header().webStrings;
+    return id < range.end - range.begin ? string(range.begin + id) : "";
+}
+
+
+VisionSnapshot::ArrayView<glm::vec3> VisionSnapshot::Record::vertices(const Range& polyline) const
+{
+    return section<glm::vec3>(VERTICES, polyline);
+}
+
+
+bool VisionSnapshot::Record::hasError() const
+{
+    return header().hasError != 0;
+}
+
+
+int VisionSnapshot::Record::errorCode() const
+{
+    return header().errorCode;
+}
+
+
+const char* VisionSnapshot::Record::errorMessage() const
+{
+    return string(header().errorMessage);
+}
+
+
+const char* VisionSnapshot::Record::string(StringId id) const
+{
+    auto strings = section<StringEntry>(STRINGS);
+    auto data = section<char>(STRING_DATA);
+
+    // Out of range strings are empty rather than reading past the record.
+    if (id < strings.size()
+    &&  strings[id].size < data.size()
+    &&  strings[id].offset < data.size() - strings[id].size
+    &&  data[strings[id].offset + strings[id].size] == '\0')
+    {
+        return data.data() + strings[id].offset;
+    }
+
+    return "";
+}
+
+
+std::size_t VisionSnapshot::Record::stringSize(StringId id) const
+{
+    return std::strlen(string(id));
+}
+
+
+AnnotateImageResponse VisionSnapshot::Record::response() const
+{
+    validate();
+
+    AnnotateImageResponse response;
+
+    const auto& header = this->header();
+
+    for (const auto& face: faces())
+    {
+        FaceAnnotation annotation;
+        annotation._boundingPoly = polyline(face.boundingPoly);
+        annotation._fdBoundingPoly = polyline(face.fdBoundingPoly);
+
+        auto landmarks = this->landmarks(face);
+        annotation._landmarks.reserve(landmarks.size());
+
+        for (const auto& landmark: landmarks)
+        {
+            annotation._landmarks.emplace_back(landmark.type, landmark.position);
+        }
+
+        annotation._rollAngle = face.rollAngle;
+        annotation._panAngle = face.panAngle;
+        annotation._tiltAngle = face.tiltAngle;
+        annotation._detectionConfidence = face.detectionConfidence;
+        annotation._landmarkingConfidence = face.landmarkingConfidence;
+        annotation._joyLikelihood = Likelihood(face.joy);
+        annotation._sorrowLikelihood = Likelihood(face.sorrow);
+        annotation._angerLikelihood = Likelihood(face.anger);
+        annotation._surpriseLikelihood = Likelihood(face.surprise);
+        annotation._underExposedLikelihood = Likelihood(face.underExposed);
+        annotation._blurredLikelihood = Likelihood(face.blurred);
+        annotation._headwearLikelihood = Likelihood(face.headwear);
+
+        response._faceAnnotations.push_back(std::move(annotation));
+    }
+
+    response._landmarkAnnotations = entities(LANDMARK_ANNOTATIONS);
+    response._logoAnnotations = entities(LOGO_ANNOTATIONS);
+    response._labelAnnotations = entities(LABEL_ANNOTATIONS);
+    response._textAnnotations = entities(TEXT_ANNOTATIONS);
+
+    response._safeSearchAnnotation._adult = Likelihood(header.safeSearch.adult);
+    response._safeSearchAnnotation._spoof = Likelihood(header.safeSearch.spoof);
+    response._safeSearchAnnotation._medical = Likelihood(header.safeSearch.medical);
+    response._safeSearchAnnotation._violence = Likelihood(header.safeSearch.violence);
+    response._safeSearchAnnotation._racy = Likelihood(header.safeSearch.racy);
+
+    for (const auto& color: dominantColors())
+    {
+        ColorInfo info;
+        info._color = ofColor(color.r, color.g, color.b, color.a);
+        info._score = color.score;
+        info._pixelFraction = color.pixelFraction;
+        response._imagePropertiesAnnotation._dominantColors.push_back(info);
+    }
+
+    for (const auto& cropHint: cropHints())
+    {
+        ofx::CloudPlatform::CropHint hint;
+        hint._boundingPoly = polyline(cropHint.boundingPoly);
+        hint._confidence = cropHint.confidence;
+        hint._importanceFraction = cropHint.importanceFraction;
+        response._cropHintsAnnotation._cropHints.push_back(std::move(hint));
+    }
+
+    auto& fullText = response._fullTextAnnotation;
+    auto buffer = text();
+    fullText._text.assign(buffer.begin(), buffer.end());
+    fullText._pages.assign(textPages().begin(), textPages().end());
+    fullText._blocks.assign(textBlocks().begin(), textBlocks().end());
+    fullText._paragraphs.assign(textParagraphs().begin(), textParagraphs().end());
+    fullText._words.assign(textWords().begin(), textWords().end());
+    fullText._symbols.assign(textSymbols().begin(), textSymbols().end());
+    fullText._languages.assign(textLanguages().begin(), textLanguages().end());
+
+    for (StringId id = header.textLanguageCodes.begin; id < header.textLanguageCodes.end; ++id)
+    {
+        fullText._languageCodes.push_back(copy(id));
+    }
+
+    auto& web = response._webDetection;
+    web._webEntities.assign(webEntities().begin(), webEntities().end());
+    web._fullMatchingImages.assign(webFullMatchingImages().begin(), webFullMatchingImages().end());
+    web._partialMatchingImages.assign(webPartialMatchingImages().begin(), webPartialMatchingImages().end());
+    web._pagesWithMatchingImages.assign(webPagesWithMatchingImages().begin(), webPagesWithMatchingImages().end());
+    web._visuallySimilarImages.assign(webVisuallySimilarImages().begin(), webVisuallySimilarImages().end());
+    web._bestGuessLabels.assign(webBestGuessLabels().begin(), webBestGuessLabels().end());
+    web._pageImages.assign(webPageImages().begin(), webPageImages().end());
+
+    for (StringId id = header.webStrings.begin; id < header.webStrings.end; ++id)
+    {
+        web._strings.push_back(copy(id));
+    }
+
+    response._hasError = header.hasError != 0;
+    response._errorCode = header.errorCode;
+    response._errorMessage = copy(header.errorMessage);
+
+    return response;
+}
+
+
+void VisionSnapshot::Record::validate() const
+{
+    const auto& header = this->header();
+
+    const auto& safeSearch = header.safeSearch;
+
+    bool valid = isKnown(safeSearch.adult)
+              && isKnown(safeSearch.spoof)
+              && isKnown(safeSearch.medical)
+              && isKnown(safeSearch.violence)
+              && isKnown(safeSearch.racy);
+
+    auto numStrings = section<StringEntry>(STRINGS).size();
+
+    // Both ranges are copied string by string.
+    valid = valid
+         && inRange(header.textLanguageCodes, numStrings)
+         && inRange(header.webStrings, numStrings);
+
+    for (const auto& face: faces())
+    {
+        valid = valid
+             && isKnown(face.joy)
+             && isKnown(face.sorrow)
+             && isKnown(face.anger)
+             && isKnown(face.surprise)
+             && isKnown(face.underExposed)
+             && isKnown(face.blurred)
+             && isKnown(face.headwear);
+
+        for (const auto& landmark: landmarks(face))
+        {
+            valid = valid && isKnown(landmark.type);
+        }
+    }
+
+    // TextAnnotation ranges index the decoded vectors and text directly.
+    auto numText = text().size();
+    auto numLanguages = textLanguages().size();
+    auto numLanguageCodes = header.textLanguageCodes.end - header.textLanguageCodes.begin;
+
+    for (const auto& page: textPages())
+    {
+        valid = valid
+             && inRange(page.languages, numLanguages)
+             && inRange(page.blocks, textBlocks().size())
+             && inRange(page.text, numText);
+    }
+
+    for (const auto& block: textBlocks())
+    {
+        valid = valid
+             && inRange(block.languages, numLanguages)
+             && inRange(block.paragraphs, textParagraphs().size())
+             && inRange(block.text, numText)
+             && isKnown(block.blockType);
+    }
+
+    for (const auto& paragraph: textParagraphs())
+    {
+        valid = valid
+             && inRange(paragraph.languages, numLanguages)
+             && inRange(paragraph.words, textWords().size())
+             && inRange(paragraph.text, numText);
+    }
+
+    for (const auto& word: textWords())
+    {
+        valid = valid
+             && inRange(word.languages, numLanguages)
+             && inRange(word.symbols, textSymbols().size())
+             && inRange(word.text, numText);
+    }
+
+    for (const auto& symbol: textSymbols())
+    {
+        valid = valid
+             && inRange(symbol.languages, numLanguages)
+             && inRange(symbol.text, numText)
+             && isKnown(symbol.breakType)
+             && isBool(symbol.isPrefix);
+    }
+
+    for (const auto& language: textLanguages())
+    {
+        valid = valid && language.code < numLanguageCodes;
+    }
+
+    // WebDetection string ids are checked by WebDetection::string().
+    for (const auto& page: webPagesWithMatchingImages())
+    {
+        valid = valid
+             && inRange(page.fullMatchingImages, webPageImages().size())
+             && inRange(page.partialMatchingImages, webPageImages().size());
+    }
+
+    if (!valid)
+    {
+        throw Poco::Exception("Invalid snapshot record.");
+    }
+}
+
+
+template <typename T>
+VisionSnapshot::ArrayView<T> VisionSnapshot::Record::section(Section section) const
+{
+    const auto& entry = header().sections[section];
+    return ArrayView<T>(reinterpret_cast<const T*>(_data + entry.offset), entry.count);
+}
+
+
+template <typename T>
+VisionSnapshot::ArrayView<T> VisionSnapshot::Record::section(Section section,
+                                                             const Range& range) const
+{
+    auto all = this->section<T>(section);
+
+    if (range.begin > range.end || range.end > all.size())
+    {
+        return ArrayView<T>();
+    }
+
+    return ArrayView<T>(all.data() + range.begin, range.end - range.begin);
+}
+
+
+std::vector<EntityAnnotation> VisionSnapshot::Record::entities(Section section) const
+{
+    std::vector<EntityAnnotation> annotations;
+
+    auto entities = this->section<Entity>(section);
+    annotations.reserve(entities.size());
+
+    for (const auto& entity: entities)
+    {
+        EntityAnnotation annotation;
+        annotation._mid = copy(entity.mid);
+        annotation._locale = copy(entity.locale);
+        annotation._description = copy(entity.description);
+        annotation._score = entity.score;
+        annotation._topicality = entity.topicality;
+        annotation._boundingPoly = polyline(entity.boundingPoly);
+
+        for (const auto& location: locations(entity))
+        {
+            annotation._locations.push_back(std::make_pair(location.latitude, location.longitude));
+        }
+
+        for (const auto& property: properties(entity))
+        {
+            annotation._properties.insert(std::make_pair(copy(property.name), copy(property.value)));
+        }
+
+        annotations.push_back(std::move(annotation));
+    }
+
+    return annotations;
+}
+
+
+ofPolyline VisionSnapshot::Record::polyline(const Range& range) const
+{
+    ofPolyline polyline;
+
+    for (const auto& vertex: vertices(range))
+    {
+        polyline.addVertex(vertex);
+    }
+
+    return polyline;
+}
+
+
+std::string VisionSnapshot::Record::copy(StringId id) const
+{
+    const char* text = string(id);
+    return std::string(text, std::strlen(text));
+}
+
+
+VisionSnapshot::VisionSnapshot()
+{
+}
+
+
+VisionSnapshot::VisionSnapshot(const std::string& path)
+{
+    open(path);
+}
+
+
+VisionSnapshot::~VisionSnapshot()
+{
+}
+
+
+void VisionSnapshot::open(const std::string& path)
+{
+    close();
+
+    std::string fullPath = ofToDataPath(path, true);
+    Poco::File file(fullPath);
+
+    std::size_t size = static_cast<std::size_t>(file.getSize());
+
+    if (size < sizeof(FileHeader))
+    {
+        throw Poco::Exception("Not a snapshot: " + fullPath);
+    }
+
+    std::unique_ptr<Poco::SharedMemory> memory(new Poco::SharedMemory(file, Poco::SharedMemory::AM_READ));
+
+    const char* data = memory->begin();
+    const FileHeader& header = *reinterpret_cast<const FileHeader*>(data);
+
+    if (std::memcmp(header.magic, FileHeader().magic, sizeof(header.magic)) != 0)
+    {
+        throw Poco::Exception("Not a snapshot: " + fullPath);
+    }
+
+    if (header.version != VERSION || header.byteOrder != FileHeader().byteOrder)
+    {
+        throw Poco::Exception("Unsupported snapshot version or byte order: " + fullPath);
+    }
+
+    // Written as count <= (size - offset) / element size to avoid overflow.
+    if (header.indexOffset % ALIGNMENT != 0
+    ||  header.keysOffset % ALIGNMENT != 0
+    ||  header.indexOffset > size
+    ||  header.keysOffset > size
+    ||  header.count > (size - header.indexOffset) / sizeof(IndexEntry)
+    ||  header.count > (size - header.keysOffset) / sizeof(KeyEntry))
+    {
+        throw Poco::Exception("Truncated snapshot: " + fullPath);
+    }
+
+    _path = fullPath;
+    _memory = std::move(memory);
+    _data = data;
+    _size = size;
+    _count = static_cast<std::size_t>(header.count);
+    _index = reinterpret_cast<const IndexEntry*>(data + header.indexOffset);
+    _keys = reinterpret_cast<const KeyEntry*>(data + header.keysOffset);
+}
+
+
+void VisionSnapshot::close()
+{
+    _memory.reset();
+    _path.clear();
+    _data = nullptr;
+    _size = 0;
+    _count = 0;
+    _index = nullptr;
+    _keys = nullptr;
+}
+
+
+bool VisionSnapshot::isOpen() const
+{
+    return _memory != nullptr;
+}
+
+
+std::size_t VisionSnapshot::size() const
+{
+    return _count;
+}
+
+
+VisionSnapshot::Record VisionSnapshot::record(std::size_t index) const
+{
+    if (index >= _count)
+    {
+        throw Poco::Exception("Snapshot record out of range: " + std::to_string(index));
+    }
+
+    uint64_t offset = _index[index].offset;
+
+    if (offset > _size || !isValid(_data + offset, _size - offset))
+    {
+        throw Poco::Exception("Invalid snapshot record: " + std::to_string(index));
+    }
+
+    return Record(_data + offset);
+}
+
+
+AnnotateImageResponse VisionSnapshot::response(std::size_t index) const
+{
+    return record(index).response();
+}
+
+
+uint64_t VisionSnapshot::key(std::size_t index) const
+{
+    if (index >= _count)
+    {
+        throw Poco::Exception("Snapshot record out of range: " + std::to_string(index));
+    }
+
+    return _index[index].key;
+}
+
+
+std::size_t VisionSnapshot::find(uint64_t key) const
+{
+    auto iter = std::lower_bound(_keys, _keys + _count, key, [](const KeyEntry& entry, uint64_t key) {
+        return entry.key < key;
+    });
+
+    if (iter != _keys + _count && iter->key == key && iter->index < _count)
+    {
+        return static_cast<std::size_t>(iter->index);
+    }
+
+    return _count;
+}
+
+
+const std::string& VisionSnapshot::path() const
+{
+    return _path;
+}
+
+
+bool VisionSnapshot::isValid(const char* data, std::size_t size)
+{
+    if (reinterpret_cast<std::uintptr_t>(data) % ALIGNMENT != 0
+    ||  size < sizeof(RecordHeader))
+    {
+        return false;
+    }
+
+    const auto& header = *reinterpret_cast<const RecordHeader*>(data);
+
+    if (header.size > size)
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < NUM_SECTIONS; ++i)
+    {
+        const auto& section = header.sections[i];
+
+        if (section.offset % ALIGNMENT != 0
+        ||  section.offset > header.size
+        ||  section.count > (header.size - section.offset) / SECTION_ELEMENT_SIZES[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void VisionSnapshot::serialize(const AnnotateImageResponse& response,
+                               std::string& buffer)
+{
+    RecordBuilder builder;
+    RecordHeader header;
+
+    for (const auto& annotation: response.faceAnnotations())
+    {
+        Face face;
+        face.boundingPoly = builder.polyline(annotation.boundingPoly());
+        face.fdBoundingPoly = builder.polyline(annotation.fdBoundingPoly());
+
+        face.landmarks.begin = builder.count(LANDMARKS);
+        for (const auto& landmark: annotation.landmarks())
+        {
+            Landmark packed;
+            packed.position = landmark.position();
+            packed.type = landmark.type();
+            builder.append(LANDMARKS, packed);
+        }
+        face.landmarks.end = builder.count(LANDMARKS);
+
+        face.rollAngle = annotation.rollAngle();
+        face.panAngle = annotation.panAngle();
+        face.tiltAngle = annotation.tiltAngle();
+        face.detectionConfidence = annotation.detectionConfidence();
+        face.landmarkingConfidence = annotation.landmarkingConfidence();
+        face.joy = annotation.joyLikelihood().type();
+        face.sorrow = annotation.sorrowLikelihood().type();
+        face.anger = annotation.angerLikelihood().type();
+        face.surprise = annotation.surpriseLikelihood().type();
+        face.underExposed = annotation.underExposedLikelihood().type();
+        face.blurred = annotation.blurredLikelihood().type();
+        face.headwear = annotation.headwearLikelihood().type();
+
+        builder.append(FACES, face);
+    }
+
+    builder.entities(LANDMARK_ANNOTATIONS, response.landmarkAnnotations());
+    builder.entities(LOGO_ANNOTATIONS, response.logoAnnotations());
+    builder.entities(LABEL_ANNOTATIONS, response.labelAnnotations());
+    builder.entities(TEXT_ANNOTATIONS, response.textAnnotations());
+
+    const auto& safeSearch = response.safeSearchAnnotation();
+    header.safeSearch.adult = safeSearch.adult().type();
+    header.safeSearch.spoof = safeSearch.spoof().type();
+    header.safeSearch.medical = safeSearch.medical().type();
+    header.safeSearch.violence = safeSearch.violence().type();
+    header.safeSearch.racy = safeSearch.racy().type();
+
+    for (const auto& info: response.imagePropertiesAnnotation().dominantColors())
+    {
+        Color color;
+        color.r = info.color().r;
+        color.g = info.color().g;
+        color.b = info.color().b;
+        color.a = info.color().a;
+        color.score = info.score();
+        color.pixelFraction = info.pixelFraction();
+        builder.append(COLORS, color);
+    }
+
+    for (const auto& hint: response.cropHintsAnnotation().cropHints())
+    {
+        CropHint packed;
+        packed.boundingPoly = builder.polyline(hint.boundingPoly());
+        packed.confidence = hint.confidence();
+        packed.importanceFraction = hint.importanceFraction();
+        builder.append(CROP_HINTS, packed);
+    }
+
+    // The flat TextAnnotation and WebDetection arrays are copied as is.
+    const auto& text = response.fullTextAnnotation();
+    builder.append(TEXT_BUFFER, text.text().data(), text.text().size());
+    builder.append(TEXT_PAGES, text.pages());
+    builder.append(TEXT_BLOCKS, text.blocks());
+    builder.append(TEXT_PARAGRAPHS, text.paragraphs());
+    builder.append(TEXT_WORDS, text.words());
+    builder.append(TEXT_SYMBOLS, text.symbols());
+    builder.append(TEXT_LANGUAGES, text.languages());
+
+    // Language codes and web strings keep their ids, so they are not interned.
+    header.textLanguageCodes.begin = builder.count(STRINGS);
+    for (const auto& code: text.languageCodes()) builder.add(code);
+    header.textLanguageCodes.end = builder.count(STRINGS);
+
+    const auto& web = response.webDetection();
+    builder.append(WEB_ENTITIES, web.webEntities());
+    builder.append(WEB_FULL_MATCHING_IMAGES, web.fullMatchingImages());
+    builder.append(WEB_PARTIAL_MATCHING_IMAGES, web.partialMatchingImages());
+    builder.append(WEB_PAGES_WITH_MATCHING_IMAGES, web.pagesWithMatchingImages());
+    builder.append(WEB_VISUALLY_SIMILAR_IMAGES, web.visuallySimilarImages());
+    builder.append(WEB_BEST_GUESS_LABELS, web.bestGuessLabels());
+    builder.append(WEB_PAGE_IMAGES, web.pageImages());
+
+    header.webStrings.begin = builder.count(STRINGS);
+    for (const auto& string: web.strings()) builder.add(string);
+    header.webStrings.end = builder.count(STRINGS);
+
+    header.hasError = response.hasError() ? 1 : 0;
+    header.errorCode = response.errorCode();
+    header.errorMessage = builder.intern(response.errorMessage());
+
+    builder.finish(header, buffer);
+}
+
+
+VisionSnapshotWriter::VisionSnapshotWriter(const std::string& path):
+    _path(ofToDataPath(path, true)),
+    _stream(_path, std::ios::binary | std::ios::trunc)
+{
+    if (!_stream)
+    {
+        throw Poco::Exception("Unable to create snapshot: " + _path);
+    }
+
+    // The header is rewritten by close().
+    VisionSnapshot::FileHeader header;
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    _offset = sizeof(header);
+}
+
+
+VisionSnapshotWriter::~VisionSnapshotWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const Poco::Exception& exception)
+    {
+        ofLogError("VisionSnapshotWriter::~VisionSnapshotWriter") << exception.displayText();
+    }
+}
+
+
+void VisionSnapshotWriter::write(const AnnotateImageResponse& response,
+                                 uint64_t key)
+{
+    _buffer.clear();
+    VisionSnapshot::serialize(response, _buffer);
+
+    _stream.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+
+    VisionSnapshot::IndexEntry entry;
+    entry.offset = _offset;
+    entry.key = key;
+    _index.push_back(entry);
+    _offset += _buffer.size();
+}
+
+
+void VisionSnapshotWriter::close()
+{
+    if (!_stream.is_open())
+    {
+        return;
+    }
+
+    std::vector<VisionSnapshot::KeyEntry> keys(_index.size());
+
+    for (std::size_t i = 0; i < _index.size(); ++i)
+    {
+        keys[i].key = _index[i].key;
+        keys[i].index = i;
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), [](const VisionSnapshot::KeyEntry& a,
+                                                  const VisionSnapshot::KeyEntry& b) {
+        return a.key < b.key;
+    });
+
+    VisionSnapshot::FileHeader header;
+    header.count = _index.size();
+    header.indexOffset = _offset;
+    header.keysOffset = _offset + _index.size() * sizeof(VisionSnapshot::IndexEntry);
+
+    _stream.write(reinterpret_cast<const char*>(_index.data()),
+                  static_cast<std::streamsize>(_index.size() * sizeof(VisionSnapshot::IndexEntry)));
+    _stream.write(reinterpret_cast<const char*>(keys.data()),
+                  static_cast<std::streamsize>(keys.size() * sizeof(VisionSnapshot::KeyEntry)));
+    _stream.seekp(0);
+    _stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    bool failed = !_stream;
+    _stream.close();
+
+    if (failed)
+    {
+        throw Poco::Exception("Unable to write snapshot: " + _path);
+    }
+}
+
+
+std::size_t VisionSnapshotWriter::size() const
+{
+    return _index.size();
+}
+
+
+} } // namespace ofx::CloudPlatform
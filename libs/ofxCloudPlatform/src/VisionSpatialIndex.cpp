@@ -0,0 +1,609 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionSpatialIndex.h"
+#include <algorithm>
+#include <queue>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief The Hilbert curve grid is 2^HILBERT_BITS cells on each side.
+constexpr uint32_t HILBERT_BITS = 16;
+
+
+/// \returns the distance along a Hilbert curve of a grid cell.
+uint64_t hilbert(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+
+    for (uint32_t s = uint32_t(1) << (HILBERT_BITS - 1); s > 0; s >>= 1)
+    {
+        uint32_t rx = (x & s) > 0;
+        uint32_t ry = (y & s) > 0;
+        d += uint64_t(s) * s * ((3 * rx) ^ ry);
+
+        // Rotate the quadrant.
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = s - 1 - x;
+                y = s - 1 - y;
+            }
+
+            std::swap(x, y);
+        }
+    }
+
+    return d;
+}
+
+
+/// \returns the squared distance from a point to a box, 0 if inside.
+float distanceSquared(const glm::vec2& point,
+                      const glm::vec2& min,
+                      const glm::vec2& max)
+{
+    float dx = std::max(std::max(min.x - point.x, point.x - max.x), 0.0f);
+    float dy = std::max(std::max(min.y - point.y, point.y - max.y), 0.0f);
+    return dx * dx + dy * dy;
+}
+
+
+/// \returns the squared distance from a point to a line segment.
+float segmentDistanceSquared(const glm::vec2& point,
+                             const glm::vec2& a,
+                             const glm::vec2& b)
+{
+    float abx = b.x - a.x;
+    float aby = b.y - a.y;
+    float length = abx * abx + aby * aby;
+    float t = length > 0 ? ((point.x - a.x) * abx + (point.y - a.y) * aby) / length : 0;
+    t = std::min(std::max(t, 0.0f), 1.0f);
+
+    float dx = a.x + t * abx - point.x;
+    float dy = a.y + t * aby - point.y;
+    return dx * dx + dy * dy;
+}
+
+
+}
+
+
+constexpr uint32_t VisionSpatialIndex::ALL_TYPES;
+
+
+VisionSpatialIndex::VisionSpatialIndex()
+{
+}
+
+
+VisionSpatialIndex::VisionSpatialIndex(const AnnotateImageResponse& response,
+                                       uint32_t types)
+{
+    add(response, types);
+    build();
+}
+
+
+VisionSpatialIndex::VisionSpatialIndex(const std::vector<AnnotateImageResponse>& responses,
+                                       uint32_t types)
+{
+    for (const auto& response: responses)
+    {
+        add(response, types);
+    }
+
+    build();
+}
+
+
+VisionSpatialIndex::~VisionSpatialIndex()
+{
+}
+
+
+std::size_t VisionSpatialIndex::add(const AnnotateImageResponse& response,
+                                    uint32_t types)
+{
+    // Sections are only decoded, e.g. by a lazy response, if they are indexed.
+    if (types & (mask(Type::FACE) | mask(Type::FACE_LANDMARK)))
+    {
+        const auto& faces = response.faceAnnotations();
+
+        for (std::size_t i = 0; i < faces.size(); ++i)
+        {
+            if (types & mask(Type::FACE))
+            {
+                addPolygon(Type::FACE, i, faces[i].boundingPoly().getVertices());
+            }
+
+            if (types & mask(Type::FACE_LANDMARK))
+            {
+                const auto& landmarks = faces[i].landmarks();
+
+                for (std::size_t j = 0; j < landmarks.size(); ++j)
+                {
+                    const auto& position = landmarks[j].position();
+                    addPoint(Type::FACE_LANDMARK, i, j, glm::vec2(position.x, position.y));
+                }
+            }
+        }
+    }
+
+    if (types & mask(Type::LANDMARK_ANNOTATION))
+    {
+        addEntities(Type::LANDMARK_ANNOTATION, response.landmarkAnnotations());
+    }
+
+    if (types & mask(Type::LOGO_ANNOTATION))
+    {
+        addEntities(Type::LOGO_ANNOTATION, response.logoAnnotations());
+    }
+
+    if (types & mask(Type::LABEL_ANNOTATION))
+    {
+        addEntities(Type::LABEL_ANNOTATION, response.labelAnnotations());
+    }
+
+    if (types & mask(Type::TEXT_ANNOTATION))
+    {
+        addEntities(Type::TEXT_ANNOTATION, response.textAnnotations());
+    }
+
+    if (types & mask(Type::CROP_HINT))
+    {
+        const auto& hints = response.cropHintsAnnotation().cropHints();
+
+        for (std::size_t i = 0; i < hints.size(); ++i)
+        {
+            addPolygon(Type::CROP_HINT, i, hints[i].boundingPoly().getVertices());
+        }
+    }
+
+    if (types & (mask(Type::TEXT_BLOCK) | mask(Type::TEXT_PARAGRAPH) | mask(Type::TEXT_WORD) | mask(Type::TEXT_SYMBOL)))
+    {
+        const auto& text = response.fullTextAnnotation();
+
+        if (types & mask(Type::TEXT_BLOCK))
+        {
+            for (std::size_t i = 0; i < text.blocks().size(); ++i)
+                addPolygon(Type::TEXT_BLOCK, i, text.blocks()[i].boundingBox);
+        }
+
+        if (types & mask(Type::TEXT_PARAGRAPH))
+        {
+            for (std::size_t i = 0; i < text.paragraphs().size(); ++i)
+                addPolygon(Type::TEXT_PARAGRAPH, i, text.paragraphs()[i].boundingBox);
+        }
+
+        if (types & mask(Type::TEXT_WORD))
+        {
+            for (std::size_t i = 0; i < text.words().size(); ++i)
+                addPolygon(Type::TEXT_WORD, i, text.words()[i].boundingBox);
+        }
+
+        if (types & mask(Type::TEXT_SYMBOL))
+        {
+            for (std::size_t i = 0; i < text.symbols().size(); ++i)
+                addPolygon(Type::TEXT_SYMBOL, i, text.symbols()[i].boundingBox);
+        }
+    }
+
+    return _responses++;
+}
+
+
+void VisionSpatialIndex::build()
+{
+    _nodeMin.clear();
+    _nodeMax.clear();
+    _nodeBegin.clear();
+    _nodeEnd.clear();
+
+    if (_items.empty())
+    {
+        return;
+    }
+
+    glm::vec2 min = _items.front().min;
+    glm::vec2 max = _items.front().max;
+
+    for (const auto& item: _items)
+    {
+        min.x = std::min(min.x, item.min.x);
+        min.y = std::min(min.y, item.min.y);
+        max.x = std::max(max.x, item.max.x);
+        max.y = std::max(max.y, item.max.y);
+    }
+
+    // Sort the items along a Hilbert curve through their centers.
+    float scale = float((uint32_t(1) << HILBERT_BITS) - 1);
+    float width = std::max(max.x - min.x, std::numeric_limits<float>::min());
+    float height = std::max(max.y - min.y, std::numeric_limits<float>::min());
+
+    std::vector<std::pair<uint64_t, uint32_t>> order(_items.size());
+
+    for (std::size_t i = 0; i < _items.size(); ++i)
+    {
+        const auto& item = _items[i];
+        float x = ((item.min.x + item.max.x) / 2 - min.x) / width;
+        float y = ((item.min.y + item.max.y) / 2 - min.y) / height;
+        order[i].first = hilbert(static_cast<uint32_t>(x * scale), static_cast<uint32_t>(y * scale));
+        order[i].second = static_cast<uint32_t>(i);
+    }
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<Item> items;
+    items.reserve(_items.size());
+
+    for (const auto& entry: order)
+    {
+        items.push_back(_items[entry.second]);
+    }
+
+    _items.swap(items);
+
+    // The items are the first level of entries.
+    for (const auto& item: _items)
+    {
+        _nodeMin.push_back(item.min);
+        _nodeMax.push_back(item.max);
+    }
+
+    // Pack each level into nodes of NODE_SIZE entries until there is a root.
+    std::size_t begin = 0;
+    std::size_t end = _nodeMin.size();
+
+    do
+    {
+        for (std::size_t i = begin; i < end; i += NODE_SIZE)
+        {
+            std::size_t last = std::min(i + NODE_SIZE, end);
+            glm::vec2 nodeMin = _nodeMin[i];
+            glm::vec2 nodeMax = _nodeMax[i];
+
+            for (std::size_t j = i + 1; j < last; ++j)
+            {
+                nodeMin.x = std::min(nodeMin.x, _nodeMin[j].x);
+                nodeMin.y = std::min(nodeMin.y, _nodeMin[j].y);
+                nodeMax.x = std::max(nodeMax.x, _nodeMax[j].x);
+                nodeMax.y = std::max(nodeMax.y, _nodeMax[j].y);
+            }
+
+            _nodeMin.push_back(nodeMin);
+            _nodeMax.push_back(nodeMax);
+            _nodeBegin.push_back(static_cast<uint32_t>(i));
+            _nodeEnd.push_back(static_cast<uint32_t>(last));
+        }
+
+        begin = end;
+        end = _nodeMin.size();
+    }
+    while (end - begin > 1);
+}
+
+
+void VisionSpatialIndex::clear()
+{
+    _responses = 0;
+    _items.clear();
+    _vertices.clear();
+    _nodeMin.clear();
+    _nodeMax.clear();
+    _nodeBegin.clear();
+    _nodeEnd.clear();
+}
+
+
+std::size_t VisionSpatialIndex::size() const
+{
+    return _items.size();
+}
+
+
+const std::vector<VisionSpatialIndex::Item>& VisionSpatialIndex::items() const
+{
+    return _items;
+}
+
+
+const std::vector<glm::vec2>& VisionSpatialIndex::vertices() const
+{
+    return _vertices;
+}
+
+
+void VisionSpatialIndex::contains(const glm::vec2& point,
+                                  std::vector<std::size_t>& results,
+                                  uint32_t types,
+                                  float radius) const
+{
+    if (_nodeMin.empty())
+    {
+        return;
+    }
+
+    glm::vec2 min(point.x - radius, point.y - radius);
+    glm::vec2 max(point.x + radius, point.y + radius);
+
+    std::vector<uint32_t> stack(1, static_cast<uint32_t>(_nodeMin.size() - 1));
+
+    while (!stack.empty())
+    {
+        uint32_t entry = stack.back();
+        stack.pop_back();
+
+        if (entry < _items.size())
+        {
+            const auto& item = _items[entry];
+
+            if (!(types & mask(item.type)))
+            {
+                continue;
+            }
+
+            bool hit = item.begin == item.end
+                     ? distanceSquared(point, item.min, item.max) <= radius * radius
+                     : inside(item, point);
+
+            if (hit)
+            {
+                results.push_back(entry);
+            }
+
+            continue;
+        }
+
+        std::size_t node = entry - _items.size();
+
+        for (uint32_t child = _nodeBegin[node]; child < _nodeEnd[node]; ++child)
+        {
+            if (_nodeMin[child].x <= max.x && _nodeMax[child].x >= min.x
+            &&  _nodeMin[child].y <= max.y && _nodeMax[child].y >= min.y)
+            {
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+
+void VisionSpatialIndex::intersects(const ofRectangle& rectangle,
+                                    std::vector<std::size_t>& results,
+                                    uint32_t types) const
+{
+    if (_nodeMin.empty())
+    {
+        return;
+    }
+
+    glm::vec2 min(rectangle.getMinX(), rectangle.getMinY());
+    glm::vec2 max(rectangle.getMaxX(), rectangle.getMaxY());
+
+    std::vector<uint32_t> stack(1, static_cast<uint32_t>(_nodeMin.size() - 1));
+
+    while (!stack.empty())
+    {
+        uint32_t entry = stack.back();
+        stack.pop_back();
+
+        if (_nodeMin[entry].x > max.x || _nodeMax[entry].x < min.x
+        ||  _nodeMin[entry].y > max.y || _nodeMax[entry].y < min.y)
+        {
+            continue;
+        }
+
+        if (entry < _items.size())
+        {
+            if (types & mask(_items[entry].type))
+            {
+                results.push_back(entry);
+            }
+
+            continue;
+        }
+
+        std::size_t node = entry - _items.size();
+
+        for (uint32_t child = _nodeBegin[node]; child < _nodeEnd[node]; ++child)
+        {
+            stack.push_back(child);
+        }
+    }
+}
+
+
+void VisionSpatialIndex::nearest(const glm::vec2& point,
+                                 std::size_t count,
+                                 std::vector<Neighbor>& results,
+                                 uint32_t types,
+                                 float maxDistance) const
+{
+    if (_nodeMin.empty() || count == 0)
+    {
+        return;
+    }
+
+    // Entries by squared distance. Nodes use the distance to their bounds,
+    // which is never more than the distance to anything in them, so items
+    // come off the queue nearest first.
+    typedef std::pair<float, uint32_t> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+
+    float maxDistanceSquared = maxDistance * maxDistance;
+    uint32_t root = static_cast<uint32_t>(_nodeMin.size() - 1);
+    queue.push(QueueEntry(distanceSquared(point, _nodeMin[root], _nodeMax[root]), root));
+
+    std::size_t found = 0;
+
+    // Items are pushed with their exact distance and marked by the high bit.
+    const uint32_t ITEM = 0x80000000;
+
+    while (!queue.empty() && found < count)
+    {
+        QueueEntry top = queue.top();
+        queue.pop();
+
+        if (top.first > maxDistanceSquared)
+        {
+            break;
+        }
+
+        if (top.second & ITEM)
+        {
+            Neighbor neighbor;
+            neighbor.item = top.second & ~ITEM;
+            neighbor.distance = std::sqrt(top.first);
+            results.push_back(neighbor);
+            ++found;
+            continue;
+        }
+
+        if (top.second < _items.size())
+        {
+            if (types & mask(_items[top.second].type))
+            {
+                float d = distance(top.second, point);
+                queue.push(QueueEntry(d * d, top.second | ITEM));
+            }
+
+            continue;
+        }
+
+        std::size_t node = top.second - _items.size();
+
+        for (uint32_t child = _nodeBegin[node]; child < _nodeEnd[node]; ++child)
+        {
+            queue.push(QueueEntry(distanceSquared(point, _nodeMin[child], _nodeMax[child]), child));
+        }
+    }
+}
+
+
+float VisionSpatialIndex::distance(std::size_t id, const glm::vec2& point) const
+{
+    const auto& item = _items[id];
+
+    if (item.begin == item.end)
+    {
+        return std::sqrt(distanceSquared(point, item.min, item.max));
+    }
+
+    if (inside(item, point))
+    {
+        return 0;
+    }
+
+    float result = std::numeric_limits<float>::max();
+
+    for (uint32_t i = item.begin, j = item.end - 1; i < item.end; j = i++)
+    {
+        result = std::min(result, segmentDistanceSquared(point, _vertices[j], _vertices[i]));
+    }
+
+    return std::sqrt(result);
+}
+
+
+template <typename Vertices>
+void VisionSpatialIndex::addPolygon(Type type,
+                                    uint32_t annotation,
+                                    const Vertices& vertices)
+{
+    if (vertices.size() == 0)
+    {
+        return;
+    }
+
+    Item item;
+    item.type = type;
+    item.response = _responses;
+    item.annotation = annotation;
+    item.min = glm::vec2(vertices[0].x, vertices[0].y);
+    item.max = item.min;
+    item.begin = static_cast<uint32_t>(_vertices.size());
+
+    for (const auto& vertex: vertices)
+    {
+        item.min.x = std::min(item.min.x, vertex.x);
+        item.min.y = std::min(item.min.y, vertex.y);
+        item.max.x = std::max(item.max.x, vertex.x);
+        item.max.y = std::max(item.max.y, vertex.y);
+        _vertices.push_back(glm::vec2(vertex.x, vertex.y));
+    }
+
+    item.end = static_cast<uint32_t>(_vertices.size());
+
+    _items.push_back(item);
+}
+
+
+void VisionSpatialIndex::addEntities(Type type,
+                                     const std::vector<EntityAnnotation>& annotations)
+{
+    for (std::size_t i = 0; i < annotations.size(); ++i)
+    {
+        addPolygon(type, i, annotations[i].boundingPoly().getVertices());
+    }
+}
+
+
+void VisionSpatialIndex::addPoint(Type type,
+                                  uint32_t annotation,
+                                  uint32_t part,
+                                  const glm::vec2& point)
+{
+    Item item;
+    item.type = type;
+    item.response = _responses;
+    item.annotation = annotation;
+    item.part = part;
+    item.min = point;
+    item.max = point;
+    item.begin = static_cast<uint32_t>(_vertices.size());
+    item.end = item.begin;
+
+    _items.push_back(item);
+}
+
+
+bool VisionSpatialIndex::inside(const Item& item, const glm::vec2& point) const
+{
+    if (point.x < item.min.x || point.x > item.max.x
+    ||  point.y < item.min.y || point.y > item.max.y)
+    {
+        return false;
+    }
+
+    // Count edge crossings of a ray to the right of the point.
+    bool result = false;
+
+    for (uint32_t i = item.begin, j = item.end - 1; i < item.end; j = i++)
+    {
+        const auto& a = _vertices[i];
+        const auto& b = _vertices[j];
+
+        if ((a.y > point.y) != (b.y > point.y)
+        &&  point.x < (b.x - a.x) * (point.y - a.y) / (b.y - a.y) + a.x)
+        {
+            result = !result;
+        }
+    }
+
+    return result;
+}
+
+
+} } // namespace ofx::CloudPlatform
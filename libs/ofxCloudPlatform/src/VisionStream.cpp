@@ -0,0 +1,252 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionStream.h"
+#include <algorithm>
+#include <cstdlib>
+
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define OFX_CLOUDPLATFORM_SSE2 1
+#include <emmintrin.h>
+#endif
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+VisionStream::VisionStream(const Settings& settings):
+    _settings(settings),
+    _template(std::make_shared<VisionRequestTemplate>(settings.features))
+{
+    std::size_t workers = std::max(std::size_t(1), _settings.maxConcurrentRequests);
+
+    for (std::size_t i = 0; i < workers; ++i)
+    {
+        _workers.push_back(std::thread(&VisionStream::run, this));
+    }
+}
+
+
+VisionStream::~VisionStream()
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+
+    _condition.notify_all();
+
+    for (auto& worker: _workers)
+    {
+        worker.join();
+    }
+}
+
+
+bool VisionStream::submit(const ofPixels& pixels, uint64_t timestamp)
+{
+    uint64_t frameNumber = ++_frameNumber;
+
+    thumbnail(pixels, _thumbnail);
+
+    bool refresh = _settings.refreshInterval > 0
+                && timestamp >= _lastSubmitTimestamp + _settings.refreshInterval;
+
+    bool changed = _lastThumbnail.empty()
+                || _settings.sceneChangeThreshold <= 0
+                || sceneChange(_thumbnail, _lastThumbnail) >= _settings.sceneChangeThreshold;
+
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    ++_statistics.framesReceived;
+
+    if (!changed && !refresh)
+    {
+        ++_statistics.framesUnchanged;
+        return false;
+    }
+
+    if (_hasPending)
+    {
+        ++_statistics.framesReplaced;
+    }
+
+    _pending.pixels = pixels;
+    _pending.timestamp = timestamp;
+    _pending.frameNumber = frameNumber;
+    _hasPending = true;
+
+    lock.unlock();
+
+    std::swap(_lastThumbnail, _thumbnail);
+    _lastSubmitTimestamp = timestamp;
+
+    _condition.notify_one();
+
+    return true;
+}
+
+
+bool VisionStream::tryGetResult(Result& result)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    if (!_hasResult)
+    {
+        return false;
+    }
+
+    result = _result;
+    _hasResult = false;
+    return true;
+}
+
+
+VisionStream::Statistics VisionStream::statistics() const
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    return _statistics;
+}
+
+
+void VisionStream::thumbnail(const ofPixels& pixels, std::vector<uint8_t>& thumbnail)
+{
+    const std::size_t SIZE = THUMBNAIL_SIZE;
+
+    thumbnail.assign(SIZE * SIZE, 0);
+
+    std::size_t width = pixels.getWidth();
+    std::size_t height = pixels.getHeight();
+    std::size_t channels = pixels.getNumChannels();
+    std::size_t stride = pixels.getBytesStride();
+
+    if (width == 0 || height == 0 || channels == 0)
+    {
+        return;
+    }
+
+    const unsigned char* data = pixels.getData();
+
+    // Point sample the center of each thumbnail cell.
+    for (std::size_t ty = 0; ty < SIZE; ++ty)
+    {
+        const unsigned char* row = data + ((2 * ty + 1) * height / (2 * SIZE)) * stride;
+
+        for (std::size_t tx = 0; tx < SIZE; ++tx)
+        {
+            const unsigned char* p = row + ((2 * tx + 1) * width / (2 * SIZE)) * channels;
+
+            if (channels >= 3)
+            {
+                thumbnail[ty * SIZE + tx] = (77 * p[0] + 150 * p[1] + 29 * p[2]) >> 8;
+            }
+            else
+            {
+                thumbnail[ty * SIZE + tx] = p[0];
+            }
+        }
+    }
+}
+
+
+float VisionStream::sceneChange(const std::vector<uint8_t>& a,
+                                const std::vector<uint8_t>& b)
+{
+    std::size_t size = std::min(a.size(), b.size());
+
+    if (size == 0)
+    {
+        return 1;
+    }
+
+    uint64_t sum = 0;
+    std::size_t i = 0;
+
+#if defined(OFX_CLOUDPLATFORM_SSE2)
+    __m128i accumulator = _mm_setzero_si128();
+
+    for (; i + 16 <= size; i += 16)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a.data() + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b.data() + i));
+        accumulator = _mm_add_epi64(accumulator, _mm_sad_epu8(va, vb));
+    }
+
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), accumulator);
+    sum = lanes[0] + lanes[1];
+#endif
+
+    for (; i < size; ++i)
+    {
+        sum += std::abs(int(a[i]) - int(b[i]));
+    }
+
+    return float(sum) / (255.0f * size);
+}
+
+
+void VisionStream::run()
+{
+    VisionClient client(_settings.credentials);
+
+    Frame frame;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            _condition.wait(lock, [this] { return _stop || _hasPending; });
+
+            if (_stop)
+            {
+                return;
+            }
+
+            std::swap(frame, _pending);
+            _hasPending = false;
+            ++_statistics.requests;
+        }
+
+        try
+        {
+            auto responses = client.annotate(VisionRequestItem(frame.pixels, _template));
+
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            if (responses.empty())
+            {
+                ++_statistics.requestsFailed;
+            }
+            else if (_hasPublished && frame.frameNumber <= _result.frameNumber)
+            {
+                ++_statistics.resultsStale;
+            }
+            else
+            {
+                _result.timestamp = frame.timestamp;
+                _result.frameNumber = frame.frameNumber;
+                _result.response = responses.front();
+                _hasResult = true;
+                _hasPublished = true;
+                ++_statistics.resultsPublished;
+            }
+        }
+        catch (const std::exception& exc)
+        {
+            ofLogError("VisionStream::run") << exc.what();
+            std::unique_lock<std::mutex> lock(_mutex);
+            ++_statistics.requestsFailed;
+        }
+    }
+}
+
+
+} } // namespace ofx::CloudPlatform
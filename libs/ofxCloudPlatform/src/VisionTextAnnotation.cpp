@@ -0,0 +1,569 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionTextAnnotation.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief Element json keys, shared by all levels.
+enum
+{
+    TEXT_PAGES,
+    TEXT_BLOCKS,
+    TEXT_PARAGRAPHS,
+    TEXT_WORDS,
+    TEXT_SYMBOLS,
+    TEXT_PROPERTY,
+    TEXT_BOUNDING_BOX,
+    TEXT_CONFIDENCE,
+    TEXT_TEXT,
+    TEXT_BLOCK_TYPE,
+    TEXT_WIDTH,
+    TEXT_HEIGHT,
+    TEXT_DETECTED_LANGUAGES,
+    TEXT_DETECTED_BREAK,
+    NUM_TEXT_KEYS
+};
+
+
+constexpr const char* TEXT_KEY_NAMES[NUM_TEXT_KEYS] =
+{
+    "pages",
+    "blocks",
+    "paragraphs",
+    "words",
+    "symbols",
+    "property",
+    "boundingBox",
+    "confidence",
+    "text",
+    "blockType",
+    "width",
+    "height",
+    "detectedLanguages",
+    "detectedBreak"
+};
+
+
+constexpr VisionKeyTable<NUM_TEXT_KEYS> TEXT_KEYS(TEXT_KEY_NAMES);
+
+
+static_assert(TEXT_KEYS.isValid(), "No perfect hash for TextAnnotation keys.");
+
+
+constexpr const char* BREAK_TYPE_NAMES[] =
+{
+    "UNKNOWN",
+    "SPACE",
+    "SURE_SPACE",
+    "EOL_SURE_SPACE",
+    "HYPHEN",
+    "LINE_BREAK"
+};
+
+
+constexpr VisionKeyTable<6> BREAK_TYPES(BREAK_TYPE_NAMES);
+
+
+static_assert(BREAK_TYPES.isValid(), "No perfect hash for BreakType names.");
+
+
+/// \brief The text appended to the buffer for each BreakType.
+const char* const BREAK_TEXT[] =
+{
+    "",
+    " ",
+    " ",
+    "\n",
+    "-\n",
+    "\n"
+};
+
+
+constexpr const char* BLOCK_TYPE_NAMES[] =
+{
+    "UNKNOWN",
+    "TEXT",
+    "TABLE",
+    "PICTURE",
+    "RULER",
+    "BARCODE"
+};
+
+
+constexpr VisionKeyTable<6> BLOCK_TYPES(BLOCK_TYPE_NAMES);
+
+
+static_assert(BLOCK_TYPES.isValid(), "No perfect hash for BlockType names.");
+
+
+/// \returns the end of the text of the last child, or begin if none.
+template <typename T>
+uint32_t textEnd(const std::vector<T>& children,
+                 const TextAnnotation::Range& range,
+                 uint32_t begin)
+{
+    return range.end > range.begin ? children[range.end - 1].text.end : begin;
+}
+
+
+}
+
+
+TextAnnotation::TextAnnotation()
+{
+}
+
+
+TextAnnotation::~TextAnnotation()
+{
+}
+
+
+bool TextAnnotation::empty() const
+{
+    return _pages.empty();
+}
+
+
+const std::string& TextAnnotation::text() const
+{
+    return _text;
+}
+
+
+std::string TextAnnotation::text(const Range& range) const
+{
+    return _text.substr(range.begin, range.end - range.begin);
+}
+
+
+const std::vector<TextAnnotation::Page>& TextAnnotation::pages() const
+{
+    return _pages;
+}
+
+
+const std::vector<TextAnnotation::Block>& TextAnnotation::blocks() const
+{
+    return _blocks;
+}
+
+
+const std::vector<TextAnnotation::Paragraph>& TextAnnotation::paragraphs() const
+{
+    return _paragraphs;
+}
+
+
+const std::vector<TextAnnotation::Word>& TextAnnotation::words() const
+{
+    return _words;
+}
+
+
+const std::vector<TextAnnotation::Symbol>& TextAnnotation::symbols() const
+{
+    return _symbols;
+}
+
+
+const std::vector<TextAnnotation::DetectedLanguage>& TextAnnotation::languages() const
+{
+    return _languages;
+}
+
+
+const std::vector<std::string>& TextAnnotation::languageCodes() const
+{
+    return _languageCodes;
+}
+
+
+std::size_t TextAnnotation::memoryFootprint() const
+{
+    std::size_t size = sizeof(TextAnnotation)
+                     + _text.capacity()
+                     + _pages.capacity() * sizeof(Page)
+                     + _blocks.capacity() * sizeof(Block)
+                     + _paragraphs.capacity() * sizeof(Paragraph)
+                     + _words.capacity() * sizeof(Word)
+                     + _symbols.capacity() * sizeof(Symbol)
+                     + _languages.capacity() * sizeof(DetectedLanguage)
+                     + _languageCodes.capacity() * sizeof(std::string);
+
+    for (const auto& code: _languageCodes)
+    {
+        size += code.capacity();
+    }
+
+    return size;
+}
+
+
+const char* TextAnnotation::toString(BreakType type)
+{
+    return BREAK_TYPE_NAMES[static_cast<std::size_t>(type)];
+}
+
+
+const char* TextAnnotation::toString(BlockType type)
+{
+    return BLOCK_TYPE_NAMES[static_cast<std::size_t>(type)];
+}
+
+
+TextAnnotation TextAnnotation::fromJSON(const ofJson& json)
+{
+    TextAnnotation annotation;
+
+    // The buffer is rebuilt from the symbols, so the full text is only a
+    // size hint. Keys iterate in sorted order, so "pages" comes before
+    // "text" and the hint must be read first.
+    auto text = json.find("text");
+
+    if (text != json.end() && text->is_string())
+    {
+        annotation._text.reserve(text->get_ref<const std::string&>().size() + 1);
+    }
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_PAGES:
+                for (const auto& page: value) annotation.parsePage(page);
+                break;
+            case TEXT_TEXT:
+                break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation", key, value);
+        }
+
+        ++iter;
+    }
+
+    // Release the slack left by growth.
+    annotation._text.shrink_to_fit();
+    annotation._pages.shrink_to_fit();
+    annotation._blocks.shrink_to_fit();
+    annotation._paragraphs.shrink_to_fit();
+    annotation._words.shrink_to_fit();
+    annotation._symbols.shrink_to_fit();
+    annotation._languages.shrink_to_fit();
+
+    return annotation;
+}
+
+
+void TextAnnotation::parsePage(const ofJson& json)
+{
+    Page page;
+    uint32_t begin = static_cast<uint32_t>(_text.size());
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_BLOCKS:
+                page.blocks.begin = static_cast<uint32_t>(_blocks.size());
+                for (const auto& block: value) parseBlock(block);
+                page.blocks.end = static_cast<uint32_t>(_blocks.size());
+                break;
+            case TEXT_PROPERTY: page.languages = parseProperty(value, nullptr); break;
+            case TEXT_CONFIDENCE: page.confidence = value; break;
+            case TEXT_WIDTH: page.width = value; break;
+            case TEXT_HEIGHT: page.height = value; break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::Page", key, value);
+        }
+
+        ++iter;
+    }
+
+    page.text.begin = begin;
+    page.text.end = textEnd(_blocks, page.blocks, begin);
+    _pages.push_back(page);
+}
+
+
+void TextAnnotation::parseBlock(const ofJson& json)
+{
+    Block block;
+    uint32_t begin = static_cast<uint32_t>(_text.size());
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_PARAGRAPHS:
+                block.paragraphs.begin = static_cast<uint32_t>(_paragraphs.size());
+                for (const auto& paragraph: value) parseParagraph(paragraph);
+                block.paragraphs.end = static_cast<uint32_t>(_paragraphs.size());
+                break;
+            case TEXT_PROPERTY: block.languages = parseProperty(value, nullptr); break;
+            case TEXT_BOUNDING_BOX: parseBoundingBox(value, block.boundingBox); break;
+            case TEXT_CONFIDENCE: block.confidence = value; break;
+            case TEXT_BLOCK_TYPE:
+            {
+                const auto& name = value.get_ref<const std::string&>();
+                std::size_t type = BLOCK_TYPES.find(name);
+
+                if (type < 6)
+                {
+                    block.blockType = static_cast<BlockType>(type);
+                }
+                else
+                {
+                    VisionParseDiagnostics::unknownValue("TextAnnotation::BlockType", name);
+                }
+
+                break;
+            }
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::Block", key, value);
+        }
+
+        ++iter;
+    }
+
+    block.text.begin = begin;
+    block.text.end = textEnd(_paragraphs, block.paragraphs, begin);
+    _blocks.push_back(block);
+}
+
+
+void TextAnnotation::parseParagraph(const ofJson& json)
+{
+    Paragraph paragraph;
+    uint32_t begin = static_cast<uint32_t>(_text.size());
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_WORDS:
+                paragraph.words.begin = static_cast<uint32_t>(_words.size());
+                for (const auto& word: value) parseWord(word);
+                paragraph.words.end = static_cast<uint32_t>(_words.size());
+                break;
+            case TEXT_PROPERTY: paragraph.languages = parseProperty(value, nullptr); break;
+            case TEXT_BOUNDING_BOX: parseBoundingBox(value, paragraph.boundingBox); break;
+            case TEXT_CONFIDENCE: paragraph.confidence = value; break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::Paragraph", key, value);
+        }
+
+        ++iter;
+    }
+
+    paragraph.text.begin = begin;
+    paragraph.text.end = textEnd(_words, paragraph.words, begin);
+    _paragraphs.push_back(paragraph);
+}
+
+
+void TextAnnotation::parseWord(const ofJson& json)
+{
+    Word word;
+    uint32_t begin = static_cast<uint32_t>(_text.size());
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_SYMBOLS:
+                word.symbols.begin = static_cast<uint32_t>(_symbols.size());
+                for (const auto& symbol: value) parseSymbol(symbol);
+                word.symbols.end = static_cast<uint32_t>(_symbols.size());
+                break;
+            case TEXT_PROPERTY: word.languages = parseProperty(value, nullptr); break;
+            case TEXT_BOUNDING_BOX: parseBoundingBox(value, word.boundingBox); break;
+            case TEXT_CONFIDENCE: word.confidence = value; break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::Word", key, value);
+        }
+
+        ++iter;
+    }
+
+    // A word's text excludes a leading prefix break.
+    word.text.begin = word.symbols.end > word.symbols.begin ? _symbols[word.symbols.begin].text.begin : begin;
+    word.text.end = textEnd(_symbols, word.symbols, begin);
+    _words.push_back(word);
+}
+
+
+void TextAnnotation::parseSymbol(const ofJson& json)
+{
+    Symbol symbol;
+    const std::string* text = nullptr;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_TEXT: text = &value.get_ref<const std::string&>(); break;
+            case TEXT_PROPERTY: symbol.languages = parseProperty(value, &symbol); break;
+            case TEXT_BOUNDING_BOX: parseBoundingBox(value, symbol.boundingBox); break;
+            case TEXT_CONFIDENCE: symbol.confidence = value; break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::Symbol", key, value);
+        }
+
+        ++iter;
+    }
+
+    const char* breakText = BREAK_TEXT[static_cast<std::size_t>(symbol.breakType)];
+
+    if (symbol.isPrefix)
+    {
+        _text += breakText;
+    }
+
+    symbol.text.begin = static_cast<uint32_t>(_text.size());
+
+    if (text)
+    {
+        _text += *text;
+    }
+
+    symbol.text.end = static_cast<uint32_t>(_text.size());
+
+    if (!symbol.isPrefix)
+    {
+        _text += breakText;
+    }
+
+    _symbols.push_back(symbol);
+}
+
+
+TextAnnotation::Range TextAnnotation::parseProperty(const ofJson& json,
+                                                    Symbol* symbol)
+{
+    Range languages;
+    languages.begin = static_cast<uint32_t>(_languages.size());
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (TEXT_KEYS.find(key))
+        {
+            case TEXT_DETECTED_LANGUAGES:
+                for (const auto& language: value)
+                {
+                    DetectedLanguage detected;
+                    detected.code = internLanguage(language.value("languageCode", std::string()));
+                    detected.confidence = language.value("confidence", 0.0f);
+                    _languages.push_back(detected);
+                }
+                break;
+            case TEXT_DETECTED_BREAK:
+                if (symbol)
+                {
+                    auto type = value.find("type");
+
+                    if (type != value.end())
+                    {
+                        const auto& name = type->get_ref<const std::string&>();
+                        std::size_t index = BREAK_TYPES.find(name);
+
+                        if (index < 6)
+                        {
+                            symbol->breakType = static_cast<BreakType>(index);
+                        }
+                        else
+                        {
+                            VisionParseDiagnostics::unknownValue("TextAnnotation::BreakType", name);
+                        }
+                    }
+
+                    symbol->isPrefix = value.value("isPrefix", false);
+                }
+                break;
+            default: VisionParseDiagnostics::unknownKey("TextAnnotation::TextProperty", key, value);
+        }
+
+        ++iter;
+    }
+
+    languages.end = static_cast<uint32_t>(_languages.size());
+    return languages;
+}
+
+
+uint32_t TextAnnotation::internLanguage(const std::string& code)
+{
+    // Documents rarely have more than a few languages.
+    for (std::size_t i = 0; i < _languageCodes.size(); ++i)
+    {
+        if (_languageCodes[i] == code)
+        {
+            return static_cast<uint32_t>(i);
+        }
+    }
+
+    _languageCodes.push_back(code);
+    return static_cast<uint32_t>(_languageCodes.size() - 1);
+}
+
+
+void TextAnnotation::parseBoundingBox(const ofJson& json, BoundingBox& boundingBox)
+{
+    auto vertices = json.find("vertices");
+
+    if (vertices == json.end())
+    {
+        return;
+    }
+
+    std::size_t i = 0;
+
+    for (const auto& vertex: *vertices)
+    {
+        if (i == boundingBox.size())
+        {
+            break;
+        }
+
+        // Zero coordinates are omitted by the API.
+        boundingBox[i++] = glm::vec2(vertex.value("x", 0.0f), vertex.value("y", 0.0f));
+    }
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,327 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionTextTiler.h"
+#include <algorithm>
+#include <future>
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+ofRectangle bounds(const ofPolyline& polyline)
+{
+    const auto& vertices = polyline.getVertices();
+
+    if (vertices.empty())
+    {
+        return ofRectangle();
+    }
+
+    float x0 = vertices[0].x;
+    float y0 = vertices[0].y;
+    float x1 = x0;
+    float y1 = y0;
+
+    for (const auto& vertex: vertices)
+    {
+        x0 = std::min(x0, vertex.x);
+        y0 = std::min(y0, vertex.y);
+        x1 = std::max(x1, vertex.x);
+        y1 = std::max(y1, vertex.y);
+    }
+
+    return ofRectangle(x0, y0, x1 - x0, y1 - y0);
+}
+
+
+float intersectionArea(const ofRectangle& a, const ofRectangle& b)
+{
+    float w = std::min(a.getMaxX(), b.getMaxX()) - std::max(a.getMinX(), b.getMinX());
+    float h = std::min(a.getMaxY(), b.getMaxY()) - std::max(a.getMinY(), b.getMinY());
+    return (w > 0 && h > 0) ? w * h : 0;
+}
+
+
+} // namespace
+
+
+VisionTextTiler::VisionTextTiler(const Settings& settings): _settings(settings)
+{
+    _settings.tileSize = std::max(std::size_t(1), _settings.tileSize);
+    _settings.overlap = std::min(_settings.overlap, _settings.tileSize / 2);
+    _settings.maxTilesPerRequest = std::max(std::size_t(1),
+                                            std::min(_settings.maxTilesPerRequest,
+                                                     std::size_t(MAX_IMAGES_PER_REQUEST)));
+    _settings.maxConcurrentRequests = std::max(std::size_t(1), _settings.maxConcurrentRequests);
+}
+
+
+VisionTextTiler::~VisionTextTiler()
+{
+}
+
+
+std::vector<EntityAnnotation> VisionTextTiler::annotate(const ofPixels& pixels) const
+{
+    std::vector<VisionRequestItem::Feature> features = {
+        VisionRequestItem::Feature(_settings.feature)
+    };
+
+    auto regions = tiles(pixels.getWidth(),
+                         pixels.getHeight(),
+                         _settings.tileSize,
+                         _settings.overlap);
+
+    auto items = VisionRequestItem::fromRegions(pixels, regions, 0, features);
+
+    std::vector<std::vector<VisionRequestItem>> batches;
+
+    for (std::size_t i = 0; i < items.size(); i += _settings.maxTilesPerRequest)
+    {
+        std::size_t end = std::min(items.size(), i + _settings.maxTilesPerRequest);
+        batches.push_back(std::vector<VisionRequestItem>(items.begin() + i, items.begin() + end));
+    }
+
+    std::vector<std::vector<AnnotateImageResponse>> results(batches.size());
+
+    // Each batch runs on its own client, at most maxConcurrentRequests at once.
+    for (std::size_t i = 0; i < batches.size(); i += _settings.maxConcurrentRequests)
+    {
+        std::size_t end = std::min(batches.size(), i + _settings.maxConcurrentRequests);
+
+        std::vector<std::future<std::vector<AnnotateImageResponse>>> futures;
+
+        for (std::size_t j = i; j < end; ++j)
+        {
+            futures.push_back(std::async(std::launch::async, [this, &batches, j] {
+                VisionClient client(_settings.credentials);
+                return client.annotate(batches[j]);
+            }));
+        }
+
+        for (std::size_t j = i; j < end; ++j)
+        {
+            results[j] = futures[j - i].get();
+        }
+    }
+
+    std::vector<EntityAnnotation> words;
+    std::vector<std::size_t> wordTiles;
+
+    std::size_t tile = 0;
+
+    for (const auto& responses: results)
+    {
+        for (const auto& response: responses)
+        {
+            // A failed tile would otherwise look like a tile without text.
+            if (response.hasError())
+            {
+                throw Poco::Net::HTTPException("Tile " + std::to_string(tile)
+                                               + " failed: " + std::to_string(response.errorCode())
+                                               + " " + response.errorMessage());
+            }
+
+            const auto& annotations = response.textAnnotations();
+
+            // The first annotation is the full text of the tile.
+            for (std::size_t k = 1; k < annotations.size(); ++k)
+            {
+                words.push_back(annotations[k]);
+                wordTiles.push_back(tile);
+            }
+
+            ++tile;
+        }
+    }
+
+    return deduplicate(words, wordTiles, regions, _settings.duplicateThreshold);
+}
+
+
+const VisionTextTiler::Settings& VisionTextTiler::settings() const
+{
+    return _settings;
+}
+
+
+std::vector<ofRectangle> VisionTextTiler::tiles(std::size_t width,
+                                                std::size_t height,
+                                                std::size_t tileSize,
+                                                std::size_t overlap)
+{
+    std::vector<ofRectangle> result;
+
+    if (width == 0 || height == 0 || tileSize == 0)
+    {
+        return result;
+    }
+
+    overlap = std::min(overlap, tileSize / 2);
+
+    std::size_t step = tileSize - overlap;
+
+    auto origins = [&](std::size_t size) {
+        std::vector<std::size_t> values;
+
+        if (size <= tileSize)
+        {
+            values.push_back(0);
+            return values;
+        }
+
+        std::size_t count = (size - overlap + step - 1) / step;
+
+        // Spread the tiles evenly so the last tile ends at the image edge.
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values.push_back(i * (size - tileSize) / (count - 1));
+        }
+
+        return values;
+    };
+
+    auto xs = origins(width);
+    auto ys = origins(height);
+
+    for (auto y: ys)
+    {
+        for (auto x: xs)
+        {
+            result.push_back(ofRectangle(x,
+                                         y,
+                                         std::min(tileSize, width - x),
+                                         std::min(tileSize, height - y)));
+        }
+    }
+
+    return result;
+}
+
+
+std::vector<EntityAnnotation> VisionTextTiler::deduplicate(const std::vector<EntityAnnotation>& words,
+                                                           const std::vector<std::size_t>& wordTiles,
+                                                           const std::vector<ofRectangle>& tiles,
+                                                           float threshold)
+{
+    std::vector<ofRectangle> boxes;
+    boxes.reserve(words.size());
+
+    for (const auto& word: words)
+    {
+        boxes.push_back(bounds(word.boundingPoly()));
+    }
+
+    // Only a word reaching into a tile other than its own can have been seen
+    // twice, so only those words lie in a tile overlap band.
+    std::vector<std::size_t> candidates;
+
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        for (std::size_t t = 0; t < tiles.size(); ++t)
+        {
+            if (t != wordTiles[i] && boxes[i].intersects(tiles[t]))
+            {
+                candidates.push_back(i);
+                break;
+            }
+        }
+    }
+
+    // Sweep the candidates in x order to find overlapping pairs from
+    // different tiles.
+    std::sort(candidates.begin(), candidates.end(), [&](std::size_t a, std::size_t b) {
+        return boxes[a].getMinX() < boxes[b].getMinX();
+    });
+
+    std::vector<std::vector<std::size_t>> duplicates(words.size());
+
+    for (std::size_t m = 0; m < candidates.size(); ++m)
+    {
+        std::size_t i = candidates[m];
+
+        for (std::size_t n = m + 1; n < candidates.size(); ++n)
+        {
+            std::size_t j = candidates[n];
+
+            if (boxes[j].getMinX() > boxes[i].getMaxX())
+            {
+                break;
+            }
+
+            if (wordTiles[i] == wordTiles[j])
+            {
+                continue;
+            }
+
+            float smaller = std::min(boxes[i].getArea(), boxes[j].getArea());
+            float area = intersectionArea(boxes[i], boxes[j]);
+
+            if ((smaller > 0 && area >= threshold * smaller)
+            ||  (smaller == 0 && area == 0 && boxes[i].x == boxes[j].x && boxes[i].y == boxes[j].y))
+            {
+                duplicates[i].push_back(j);
+                duplicates[j].push_back(i);
+            }
+        }
+    }
+
+    // Keep the larger word of each duplicate group.
+    std::vector<std::size_t> order;
+
+    for (auto i: candidates)
+    {
+        if (!duplicates[i].empty())
+        {
+            order.push_back(i);
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        float areaA = boxes[a].getArea();
+        float areaB = boxes[b].getArea();
+        return areaA > areaB || (areaA == areaB && a < b);
+    });
+
+    std::vector<bool> keep(words.size(), true);
+    std::vector<bool> kept(words.size(), false);
+
+    for (auto i: order)
+    {
+        for (auto j: duplicates[i])
+        {
+            if (kept[j])
+            {
+                keep[i] = false;
+                break;
+            }
+        }
+
+        kept[i] = keep[i];
+    }
+
+    std::vector<EntityAnnotation> result;
+    result.reserve(words.size());
+
+    for (std::size_t i = 0; i < words.size(); ++i)
+    {
+        if (keep[i])
+        {
+            result.push_back(words[i]);
+        }
+    }
+
+    return result;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -0,0 +1,364 @@
+//
+// Copyright (c) 2016 Christopher Baker <https://christopherbaker.net>
+//
+// SPDX-License-Identifier:    MIT
+//
+
+
+#include "ofx/CloudPlatform/VisionWebDetection.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
+
+
+namespace ofx {
+namespace CloudPlatform {
+
+
+namespace {
+
+
+/// \brief WebDetection json keys, shared by all parts.
+enum
+{
+    WEB_ENTITIES,
+    WEB_FULL_MATCHING_IMAGES,
+    WEB_PARTIAL_MATCHING_IMAGES,
+    WEB_PAGES_WITH_MATCHING_IMAGES,
+    WEB_VISUALLY_SIMILAR_IMAGES,
+    WEB_BEST_GUESS_LABELS,
+    WEB_ENTITY_ID,
+    WEB_DESCRIPTION,
+    WEB_SCORE,
+    WEB_URL,
+    WEB_PAGE_TITLE,
+    WEB_LABEL,
+    WEB_LANGUAGE_CODE,
+    NUM_WEB_KEYS
+};
+
+
+constexpr const char* WEB_KEY_NAMES[NUM_WEB_KEYS] =
+{
+    "webEntities",
+    "fullMatchingImages",
+    "partialMatchingImages",
+    "pagesWithMatchingImages",
+    "visuallySimilarImages",
+    "bestGuessLabels",
+    "entityId",
+    "description",
+    "score",
+    "url",
+    "pageTitle",
+    "label",
+    "languageCode"
+};
+
+
+constexpr VisionKeyTable<NUM_WEB_KEYS> WEB_KEYS(WEB_KEY_NAMES);
+
+
+static_assert(WEB_KEYS.isValid(), "No perfect hash for WebDetection keys.");
+
+
+}
+
+
+WebDetection::WebDetection()
+{
+}
+
+
+WebDetection::~WebDetection()
+{
+}
+
+
+const std::vector<WebDetection::WebEntity>& WebDetection::webEntities() const
+{
+    return _webEntities;
+}
+
+
+const std::vector<WebDetection::WebImage>& WebDetection::fullMatchingImages() const
+{
+    return _fullMatchingImages;
+}
+
+
+const std::vector<WebDetection::WebImage>& WebDetection::partialMatchingImages() const
+{
+    return _partialMatchingImages;
+}
+
+
+const std::vector<WebDetection::WebPage>& WebDetection::pagesWithMatchingImages() const
+{
+    return _pagesWithMatchingImages;
+}
+
+
+const std::vector<WebDetection::WebImage>& WebDetection::visuallySimilarImages() const
+{
+    return _visuallySimilarImages;
+}
+
+
+const std::vector<WebDetection::WebLabel>& WebDetection::bestGuessLabels() const
+{
+    return _bestGuessLabels;
+}
+
+
+const std::vector<WebDetection::WebImage>& WebDetection::pageImages() const
+{
+    return _pageImages;
+}
+
+
+const std::vector<std::string>& WebDetection::strings() const
+{
+    return _strings;
+}
+
+
+const std::string& WebDetection::string(StringId id) const
+{
+    static const std::string empty;
+    return id < _strings.size() ? _strings[id] : empty;
+}
+
+
+std::string WebDetection::url(const URL& url) const
+{
+    return string(url.host) + string(url.path);
+}
+
+
+bool WebDetection::empty() const
+{
+    return _webEntities.empty()
+        && _fullMatchingImages.empty()
+        && _partialMatchingImages.empty()
+        && _pagesWithMatchingImages.empty()
+        && _visuallySimilarImages.empty()
+        && _bestGuessLabels.empty();
+}
+
+
+std::size_t WebDetection::memoryFootprint() const
+{
+    std::size_t size = sizeof(WebDetection)
+                     + _webEntities.capacity() * sizeof(WebEntity)
+                     + _fullMatchingImages.capacity() * sizeof(WebImage)
+                     + _partialMatchingImages.capacity() * sizeof(WebImage)
+                     + _pagesWithMatchingImages.capacity() * sizeof(WebPage)
+                     + _visuallySimilarImages.capacity() * sizeof(WebImage)
+                     + _bestGuessLabels.capacity() * sizeof(WebLabel)
+                     + _pageImages.capacity() * sizeof(WebImage)
+                     + _strings.capacity() * sizeof(std::string);
+
+    for (const auto& text: _strings)
+    {
+        size += text.capacity();
+    }
+
+    return size;
+}
+
+
+WebDetection WebDetection::fromJSON(const ofJson& json)
+{
+    WebDetection detection;
+
+    // The index is only needed while decoding.
+    StringIndex index;
+    detection.intern(std::string(), index);
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (WEB_KEYS.find(key))
+        {
+            case WEB_ENTITIES:
+                for (const auto& entity: value) detection._webEntities.push_back(detection.parseEntity(entity, index));
+                break;
+            case WEB_FULL_MATCHING_IMAGES:
+                for (const auto& image: value) detection._fullMatchingImages.push_back(detection.parseImage(image, index));
+                break;
+            case WEB_PARTIAL_MATCHING_IMAGES:
+                for (const auto& image: value) detection._partialMatchingImages.push_back(detection.parseImage(image, index));
+                break;
+            case WEB_PAGES_WITH_MATCHING_IMAGES:
+                for (const auto& page: value) detection._pagesWithMatchingImages.push_back(detection.parsePage(page, index));
+                break;
+            case WEB_VISUALLY_SIMILAR_IMAGES:
+                for (const auto& image: value) detection._visuallySimilarImages.push_back(detection.parseImage(image, index));
+                break;
+            case WEB_BEST_GUESS_LABELS:
+                for (const auto& label: value) detection._bestGuessLabels.push_back(detection.parseLabel(label, index));
+                break;
+            default: VisionParseDiagnostics::unknownKey("WebDetection", key, value);
+        }
+
+        ++iter;
+    }
+
+    detection._strings.shrink_to_fit();
+    detection._pageImages.shrink_to_fit();
+
+    return detection;
+}
+
+
+WebDetection::StringId WebDetection::intern(const std::string& text,
+                                            StringIndex& index)
+{
+    auto result = index.emplace(text, static_cast<StringId>(_strings.size()));
+
+    if (result.second)
+    {
+        _strings.push_back(text);
+    }
+
+    return result.first->second;
+}
+
+
+WebDetection::URL WebDetection::internURL(const std::string& url,
+                                          StringIndex& index)
+{
+    URL result;
+
+    // Split after the scheme and host, e.g. "https://example.com".
+    std::size_t scheme = url.find("://");
+    std::size_t split = scheme == std::string::npos ? 0 : url.find('/', scheme + 3);
+
+    if (split == std::string::npos)
+    {
+        split = url.size();
+    }
+
+    result.host = intern(url.substr(0, split), index);
+    result.path = intern(url.substr(split), index);
+
+    return result;
+}
+
+
+WebDetection::WebEntity WebDetection::parseEntity(const ofJson& json,
+                                                  StringIndex& index)
+{
+    WebEntity entity;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (WEB_KEYS.find(key))
+        {
+            case WEB_ENTITY_ID: entity.entityId = intern(value.get_ref<const std::string&>(), index); break;
+            case WEB_DESCRIPTION: entity.description = intern(value.get_ref<const std::string&>(), index); break;
+            case WEB_SCORE: entity.score = value; break;
+            default: VisionParseDiagnostics::unknownKey("WebDetection::WebEntity", key, value);
+        }
+
+        ++iter;
+    }
+
+    return entity;
+}
+
+
+WebDetection::WebImage WebDetection::parseImage(const ofJson& json,
+                                                StringIndex& index)
+{
+    WebImage image;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (WEB_KEYS.find(key))
+        {
+            case WEB_URL: image.url = internURL(value.get_ref<const std::string&>(), index); break;
+            case WEB_SCORE: image.score = value; break;
+            default: VisionParseDiagnostics::unknownKey("WebDetection::WebImage", key, value);
+        }
+
+        ++iter;
+    }
+
+    return image;
+}
+
+
+WebDetection::WebPage WebDetection::parsePage(const ofJson& json,
+                                              StringIndex& index)
+{
+    WebPage page;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (WEB_KEYS.find(key))
+        {
+            case WEB_URL: page.url = internURL(value.get_ref<const std::string&>(), index); break;
+            case WEB_PAGE_TITLE: page.pageTitle = intern(value.get_ref<const std::string&>(), index); break;
+            case WEB_SCORE: page.score = value; break;
+            case WEB_FULL_MATCHING_IMAGES:
+                page.fullMatchingImages.begin = static_cast<uint32_t>(_pageImages.size());
+                for (const auto& image: value) _pageImages.push_back(parseImage(image, index));
+                page.fullMatchingImages.end = static_cast<uint32_t>(_pageImages.size());
+                break;
+            case WEB_PARTIAL_MATCHING_IMAGES:
+                page.partialMatchingImages.begin = static_cast<uint32_t>(_pageImages.size());
+                for (const auto& image: value) _pageImages.push_back(parseImage(image, index));
+                page.partialMatchingImages.end = static_cast<uint32_t>(_pageImages.size());
+                break;
+            default: VisionParseDiagnostics::unknownKey("WebDetection::WebPage", key, value);
+        }
+
+        ++iter;
+    }
+
+    return page;
+}
+
+
+WebDetection::WebLabel WebDetection::parseLabel(const ofJson& json,
+                                                StringIndex& index)
+{
+    WebLabel label;
+
+    auto iter = json.cbegin();
+    while (iter != json.cend())
+    {
+        const auto& key = iter.key();
+        const auto& value = iter.value();
+
+        switch (WEB_KEYS.find(key))
+        {
+            case WEB_LABEL: label.label = intern(value.get_ref<const std::string&>(), index); break;
+            case WEB_LANGUAGE_CODE: label.languageCode = intern(value.get_ref<const std::string&>(), index); break;
+            default: VisionParseDiagnostics::unknownKey("WebDetection::WebLabel", key, value);
+        }
+
+        ++iter;
+    }
+
+    return label;
+}
+
+
+} } // namespace ofx::CloudPlatform
@@ -9,15 +9,35 @@
 
 
 #include "ofxHTTP.h"
+#include "ofx/CloudPlatform/Base64.h"
 #include "ofx/CloudPlatform/PlatformClient.h"
 #include "ofx/CloudPlatform/ServiceAccount.h"
 #include "ofx/CloudPlatform/VisionAnnotations.h"
+#include "ofx/CloudPlatform/VisionCache.h"
 #include "ofx/CloudPlatform/VisionClient.h"
+#include "ofx/CloudPlatform/VisionColumnStore.h"
 #include "ofx/CloudPlatform/VisionDebug.h"
 #include "ofx/CloudPlatform/VisionDeserializer.h"
+#include "ofx/CloudPlatform/VisionFaceTracker.h"
+#include "ofx/CloudPlatform/VisionFrameCache.h"
+#include "ofx/CloudPlatform/VisionHash.h"
+#include "ofx/CloudPlatform/VisionImageContent.h"
+#include "ofx/CloudPlatform/VisionImageEncoder.h"
+#include "ofx/CloudPlatform/VisionKeyTable.h"
+#include "ofx/CloudPlatform/VisionLabelAggregator.h"
+#include "ofx/CloudPlatform/VisionLog.h"
+#include "ofx/CloudPlatform/VisionParseDiagnostics.h"
+#include "ofx/CloudPlatform/VisionQuads.h"
 #include "ofx/CloudPlatform/VisionResponse.h"
 #include "ofx/CloudPlatform/VisionRequest.h"
 #include "ofx/CloudPlatform/VisionRequestItem.h"
+#include "ofx/CloudPlatform/VisionRequestTemplate.h"
+#include "ofx/CloudPlatform/VisionSnapshot.h"
+#include "ofx/CloudPlatform/VisionSpatialIndex.h"
+#include "ofx/CloudPlatform/VisionStream.h"
+#include "ofx/CloudPlatform/VisionTextAnnotation.h"
+#include "ofx/CloudPlatform/VisionTextTiler.h"
+#include "ofx/CloudPlatform/VisionWebDetection.h"
 
 
 namespace ofxCloudPlatform = ofx::CloudPlatform;